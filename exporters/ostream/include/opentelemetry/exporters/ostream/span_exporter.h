@@ -68,10 +68,10 @@ class OStreamSpanExporter final : public sdktrace::SpanExporter
   */
 
   template <typename T>
-  void print_array(sdktrace::SpanDataAttributeValue &value)
+  void print_array(const sdktrace::SpanDataAttributeValue &value)
   {
     sout_ << '[';
-    auto s    = nostd::get<std::vector<T>>(value);
+    auto &s   = nostd::get<std::vector<T>>(value);
     size_t i  = 1;
     size_t sz = s.size();
     for (auto v : s)
@@ -84,7 +84,7 @@ class OStreamSpanExporter final : public sdktrace::SpanExporter
     sout_ << ']';
   }
 
-  void print_value(sdktrace::SpanDataAttributeValue &value)
+  void print_value(const sdktrace::SpanDataAttributeValue &value)
   {
     if (nostd::holds_alternative<bool>(value))
     {
@@ -144,11 +144,11 @@ class OStreamSpanExporter final : public sdktrace::SpanExporter
     }
   }
 
-  void printAttributes(std::unordered_map<std::string, sdktrace::SpanDataAttributeValue> map)
+  void printAttributes(const sdktrace::FlatAttributeMap &map)
   {
     int size = map.size();
     int i    = 1;
-    for (auto kv : map)
+    for (auto &kv : map)
     {
       sout_ << kv.first << ": ";
       print_value(kv.second);
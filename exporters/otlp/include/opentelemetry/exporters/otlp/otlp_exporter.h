@@ -3,11 +3,117 @@
 #include "opentelemetry/proto/collector/trace/v1/trace_service.grpc.pb.h"
 #include "opentelemetry/sdk/trace/exporter.h"
 
+#include <grpcpp/grpcpp.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
 OPENTELEMETRY_BEGIN_NAMESPACE
 namespace exporter
 {
 namespace otlp
 {
+/**
+ * The message compression of OTLP export requests.
+ */
+enum class OtlpCompression
+{
+  kNone,
+  kGzip,
+  kDeflate
+};
+
+/**
+ * Struct to hold OTLP exporter options.
+ */
+struct OtlpExporterOptions
+{
+  /* The address of the collector, as a gRPC target */
+  std::string endpoint = "localhost:55678";
+
+  /**
+   * The number of gRPC channels, each with its own HTTP/2 connection, that export requests are
+   * spread across. Each request goes to the channel with the fewest requests in flight, taking
+   * turns among equally busy ones, so that a stalled connection doesn't hold up the requests sent
+   * on the others. A value of 0 is treated as 1.
+   */
+  size_t channel_count = 1;
+
+  /**
+   * The interval between the keepalive pings that detect broken connections while no request is
+   * being sent; 0 disables them. Collectors close connections that ping more often than they
+   * allow, which for gRPC servers defaults to every 5 minutes.
+   */
+  std::chrono::milliseconds keepalive_time = std::chrono::milliseconds(0);
+
+  /* How long a keepalive ping may go unanswered before its connection is closed */
+  std::chrono::milliseconds keepalive_timeout = std::chrono::milliseconds(20000);
+
+  /* The maximum size in bytes of an export request; larger requests fail. -1 means no limit. */
+  int max_send_message_size = -1;
+
+  /**
+   * Whether Export sends each batch without waiting for the collector's response. Export then
+   * returns as soon as the request is sent, and a completion thread handles the responses, so an
+   * export no longer costs a full round trip on the calling thread. Failed requests are logged,
+   * since they can no longer be reported through Export's result.
+   */
+  bool async_export = false;
+
+  /**
+   * The maximum number of asynchronous requests waiting for a response. Once reached, Export waits
+   * for a response before sending the next request. Only used if async_export is set; a value of 0
+   * is treated as 1.
+   */
+  size_t max_in_flight_requests = 8;
+
+  /* The deadline of each export request; 0 means requests never time out. */
+  std::chrono::milliseconds timeout = std::chrono::milliseconds(10000);
+
+  /**
+   * The size of the memory blocks of the protobuf arenas that recordables are built in. The
+   * default of 0 builds each span on the heap. Otherwise, each export starts a new arena, and an
+   * arena is reset and reused, keeping its first block, once every recordable built in it is gone.
+   * Pick a size that holds a batch of spans.
+   *
+   * A recordable keeps its whole arena alive, so a span that is still open pins the arena it was
+   * started in, along with every block the arena grew for the spans exported since. With
+   * long-lived spans, the exporter can hold on to many arenas' worth of memory.
+   */
+  size_t arena_block_size = 0;
+
+  /**
+   * The compression of export requests. gRPC compresses with zlib's default level; see
+   * otlp_exporter_benchmark for the CPU time and the bytes it costs and saves per batch size.
+   */
+  OtlpCompression compression = OtlpCompression::kNone;
+};
+
+class ArenaPool;
+
+/**
+ * Create a channel to the collector at options.endpoint, with the keepalive and message size
+ * settings of options. Passing the channel to several exporters makes them share its connection.
+ * @param options the exporter options
+ */
+std::shared_ptr<grpc::Channel> CreateOtlpChannel(const OtlpExporterOptions &options);
+
+/**
+ * Set the deadline and the compression of an export request.
+ * @param context the context of the request
+ * @param timeout the timeout of the request; zero for no deadline
+ * @param compression the compression of the request
+ */
+void ConfigureOtlpContext(grpc::ClientContext &context,
+                          std::chrono::milliseconds timeout,
+                          OtlpCompression compression);
+
 /**
  * The OTLP exporter exports span data in OpenTelemetry Protocol (OTLP) format.
  */
@@ -20,6 +126,25 @@ class OtlpExporter final : public opentelemetry::sdk::trace::SpanExporter
    */
   OtlpExporter();
 
+  /**
+   * Create an OtlpExporter using the given options.
+   * @param options the exporter options
+   */
+  explicit OtlpExporter(const OtlpExporterOptions &options);
+
+  /**
+   * Create an OtlpExporter that sends over the given channel, which may be shared with other
+   * exporters. options.channel_count is ignored.
+   * @param channel the channel to the collector
+   * @param options the exporter options
+   */
+  OtlpExporter(std::shared_ptr<grpc::ChannelInterface> channel, const OtlpExporterOptions &options);
+
+  /**
+   * Waits for the asynchronous requests still in flight, and stops the completion thread.
+   */
+  ~OtlpExporter();
+
   /**
    * Create a span recordable.
    * @return a newly initialized Recordable object
@@ -34,19 +159,62 @@ class OtlpExporter final : public opentelemetry::sdk::trace::SpanExporter
       const nostd::span<std::unique_ptr<sdk::trace::Recordable>> &spans) noexcept override;
 
   /**
-   * Shut down the exporter.
+   * Shut down the exporter. Waits for the asynchronous requests still in flight.
    * @param timeout an optional timeout, the default timeout of 0 means that no
    * timeout is applied.
    */
-  void Shutdown(
-      std::chrono::microseconds timeout = std::chrono::microseconds(0)) noexcept override{};
+  void Shutdown(std::chrono::microseconds timeout = std::chrono::microseconds(0)) noexcept override;
 
 private:
   // For testing
   friend class OtlpExporterTestPeer;
 
-  // Store service stub internally. Useful for testing.
-  std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface> trace_service_stub_;
+  /**
+   * A service stub along with the number of requests in flight on its channel.
+   */
+  struct ServiceChannel
+  {
+    std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface> stub;
+    std::atomic<size_t> num_in_flight{0};
+  };
+
+  /**
+   * An asynchronous export request, kept alive until its response arrives.
+   */
+  struct AsyncCall
+  {
+    ServiceChannel *channel;
+    grpc::ClientContext context;
+    proto::collector::trace::v1::ExportTraceServiceResponse response;
+    grpc::Status status;
+    std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+        proto::collector::trace::v1::ExportTraceServiceResponse>>
+        response_reader;
+  };
+
+  const OtlpExporterOptions options_;
+
+  /* The arenas that recordables are built in, and the one that MakeRecordable currently uses */
+  std::shared_ptr<ArenaPool> arena_pool_;
+  std::shared_ptr<google::protobuf::Arena> arena_;
+
+  // Store service stubs internally. Useful for testing.
+  std::vector<std::unique_ptr<ServiceChannel>> channels_;
+
+  /* The channel that PickChannel looks at first */
+  std::atomic<size_t> next_channel_{0};
+
+  /* The queue that asynchronous responses arrive on, and the thread that handles them; only set
+   * up if async_export is set */
+  std::unique_ptr<grpc::CompletionQueue> completion_queue_;
+  std::thread completion_thread_;
+
+  /* The asynchronous requests waiting for a response */
+  std::unordered_set<AsyncCall *> in_flight_calls_;
+  std::mutex in_flight_m_;
+  std::condition_variable in_flight_cv_;
+
+  std::atomic<bool> is_shutdown_{false};
 
   /**
    * Create an OtlpExporter using the specified service stub.
@@ -54,6 +222,41 @@ class OtlpExporter final : public opentelemetry::sdk::trace::SpanExporter
    * @param stub the service stub to be used for exporting
    */
   OtlpExporter(std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface> stub);
+
+  /**
+   * Create an OtlpExporter using the specified service stub and options.
+   * Only tests can call this constructor directly.
+   * @param stub the service stub to be used for exporting
+   * @param options the exporter options
+   */
+  OtlpExporter(std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface> stub,
+               const OtlpExporterOptions &options);
+
+  /**
+   * Create an OtlpExporter that spreads requests across the specified service stubs.
+   * @param stubs the service stubs to be used for exporting, one per channel
+   * @param options the exporter options
+   */
+  OtlpExporter(
+      std::vector<std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface>> stubs,
+      const OtlpExporterOptions &options);
+
+  /**
+   * @return the channel with the fewest requests in flight, starting the search at next_channel_
+   */
+  ServiceChannel &PickChannel() noexcept;
+
+  /**
+   * Sends a request without waiting for its response, once fewer than max_in_flight_requests
+   * requests are in flight.
+   * @return false if the exporter was shut down before the request could be sent
+   */
+  bool ExportAsync(const proto::collector::trace::v1::ExportTraceServiceRequest &request);
+
+  /**
+   * The routine performed by the completion thread.
+   */
+  void HandleCompletions();
 };
 }  // namespace otlp
 }  // namespace exporter
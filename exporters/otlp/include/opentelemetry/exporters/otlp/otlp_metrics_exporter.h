@@ -0,0 +1,122 @@
+#pragma once
+
+#include "opentelemetry/exporters/otlp/otlp_exporter.h"
+#include "opentelemetry/proto/collector/metrics/v1/metrics_service.grpc.pb.h"
+#include "opentelemetry/sdk/metrics/exporter.h"
+
+#include <grpcpp/grpcpp.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+OPENTELEMETRY_BEGIN_NAMESPACE
+namespace exporter
+{
+namespace otlp
+{
+/**
+ * Struct to hold OTLP metrics exporter options.
+ */
+struct OtlpMetricsExporterOptions
+{
+  /* The address of the collector, as a gRPC target; unused if the exporter is given a channel */
+  std::string endpoint = "localhost:55678";
+
+  /* The deadline of each export request; 0 means requests never time out. */
+  std::chrono::milliseconds timeout = std::chrono::milliseconds(10000);
+
+  /* The compression of export requests */
+  OtlpCompression compression = OtlpCompression::kNone;
+
+  /**
+   * The quantiles, between 0 and 1, reported for sketch aggregators and for exact aggregators
+   * that estimate quantiles.
+   */
+  std::vector<double> summary_quantiles = {0, 0.5, 0.9, 0.99, 1};
+};
+
+/**
+ * The OTLP metrics exporter exports metric records in OpenTelemetry Protocol (OTLP) format.
+ *
+ * Counter and gauge aggregators are exported as int64 or double data points, histogram
+ * aggregators as histogram data points, and min-max-sum-count, sketch and exact aggregators as
+ * summary data points. Records with the same name become data points of one metric.
+ */
+class OtlpMetricsExporter final : public sdk::metrics::MetricsExporter
+{
+public:
+  /**
+   * Create an OtlpMetricsExporter that sends to the default endpoint.
+   */
+  OtlpMetricsExporter();
+
+  /**
+   * Create an OtlpMetricsExporter with its own channel to options.endpoint.
+   * @param options the exporter options
+   */
+  explicit OtlpMetricsExporter(const OtlpMetricsExporterOptions &options);
+
+  /**
+   * Create an OtlpMetricsExporter that sends over the given channel, which may be shared with an
+   * OtlpExporter; see CreateOtlpChannel.
+   * @param channel the channel to the collector
+   * @param options the exporter options
+   */
+  OtlpMetricsExporter(std::shared_ptr<grpc::ChannelInterface> channel,
+                      const OtlpMetricsExporterOptions &options = OtlpMetricsExporterOptions());
+
+  /**
+   * Export a batch of metric records in OTLP format.
+   * @param records the records to export
+   */
+  sdk::metrics::ExportResult Export(
+      const std::vector<sdk::metrics::Record> &records) noexcept override;
+
+private:
+  // For testing
+  friend class OtlpMetricsExporterTestPeer;
+
+  const OtlpMetricsExporterOptions options_;
+
+  std::unique_ptr<proto::collector::metrics::v1::MetricsService::StubInterface>
+      metrics_service_stub_;
+
+  /* The request, cleared and refilled by each export so that its messages are reused, and the
+   * metrics in it by name */
+  proto::collector::metrics::v1::ExportMetricsServiceRequest request_;
+  std::unordered_map<std::string, proto::metrics::v1::Metric *> metrics_by_name_;
+
+  /* The start of cumulative and of delta data points respectively */
+  const uint64_t start_time_unix_nano_;
+  uint64_t last_export_time_unix_nano_;
+
+  /**
+   * Create an OtlpMetricsExporter using the specified service stub.
+   * Only tests can call this constructor directly.
+   * @param stub the service stub to be used for exporting
+   * @param options the exporter options
+   */
+  OtlpMetricsExporter(
+      std::unique_ptr<proto::collector::metrics::v1::MetricsService::StubInterface> stub,
+      const OtlpMetricsExporterOptions &options);
+
+  /**
+   * Fill request_ with the data points of records.
+   */
+  void PopulateRequest(const std::vector<sdk::metrics::Record> &records, uint64_t now_unix_nano);
+
+  /**
+   * Add the data point of an aggregator to metric.
+   */
+  template <typename T>
+  void AddDataPoint(sdk::metrics::Aggregator<T> &aggregator,
+                    const sdk::metrics::LabelSet &labels,
+                    uint64_t now_unix_nano,
+                    proto::metrics::v1::Metric *metric);
+};
+}  // namespace otlp
+}  // namespace exporter
+OPENTELEMETRY_END_NAMESPACE
@@ -4,6 +4,10 @@
 #include "opentelemetry/sdk/trace/recordable.h"
 #include "opentelemetry/version.h"
 
+#include <google/protobuf/arena.h>
+
+#include <memory>
+
 OPENTELEMETRY_BEGIN_NAMESPACE
 namespace exporter
 {
@@ -12,7 +16,30 @@ namespace otlp
 class Recordable final : public sdk::trace::Recordable
 {
 public:
-  const proto::trace::v1::Span &span() const noexcept { return span_; }
+  /**
+   * Create a recordable whose span is allocated on the heap.
+   */
+  Recordable();
+
+  /**
+   * Create a recordable whose span is built inside an arena, so that setting its fields doesn't
+   * allocate from the heap. The recordable keeps the arena alive.
+   * @param arena the arena to build the span in
+   */
+  explicit Recordable(std::shared_ptr<google::protobuf::Arena> arena);
+
+  ~Recordable() override;
+
+  Recordable(const Recordable &) = delete;
+  Recordable &operator=(const Recordable &) = delete;
+
+  const proto::trace::v1::Span &span() const noexcept { return *span_; }
+
+  /**
+   * @return the span, for adding it to a request without copying it. The recordable keeps
+   * ownership of the span.
+   */
+  proto::trace::v1::Span *mutable_span() noexcept { return span_; }
 
   void SetIds(trace::TraceId trace_id,
               trace::SpanId span_id,
@@ -30,6 +57,8 @@ class Recordable final : public sdk::trace::Recordable
 
   void SetStatus(trace::CanonicalCode code, nostd::string_view description) noexcept override;
 
+  bool HasErrorStatus() const noexcept override;
+
   void SetName(nostd::string_view name) noexcept override;
 
   void SetStartTime(opentelemetry::core::SystemTimestamp start_time) noexcept override;
@@ -37,7 +66,8 @@ class Recordable final : public sdk::trace::Recordable
   void SetDuration(std::chrono::nanoseconds duration) noexcept override;
 
 private:
-  proto::trace::v1::Span span_;
+  std::shared_ptr<google::protobuf::Arena> arena_;
+  proto::trace::v1::Span *span_;
 };
 }  // namespace otlp
 }  // namespace exporter
@@ -3,6 +3,8 @@
 
 #include <grpcpp/grpcpp.h>
 #include <iostream>
+#include <mutex>
+#include <vector>
 
 OPENTELEMETRY_BEGIN_NAMESPACE
 namespace exporter
@@ -10,12 +12,85 @@ namespace exporter
 namespace otlp
 {
 
-const std::string kCollectorAddress = "localhost:55678";
+/**
+ * A pool of protobuf arenas with a fixed block size. An arena handed out by Get goes back to the
+ * pool, reset, once the last reference to it is dropped; resetting keeps its first block, so a
+ * reused arena doesn't allocate until it outgrows that block.
+ */
+class ArenaPool : public std::enable_shared_from_this<ArenaPool>
+{
+public:
+  explicit ArenaPool(size_t block_size) : block_size_(block_size) {}
+
+  std::shared_ptr<google::protobuf::Arena> Get()
+  {
+    std::unique_ptr<PooledArena> pooled;
+    {
+      std::lock_guard<std::mutex> lk(m_);
+      if (!idle_arenas_.empty())
+      {
+        pooled = std::move(idle_arenas_.back());
+        idle_arenas_.pop_back();
+      }
+    }
+    if (pooled == nullptr)
+    {
+      pooled.reset(new PooledArena(block_size_));
+    }
+
+    auto pool   = shared_from_this();
+    auto arena  = &pooled->arena;
+    auto holder = pooled.release();
+    return std::shared_ptr<google::protobuf::Arena>(
+        arena, [pool, holder](google::protobuf::Arena *) { pool->Put(holder); });
+  }
+
+private:
+  // Arenas kept beyond this many are freed.
+  static const size_t kMaxIdleArenas = 4;
+
+  struct PooledArena
+  {
+    explicit PooledArena(size_t block_size)
+        : first_block(new char[block_size]), arena(MakeOptions(first_block.get(), block_size))
+    {}
+
+    static google::protobuf::ArenaOptions MakeOptions(char *first_block, size_t block_size)
+    {
+      google::protobuf::ArenaOptions options;
+      options.initial_block      = first_block;
+      options.initial_block_size = block_size;
+      options.start_block_size   = block_size;
+      options.max_block_size     = block_size;
+      return options;
+    }
+
+    std::unique_ptr<char[]> first_block;
+    google::protobuf::Arena arena;
+  };
+
+  void Put(PooledArena *holder)
+  {
+    std::unique_ptr<PooledArena> pooled(holder);
+    pooled->arena.Reset();
+    std::lock_guard<std::mutex> lk(m_);
+    if (idle_arenas_.size() < kMaxIdleArenas)
+    {
+      idle_arenas_.push_back(std::move(pooled));
+    }
+  }
+
+  const size_t block_size_;
+  std::mutex m_;
+  std::vector<std::unique_ptr<PooledArena>> idle_arenas_;
+};
 
 // ----------------------------- Helper functions ------------------------------
 
 /**
- * Add span protobufs contained in recordables to request.
+ * Add span protobufs contained in recordables to request. The spans are added without copying
+ * them, and stay owned by the recordables; ReleaseSpans must be called before the recordables or
+ * the request are destroyed.
  * @param spans the spans to export
  * @param request the current request
  */
@@ -25,56 +100,297 @@ void PopulateRequest(const nostd::span<std::unique_ptr<sdk::trace::Recordable>>
   auto resource_span       = request->add_resource_spans();
   auto instrumentation_lib = resource_span->add_instrumentation_library_spans();
 
+  auto request_spans = instrumentation_lib->mutable_spans();
+  request_spans->Reserve(static_cast<int>(spans.size()));
   for (auto &recordable : spans)
   {
-    auto rec = std::unique_ptr<Recordable>(static_cast<Recordable *>(recordable.release()));
-    *instrumentation_lib->add_spans() = std::move(rec->span());
+    auto rec = static_cast<Recordable *>(recordable.get());
+    request_spans->UnsafeArenaAddAllocated(rec->mutable_span());
   }
 }
 
 /**
- * Create service stub to communicate with the OpenTelemetry Collector.
+ * Take the spans added by PopulateRequest back out of request, so that it doesn't free them.
+ * @param request the request built by PopulateRequest
  */
-std::unique_ptr<proto::collector::trace::v1::TraceService::Stub> MakeServiceStub()
+void ReleaseSpans(proto::collector::trace::v1::ExportTraceServiceRequest *request)
 {
-  auto channel = grpc::CreateChannel(kCollectorAddress, grpc::InsecureChannelCredentials());
-  return proto::collector::trace::v1::TraceService::NewStub(channel);
+  auto request_spans =
+      request->mutable_resource_spans(0)->mutable_instrumentation_library_spans(0)->mutable_spans();
+  request_spans->UnsafeArenaExtractSubrange(0, request_spans->size(), nullptr);
+}
+
+std::shared_ptr<grpc::Channel> CreateOtlpChannel(const OtlpExporterOptions &options)
+{
+  grpc::ChannelArguments args;
+  // Channels with the same arguments share their connections unless each has its own pool.
+  args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+  if (options.keepalive_time > std::chrono::milliseconds::zero())
+  {
+    args.SetInt(GRPC_ARG_KEEPALIVE_TIME_MS, static_cast<int>(options.keepalive_time.count()));
+    args.SetInt(GRPC_ARG_KEEPALIVE_TIMEOUT_MS,
+                static_cast<int>(options.keepalive_timeout.count()));
+    args.SetInt(GRPC_ARG_KEEPALIVE_PERMIT_WITHOUT_CALLS, 1);
+  }
+  args.SetMaxSendMessageSize(options.max_send_message_size);
+  return grpc::CreateCustomChannel(options.endpoint, grpc::InsecureChannelCredentials(), args);
+}
+
+/**
+ * Create service stubs to communicate with the OpenTelemetry Collector, each on its own channel.
+ */
+std::vector<std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface>>
+MakeServiceStubs(const OtlpExporterOptions &options)
+{
+  std::vector<std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface>> stubs;
+  const size_t channel_count = options.channel_count > 0 ? options.channel_count : 1;
+  for (size_t i = 0; i < channel_count; ++i)
+  {
+    stubs.push_back(proto::collector::trace::v1::TraceService::NewStub(CreateOtlpChannel(options)));
+  }
+  return stubs;
+}
+
+/**
+ * Wrap a single service stub into a vector.
+ */
+std::vector<std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface>>
+MakeStubVector(std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface> stub)
+{
+  std::vector<std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface>> stubs;
+  stubs.push_back(std::move(stub));
+  return stubs;
+}
+
+void ConfigureOtlpContext(grpc::ClientContext &context,
+                          std::chrono::milliseconds timeout,
+                          OtlpCompression compression)
+{
+  if (timeout > std::chrono::milliseconds::zero())
+  {
+    context.set_deadline(std::chrono::system_clock::now() + timeout);
+  }
+  switch (compression)
+  {
+    case OtlpCompression::kGzip:
+      context.set_compression_algorithm(GRPC_COMPRESS_GZIP);
+      break;
+    case OtlpCompression::kDeflate:
+      context.set_compression_algorithm(GRPC_COMPRESS_DEFLATE);
+      break;
+    case OtlpCompression::kNone:
+      break;
+  }
 }
 
 // -------------------------------- Contructors --------------------------------
 
-OtlpExporter::OtlpExporter() : OtlpExporter(MakeServiceStub()) {}
+OtlpExporter::OtlpExporter() : OtlpExporter(OtlpExporterOptions()) {}
+
+OtlpExporter::OtlpExporter(const OtlpExporterOptions &options)
+    : OtlpExporter(MakeServiceStubs(options), options)
+{}
+
+OtlpExporter::OtlpExporter(std::shared_ptr<grpc::ChannelInterface> channel,
+                           const OtlpExporterOptions &options)
+    : OtlpExporter(proto::collector::trace::v1::TraceService::NewStub(channel), options)
+{}
 
 OtlpExporter::OtlpExporter(
     std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface> stub)
-    : trace_service_stub_(std::move(stub))
+    : OtlpExporter(std::move(stub), OtlpExporterOptions())
+{}
+
+OtlpExporter::OtlpExporter(
+    std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface> stub,
+    const OtlpExporterOptions &options)
+    : OtlpExporter(MakeStubVector(std::move(stub)), options)
 {}
 
+OtlpExporter::OtlpExporter(
+    std::vector<std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface>> stubs,
+    const OtlpExporterOptions &options)
+    : options_(options)
+{
+  for (auto &stub : stubs)
+  {
+    std::unique_ptr<ServiceChannel> channel(new ServiceChannel);
+    channel->stub = std::move(stub);
+    channels_.push_back(std::move(channel));
+  }
+  if (options_.arena_block_size > 0)
+  {
+    arena_pool_ = std::make_shared<ArenaPool>(options_.arena_block_size);
+    arena_      = arena_pool_->Get();
+  }
+  if (options_.async_export)
+  {
+    completion_queue_.reset(new grpc::CompletionQueue);
+    completion_thread_ = std::thread(&OtlpExporter::HandleCompletions, this);
+  }
+}
+
+OtlpExporter::~OtlpExporter()
+{
+  Shutdown();
+}
+
 // ----------------------------- Exporter methods ------------------------------
 
 std::unique_ptr<sdk::trace::Recordable> OtlpExporter::MakeRecordable() noexcept
 {
-  return std::unique_ptr<sdk::trace::Recordable>(new Recordable);
+  if (arena_pool_ == nullptr)
+  {
+    return std::unique_ptr<sdk::trace::Recordable>(new Recordable);
+  }
+  return std::unique_ptr<sdk::trace::Recordable>(new Recordable(std::atomic_load(&arena_)));
 }
 
 sdk::trace::ExportResult OtlpExporter::Export(
     const nostd::span<std::unique_ptr<sdk::trace::Recordable>> &spans) noexcept
 {
+  if (is_shutdown_.load() == true)
+  {
+    return sdk::trace::ExportResult::kFailure;
+  }
+
   proto::collector::trace::v1::ExportTraceServiceRequest request;
 
   PopulateRequest(spans, &request);
 
-  grpc::ClientContext context;
-  proto::collector::trace::v1::ExportTraceServiceResponse response;
+  auto result = sdk::trace::ExportResult::kSuccess;
+  if (options_.async_export)
+  {
+    if (!ExportAsync(request))
+    {
+      result = sdk::trace::ExportResult::kFailure;
+    }
+  }
+  else
+  {
+    grpc::ClientContext context;
+    ConfigureOtlpContext(context, options_.timeout, options_.compression);
+    proto::collector::trace::v1::ExportTraceServiceResponse response;
+
+    auto &channel = PickChannel();
+    ++channel.num_in_flight;
+    grpc::Status status = channel.stub->Export(&context, request, &response);
+    --channel.num_in_flight;
 
-  grpc::Status status = trace_service_stub_->Export(&context, request, &response);
+    if (!status.ok())
+    {
+      std::cerr << "[OTLP Exporter] Export() failed: " << status.error_message() << "\n";
+      result = sdk::trace::ExportResult::kFailure;
+    }
+  }
+  ReleaseSpans(&request);
 
-  if (!status.ok())
+  // Build the next batch's spans in a fresh arena, so that this one can be
+  // reused once its recordables are gone.
+  if (arena_pool_ != nullptr)
   {
-    std::cerr << "[OTLP Exporter] Export() failed: " << status.error_message() << "\n";
-    return sdk::trace::ExportResult::kFailure;
+    std::atomic_store(&arena_, arena_pool_->Get());
   }
-  return sdk::trace::ExportResult::kSuccess;
+  return result;
+}
+
+bool OtlpExporter::ExportAsync(
+    const proto::collector::trace::v1::ExportTraceServiceRequest &request)
+{
+  const size_t max_in_flight_requests =
+      options_.max_in_flight_requests > 0 ? options_.max_in_flight_requests : 1;
+
+  std::unique_ptr<AsyncCall> call(new AsyncCall);
+  ConfigureOtlpContext(call->context, options_.timeout, options_.compression);
+
+  // Start the call while holding the lock, so that Shutdown either sees it in flight or makes
+  // the check below fail, and never shuts the completion queue down under it.
+  std::unique_lock<std::mutex> lk(in_flight_m_);
+  in_flight_cv_.wait(lk, [&] { return in_flight_calls_.size() < max_in_flight_requests; });
+  if (is_shutdown_.load() == true)
+  {
+    return false;
+  }
+  in_flight_calls_.insert(call.get());
+
+  call->channel = &PickChannel();
+  ++call->channel->num_in_flight;
+
+  // The request is serialized when the call starts, so it needn't outlive this function.
+  call->response_reader = call->channel->stub->PrepareAsyncExport(&call->context, request,
+                                                                  completion_queue_.get());
+  call->response_reader->StartCall();
+
+  // The completion thread takes ownership of the call once its response arrives.
+  auto tag = call.release();
+  tag->response_reader->Finish(&tag->response, &tag->status, tag);
+  return true;
+}
+
+void OtlpExporter::HandleCompletions()
+{
+  void *tag;
+  bool ok;
+  while (completion_queue_->Next(&tag, &ok))
+  {
+    std::unique_ptr<AsyncCall> call(static_cast<AsyncCall *>(tag));
+    if (!call->status.ok())
+    {
+      std::cerr << "[OTLP Exporter] Export() failed: " << call->status.error_message() << "\n";
+    }
+    --call->channel->num_in_flight;
+
+    {
+      std::lock_guard<std::mutex> lk(in_flight_m_);
+      in_flight_calls_.erase(call.get());
+      call.reset();
+    }
+    in_flight_cv_.notify_all();
+  }
+}
+
+OtlpExporter::ServiceChannel &OtlpExporter::PickChannel() noexcept
+{
+  const size_t num_channels = channels_.size();
+  const size_t start        = next_channel_.fetch_add(1, std::memory_order_relaxed);
+  ServiceChannel *result    = channels_[start % num_channels].get();
+  for (size_t i = 1; i < num_channels && result->num_in_flight.load() > 0; ++i)
+  {
+    auto channel = channels_[(start + i) % num_channels].get();
+    if (channel->num_in_flight.load() < result->num_in_flight.load())
+    {
+      result = channel;
+    }
+  }
+  return *result;
+}
+
+void OtlpExporter::Shutdown(std::chrono::microseconds timeout) noexcept
+{
+  if (is_shutdown_.exchange(true) == true || completion_queue_ == nullptr)
+  {
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> lk(in_flight_m_);
+    auto is_done = [this] { return in_flight_calls_.empty(); };
+    if (timeout <= std::chrono::microseconds::zero())
+    {
+      in_flight_cv_.wait(lk, is_done);
+    }
+    else if (!in_flight_cv_.wait_for(lk, timeout, is_done))
+    {
+      // Give up on the requests still in flight; they complete as cancelled.
+      for (auto call : in_flight_calls_)
+      {
+        call->context.TryCancel();
+      }
+    }
+  }
+
+  completion_queue_->Shutdown();
+  completion_thread_.join();
 }
 }  // namespace otlp
 }  // namespace exporter
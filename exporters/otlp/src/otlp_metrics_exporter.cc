@@ -0,0 +1,372 @@
+#include "opentelemetry/exporters/otlp/otlp_metrics_exporter.h"
+
+#include <grpcpp/grpcpp.h>
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <type_traits>
+
+OPENTELEMETRY_BEGIN_NAMESPACE
+namespace exporter
+{
+namespace otlp
+{
+namespace metrics_proto = proto::metrics::v1;
+
+// ----------------------------- Helper functions ------------------------------
+
+namespace
+{
+uint64_t NowUnixNano()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * Add the labels of a record to a data point.
+ */
+template <typename DataPoint>
+void SetLabels(const sdk::metrics::LabelSet &labels, DataPoint *data_point)
+{
+  labels.ForEachLabel([data_point](nostd::string_view key, nostd::string_view value) {
+    auto label = data_point->add_labels();
+    label->set_key(key.data(), key.size());
+    label->set_value(value.data(), value.size());
+  });
+}
+
+/**
+ * @return whether sums recorded by an instrument only ever grow
+ */
+bool IsMonotonic(metrics_api::InstrumentKind kind)
+{
+  return kind == metrics_api::InstrumentKind::Counter ||
+         kind == metrics_api::InstrumentKind::SumObserver;
+}
+
+/**
+ * @return whether an instrument reports the total since the start rather than the change since
+ * the last collection; only the sum observers do.
+ */
+bool IsCumulative(metrics_api::InstrumentKind kind)
+{
+  return kind == metrics_api::InstrumentKind::SumObserver ||
+         kind == metrics_api::InstrumentKind::UpDownSumObserver;
+}
+
+/**
+ * Set the descriptor of a metric for the data points of aggregator.
+ */
+template <typename T>
+void SetDescriptor(sdk::metrics::Aggregator<T> &aggregator,
+                   metrics_proto::MetricDescriptor *descriptor)
+{
+  const auto instrument_kind = aggregator.get_instrument_kind();
+  auto temporality           = IsCumulative(instrument_kind)
+                         ? metrics_proto::MetricDescriptor::CUMULATIVE
+                         : metrics_proto::MetricDescriptor::DELTA;
+  switch (aggregator.get_aggregator_kind())
+  {
+    case sdk::metrics::AggregatorKind::Counter:
+      if (std::is_integral<T>::value)
+      {
+        descriptor->set_type(IsMonotonic(instrument_kind)
+                                 ? metrics_proto::MetricDescriptor::MONOTONIC_INT64
+                                 : metrics_proto::MetricDescriptor::INT64);
+      }
+      else
+      {
+        descriptor->set_type(IsMonotonic(instrument_kind)
+                                 ? metrics_proto::MetricDescriptor::MONOTONIC_DOUBLE
+                                 : metrics_proto::MetricDescriptor::DOUBLE);
+      }
+      break;
+    case sdk::metrics::AggregatorKind::Gauge:
+      descriptor->set_type(std::is_integral<T>::value ? metrics_proto::MetricDescriptor::INT64
+                                                      : metrics_proto::MetricDescriptor::DOUBLE);
+      temporality = metrics_proto::MetricDescriptor::INSTANTANEOUS;
+      break;
+    case sdk::metrics::AggregatorKind::Histogram:
+      descriptor->set_type(metrics_proto::MetricDescriptor::HISTOGRAM);
+      break;
+    case sdk::metrics::AggregatorKind::MinMaxSumCount:
+    case sdk::metrics::AggregatorKind::Sketch:
+    case sdk::metrics::AggregatorKind::Exact:
+      descriptor->set_type(metrics_proto::MetricDescriptor::SUMMARY);
+      break;
+  }
+  descriptor->set_temporality(temporality);
+}
+
+/**
+ * Add a scalar data point, of type int64 for integral values and double otherwise.
+ */
+template <typename T>
+metrics_proto::Int64DataPoint *AddScalarDataPoint(metrics_proto::Metric *metric,
+                                                  T value,
+                                                  std::true_type /* is_integral */)
+{
+  auto data_point = metric->add_int64_data_points();
+  data_point->set_value(static_cast<int64_t>(value));
+  return data_point;
+}
+
+template <typename T>
+metrics_proto::DoubleDataPoint *AddScalarDataPoint(metrics_proto::Metric *metric,
+                                                   T value,
+                                                   std::false_type /* is_integral */)
+{
+  auto data_point = metric->add_double_data_points();
+  data_point->set_value(static_cast<double>(value));
+  return data_point;
+}
+
+/**
+ * Set the labels and the time range of a data point.
+ */
+template <typename DataPoint>
+void SetCommonFields(const sdk::metrics::LabelSet &labels,
+                     uint64_t start_time_unix_nano,
+                     uint64_t time_unix_nano,
+                     DataPoint *data_point)
+{
+  SetLabels(labels, data_point);
+  data_point->set_start_time_unix_nano(start_time_unix_nano);
+  data_point->set_time_unix_nano(time_unix_nano);
+}
+
+void AddPercentile(metrics_proto::SummaryDataPoint *data_point, double percentile, double value)
+{
+  auto percentile_value = data_point->add_percentile_values();
+  percentile_value->set_percentile(percentile);
+  percentile_value->set_value(value);
+}
+
+/**
+ * Create a channel to options.endpoint with the default channel settings.
+ */
+std::shared_ptr<grpc::Channel> MakeChannel(const OtlpMetricsExporterOptions &options)
+{
+  OtlpExporterOptions channel_options;
+  channel_options.endpoint = options.endpoint;
+  return CreateOtlpChannel(channel_options);
+}
+}  // namespace
+
+// -------------------------------- Contructors --------------------------------
+
+OtlpMetricsExporter::OtlpMetricsExporter() : OtlpMetricsExporter(OtlpMetricsExporterOptions()) {}
+
+OtlpMetricsExporter::OtlpMetricsExporter(const OtlpMetricsExporterOptions &options)
+    : OtlpMetricsExporter(MakeChannel(options), options)
+{}
+
+OtlpMetricsExporter::OtlpMetricsExporter(std::shared_ptr<grpc::ChannelInterface> channel,
+                                         const OtlpMetricsExporterOptions &options)
+    : OtlpMetricsExporter(proto::collector::metrics::v1::MetricsService::NewStub(channel), options)
+{}
+
+OtlpMetricsExporter::OtlpMetricsExporter(
+    std::unique_ptr<proto::collector::metrics::v1::MetricsService::StubInterface> stub,
+    const OtlpMetricsExporterOptions &options)
+    : options_(options),
+      metrics_service_stub_(std::move(stub)),
+      start_time_unix_nano_(NowUnixNano()),
+      last_export_time_unix_nano_(start_time_unix_nano_)
+{}
+
+// ----------------------------- Exporter methods ------------------------------
+
+sdk::metrics::ExportResult OtlpMetricsExporter::Export(
+    const std::vector<sdk::metrics::Record> &records) noexcept
+{
+  const uint64_t now_unix_nano = NowUnixNano();
+  PopulateRequest(records, now_unix_nano);
+  last_export_time_unix_nano_ = now_unix_nano;
+
+  grpc::ClientContext context;
+  ConfigureOtlpContext(context, options_.timeout, options_.compression);
+  proto::collector::metrics::v1::ExportMetricsServiceResponse response;
+
+  grpc::Status status = metrics_service_stub_->Export(&context, request_, &response);
+
+  if (!status.ok())
+  {
+    std::cerr << "[OTLP Metrics Exporter] Export() failed: " << status.error_message() << "\n";
+    return sdk::metrics::ExportResult::kFailure;
+  }
+  return sdk::metrics::ExportResult::kSuccess;
+}
+
+void OtlpMetricsExporter::PopulateRequest(const std::vector<sdk::metrics::Record> &records,
+                                          uint64_t now_unix_nano)
+{
+  // Clearing keeps the messages of the previous request around, and adding messages reuses them.
+  request_.Clear();
+  metrics_by_name_.clear();
+  auto library_metrics =
+      request_.add_resource_metrics()->add_instrumentation_library_metrics()->mutable_metrics();
+
+  for (const auto &record : records)
+  {
+    auto &metric = metrics_by_name_[record.GetName()];
+    auto is_new  = metric == nullptr;
+    if (is_new)
+    {
+      metric = library_metrics->Add();
+      metric->mutable_metric_descriptor()->set_name(record.GetName());
+      metric->mutable_metric_descriptor()->set_description(record.GetDescription());
+    }
+
+    auto aggregator = record.GetAggregator();
+    if (nostd::holds_alternative<std::shared_ptr<sdk::metrics::Aggregator<int>>>(aggregator))
+    {
+      auto &agg = *nostd::get<std::shared_ptr<sdk::metrics::Aggregator<int>>>(aggregator);
+      if (is_new)
+      {
+        SetDescriptor(agg, metric->mutable_metric_descriptor());
+      }
+      AddDataPoint(agg, record.GetLabelSet(), now_unix_nano, metric);
+    }
+    else if (nostd::holds_alternative<std::shared_ptr<sdk::metrics::Aggregator<short>>>(
+                 aggregator))
+    {
+      auto &agg = *nostd::get<std::shared_ptr<sdk::metrics::Aggregator<short>>>(aggregator);
+      if (is_new)
+      {
+        SetDescriptor(agg, metric->mutable_metric_descriptor());
+      }
+      AddDataPoint(agg, record.GetLabelSet(), now_unix_nano, metric);
+    }
+    else if (nostd::holds_alternative<std::shared_ptr<sdk::metrics::Aggregator<double>>>(
+                 aggregator))
+    {
+      auto &agg = *nostd::get<std::shared_ptr<sdk::metrics::Aggregator<double>>>(aggregator);
+      if (is_new)
+      {
+        SetDescriptor(agg, metric->mutable_metric_descriptor());
+      }
+      AddDataPoint(agg, record.GetLabelSet(), now_unix_nano, metric);
+    }
+    else if (nostd::holds_alternative<std::shared_ptr<sdk::metrics::Aggregator<float>>>(
+                 aggregator))
+    {
+      auto &agg = *nostd::get<std::shared_ptr<sdk::metrics::Aggregator<float>>>(aggregator);
+      if (is_new)
+      {
+        SetDescriptor(agg, metric->mutable_metric_descriptor());
+      }
+      AddDataPoint(agg, record.GetLabelSet(), now_unix_nano, metric);
+    }
+  }
+}
+
+template <typename T>
+void OtlpMetricsExporter::AddDataPoint(sdk::metrics::Aggregator<T> &aggregator,
+                                       const sdk::metrics::LabelSet &labels,
+                                       uint64_t now_unix_nano,
+                                       metrics_proto::Metric *metric)
+{
+  const uint64_t start_time_unix_nano = IsCumulative(aggregator.get_instrument_kind())
+                                            ? start_time_unix_nano_
+                                            : last_export_time_unix_nano_;
+  switch (aggregator.get_aggregator_kind())
+  {
+    case sdk::metrics::AggregatorKind::Counter:
+    {
+      auto data_point = AddScalarDataPoint(metric, aggregator.get_checkpoint()[0],
+                                           std::is_integral<T>());
+      SetCommonFields(labels, start_time_unix_nano, now_unix_nano, data_point);
+    }
+    break;
+    case sdk::metrics::AggregatorKind::Gauge:
+    {
+      auto data_point = AddScalarDataPoint(metric, aggregator.get_checkpoint()[0],
+                                           std::is_integral<T>());
+      SetLabels(labels, data_point);
+      data_point->set_time_unix_nano(
+          aggregator.get_checkpoint_timestamp().time_since_epoch().count());
+    }
+    break;
+    case sdk::metrics::AggregatorKind::Histogram:
+    {
+      auto checkpoint = aggregator.get_checkpoint();
+      auto data_point = metric->add_histogram_data_points();
+      SetCommonFields(labels, start_time_unix_nano, now_unix_nano, data_point);
+      data_point->set_sum(static_cast<double>(checkpoint[0]));
+      data_point->set_count(static_cast<uint64_t>(checkpoint[1]));
+      for (auto count : aggregator.get_counts())
+      {
+        data_point->add_buckets()->set_count(static_cast<uint64_t>(count));
+      }
+      for (auto boundary : aggregator.get_boundaries())
+      {
+        data_point->add_explicit_bounds(boundary);
+      }
+    }
+    break;
+    case sdk::metrics::AggregatorKind::MinMaxSumCount:
+    {
+      // The checkpoint holds {min, max, sum, count}
+      auto checkpoint = aggregator.get_checkpoint();
+      auto data_point = metric->add_summary_data_points();
+      SetCommonFields(labels, start_time_unix_nano, now_unix_nano, data_point);
+      data_point->set_sum(static_cast<double>(checkpoint[2]));
+      data_point->set_count(static_cast<uint64_t>(checkpoint[3]));
+      AddPercentile(data_point, 0, static_cast<double>(checkpoint[0]));
+      AddPercentile(data_point, 100, static_cast<double>(checkpoint[1]));
+    }
+    break;
+    case sdk::metrics::AggregatorKind::Sketch:
+    {
+      // The checkpoint holds {sum, count}
+      auto checkpoint = aggregator.get_checkpoint();
+      auto data_point = metric->add_summary_data_points();
+      SetCommonFields(labels, start_time_unix_nano, now_unix_nano, data_point);
+      data_point->set_sum(static_cast<double>(checkpoint[0]));
+      data_point->set_count(static_cast<uint64_t>(checkpoint[1]));
+      if (checkpoint[1] > 0)
+      {
+        for (auto quantile : options_.summary_quantiles)
+        {
+          AddPercentile(data_point, quantile * 100,
+                        static_cast<double>(aggregator.get_quantiles(quantile)));
+        }
+      }
+    }
+    break;
+    case sdk::metrics::AggregatorKind::Exact:
+    {
+      // The checkpoint holds every value, sorted if the aggregator estimates quantiles
+      auto values     = aggregator.get_checkpoint();
+      auto data_point = metric->add_summary_data_points();
+      SetCommonFields(labels, start_time_unix_nano, now_unix_nano, data_point);
+      data_point->set_sum(std::accumulate(values.begin(), values.end(), 0.0));
+      data_point->set_count(values.size());
+      if (values.empty())
+      {
+        break;
+      }
+      if (aggregator.get_quant_estimation())
+      {
+        for (auto quantile : options_.summary_quantiles)
+        {
+          AddPercentile(data_point, quantile * 100,
+                        static_cast<double>(aggregator.get_quantiles(quantile)));
+        }
+      }
+      else
+      {
+        auto min_max = std::minmax_element(values.begin(), values.end());
+        AddPercentile(data_point, 0, static_cast<double>(*min_max.first));
+        AddPercentile(data_point, 100, static_cast<double>(*min_max.second));
+      }
+    }
+    break;
+  }
+}
+}  // namespace otlp
+}  // namespace exporter
+OPENTELEMETRY_END_NAMESPACE
@@ -8,13 +8,48 @@ namespace otlp
 
 const int kAttributeValueSize = 14;
 
+namespace
+{
+// Messages generated with arena support allocate their fields on the arena.
+template <class T>
+T *CreateOnArena(google::protobuf::Arena *arena, std::true_type)
+{
+  return google::protobuf::Arena::CreateMessage<T>(arena);
+}
+
+// Others can only be placed on the arena themselves; their fields are still
+// allocated on the heap.
+template <class T>
+T *CreateOnArena(google::protobuf::Arena *arena, std::false_type)
+{
+  return google::protobuf::Arena::Create<T>(arena);
+}
+}  // namespace
+
+Recordable::Recordable() : span_(new proto::trace::v1::Span) {}
+
+Recordable::Recordable(std::shared_ptr<google::protobuf::Arena> arena)
+    : arena_(std::move(arena)),
+      span_(CreateOnArena<proto::trace::v1::Span>(
+          arena_.get(),
+          google::protobuf::Arena::is_arena_constructable<proto::trace::v1::Span>()))
+{}
+
+Recordable::~Recordable()
+{
+  if (arena_ == nullptr)
+  {
+    delete span_;
+  }
+}
+
 void Recordable::SetIds(trace::TraceId trace_id,
                         trace::SpanId span_id,
                         trace::SpanId parent_span_id) noexcept
 {
-  span_.set_trace_id(reinterpret_cast<const char *>(trace_id.Id().data()), trace::TraceId::kSize);
-  span_.set_span_id(reinterpret_cast<const char *>(span_id.Id().data()), trace::SpanId::kSize);
-  span_.set_parent_span_id(reinterpret_cast<const char *>(parent_span_id.Id().data()),
+  span_->set_trace_id(reinterpret_cast<const char *>(trace_id.Id().data()), trace::TraceId::kSize);
+  span_->set_span_id(reinterpret_cast<const char *>(span_id.Id().data()), trace::SpanId::kSize);
+  span_->set_parent_span_id(reinterpret_cast<const char *>(parent_span_id.Id().data()),
                            trace::SpanId::kSize);
 }
 
@@ -114,7 +149,7 @@ void PopulateAttribute(opentelemetry::proto::common::v1::KeyValue *attribute,
 void Recordable::SetAttribute(nostd::string_view key,
                               const opentelemetry::common::AttributeValue &value) noexcept
 {
-  auto *attribute = span_.add_attributes();
+  auto *attribute = span_->add_attributes();
   PopulateAttribute(attribute, key, value);
 }
 
@@ -122,7 +157,7 @@ void Recordable::AddEvent(nostd::string_view name,
                           core::SystemTimestamp timestamp,
                           const trace::KeyValueIterable &attributes) noexcept
 {
-  auto *event = span_.add_events();
+  auto *event = span_->add_events();
   event->set_name(name.data(), name.size());
   event->set_time_unix_nano(timestamp.time_since_epoch().count());
 
@@ -135,7 +170,7 @@ void Recordable::AddEvent(nostd::string_view name,
 void Recordable::AddLink(opentelemetry::trace::SpanContext span_context,
                          const trace::KeyValueIterable &attributes) noexcept
 {
-  auto *link = span_.add_links();
+  auto *link = span_->add_links();
   attributes.ForEachKeyValue([&](nostd::string_view key, common::AttributeValue value) noexcept {
     PopulateAttribute(link->add_attributes(), key, value);
     return true;
@@ -145,24 +180,29 @@ void Recordable::AddLink(opentelemetry::trace::SpanContext span_context,
 
 void Recordable::SetStatus(trace::CanonicalCode code, nostd::string_view description) noexcept
 {
-  span_.mutable_status()->set_code(opentelemetry::proto::trace::v1::Status_StatusCode(code));
-  span_.mutable_status()->set_message(description.data(), description.size());
+  span_->mutable_status()->set_code(opentelemetry::proto::trace::v1::Status_StatusCode(code));
+  span_->mutable_status()->set_message(description.data(), description.size());
+}
+
+bool Recordable::HasErrorStatus() const noexcept
+{
+  return span_->status().code() != 0;
 }
 
 void Recordable::SetName(nostd::string_view name) noexcept
 {
-  span_.set_name(name.data(), name.size());
+  span_->set_name(name.data(), name.size());
 }
 
 void Recordable::SetStartTime(opentelemetry::core::SystemTimestamp start_time) noexcept
 {
-  span_.set_start_time_unix_nano(start_time.time_since_epoch().count());
+  span_->set_start_time_unix_nano(start_time.time_since_epoch().count());
 }
 
 void Recordable::SetDuration(std::chrono::nanoseconds duration) noexcept
 {
-  const uint64_t unix_end_time = span_.start_time_unix_nano() + duration.count();
-  span_.set_end_time_unix_nano(unix_end_time);
+  const uint64_t unix_end_time = span_->start_time_unix_nano() + duration.count();
+  span_->set_end_time_unix_nano(unix_end_time);
 }
 }  // namespace otlp
 }  // namespace exporter
@@ -2,7 +2,55 @@
 #include "opentelemetry/exporters/otlp/otlp_exporter.h"
 #include "opentelemetry/exporters/otlp/recordable.h"
 
+#include <grpcpp/alarm.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include <benchmark/benchmark.h>
+#include <zlib.h>
+
+// Count every heap allocation made by the process, so that benchmarks can report the number of
+// allocations per span.
+static std::atomic<uint64_t> g_num_allocations{0};
+
+void *operator new(std::size_t size)
+{
+  ++g_num_allocations;
+  if (void *ptr = std::malloc(size == 0 ? 1 : size))
+  {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+  ++g_num_allocations;
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+  std::free(ptr);
+}
 
 OPENTELEMETRY_BEGIN_NAMESPACE
 namespace exporter
@@ -14,6 +62,8 @@ const int kBatchSize     = 200;
 const int kNumAttributes = 5;
 const int kNumIterations = 1000;
 
+using RecordableBatch = std::array<std::unique_ptr<sdk::trace::Recordable>, kBatchSize>;
+
 const trace::TraceId kTraceId(std::array<const uint8_t, trace::TraceId::kSize>(
     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1}));
 const trace::SpanId kSpanId(std::array<const uint8_t, trace::SpanId::kSize>({0, 0, 0, 0, 0, 0, 0,
@@ -23,30 +73,78 @@ const trace::SpanId kParentSpanId(std::array<const uint8_t, trace::SpanId::kSize
 
 // ----------------------- Helper classes and functions ------------------------
 
-// Create a fake service stub to avoid dependency on gmock
+/**
+ * A response reader that completes its call on the completion queue after a fixed latency, as a
+ * collector's response would. gRPC never deletes response readers, so the stub owns them.
+ */
+class FakeAsyncResponseReader
+    : public grpc::ClientAsyncResponseReaderInterface<
+          proto::collector::trace::v1::ExportTraceServiceResponse>
+{
+public:
+  FakeAsyncResponseReader(grpc::CompletionQueue *cq, std::chrono::microseconds latency)
+      : cq_(cq), latency_(latency)
+  {}
+
+  void StartCall() override {}
+
+  void ReadInitialMetadata(void *) override {}
+
+  void Finish(proto::collector::trace::v1::ExportTraceServiceResponse *,
+              grpc::Status *status,
+              void *tag) override
+  {
+    *status = grpc::Status::OK;
+    alarm_.Set(cq_, std::chrono::system_clock::now() + latency_, tag);
+  }
+
+private:
+  grpc::CompletionQueue *cq_;
+  const std::chrono::microseconds latency_;
+  grpc::Alarm alarm_;
+};
+
+// Create a fake service stub to avoid dependency on gmock. Each call takes a fixed round-trip
+// latency, so that synchronous and asynchronous exports can be compared without a network.
 class FakeServiceStub : public proto::collector::trace::v1::TraceService::StubInterface
 {
+public:
+  explicit FakeServiceStub(std::chrono::microseconds latency = std::chrono::microseconds(0))
+      : latency_(latency)
+  {}
+
   grpc::Status Export(grpc::ClientContext *,
                       const proto::collector::trace::v1::ExportTraceServiceRequest &,
                       proto::collector::trace::v1::ExportTraceServiceResponse *) override
   {
+    if (latency_ > std::chrono::microseconds::zero())
+    {
+      std::this_thread::sleep_for(latency_);
+    }
     return grpc::Status::OK;
   }
 
+private:
+  const std::chrono::microseconds latency_;
+  std::mutex readers_m_;
+  std::vector<std::unique_ptr<FakeAsyncResponseReader>> readers_;
+
   grpc::ClientAsyncResponseReaderInterface<proto::collector::trace::v1::ExportTraceServiceResponse>
-      *AsyncExportRaw(grpc::ClientContext *,
-                      const proto::collector::trace::v1::ExportTraceServiceRequest &,
-                      grpc::CompletionQueue *) override
+      *AsyncExportRaw(grpc::ClientContext *context,
+                      const proto::collector::trace::v1::ExportTraceServiceRequest &request,
+                      grpc::CompletionQueue *cq) override
   {
-    return nullptr;
+    return PrepareAsyncExportRaw(context, request, cq);
   }
 
   grpc::ClientAsyncResponseReaderInterface<proto::collector::trace::v1::ExportTraceServiceResponse>
       *PrepareAsyncExportRaw(grpc::ClientContext *,
                              const proto::collector::trace::v1::ExportTraceServiceRequest &,
-                             grpc::CompletionQueue *) override
+                             grpc::CompletionQueue *cq) override
   {
-    return nullptr;
+    std::lock_guard<std::mutex> lk(readers_m_);
+    readers_.emplace_back(new FakeAsyncResponseReader(cq, latency_));
+    return readers_.back().get();
   }
 };
 
@@ -54,32 +152,34 @@ class FakeServiceStub : public proto::collector::trace::v1::TraceService::StubIn
 class OtlpExporterTestPeer
 {
 public:
-  std::unique_ptr<sdk::trace::SpanExporter> GetExporter()
+  std::unique_ptr<sdk::trace::SpanExporter> GetExporter(
+      const OtlpExporterOptions &options = OtlpExporterOptions(),
+      std::chrono::microseconds latency  = std::chrono::microseconds(0))
   {
-    auto mock_stub = new FakeServiceStub();
+    auto mock_stub = new FakeServiceStub(latency);
     std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface> stub_interface(
         mock_stub);
     return std::unique_ptr<sdk::trace::SpanExporter>(
-        new exporter::otlp::OtlpExporter(std::move(stub_interface)));
+        new exporter::otlp::OtlpExporter(std::move(stub_interface), options));
   }
 };
 
 // Helper function to create empty spans
-void CreateEmptySpans(std::array<std::unique_ptr<sdk::trace::Recordable>, kBatchSize> &recordables)
+void CreateEmptySpans(sdk::trace::SpanExporter &exporter, RecordableBatch &recordables)
 {
   for (int i = 0; i < kBatchSize; i++)
   {
-    auto recordable = std::unique_ptr<sdk::trace::Recordable>(new Recordable);
+    auto recordable = exporter.MakeRecordable();
     recordables[i]  = std::move(recordable);
   }
 }
 
 // Helper function to create sparse spans
-void CreateSparseSpans(std::array<std::unique_ptr<sdk::trace::Recordable>, kBatchSize> &recordables)
+void CreateSparseSpans(sdk::trace::SpanExporter &exporter, RecordableBatch &recordables)
 {
   for (int i = 0; i < kBatchSize; i++)
   {
-    auto recordable = std::unique_ptr<sdk::trace::Recordable>(new Recordable);
+    auto recordable = exporter.MakeRecordable();
 
     recordable->SetIds(kTraceId, kSpanId, kParentSpanId);
     recordable->SetName("TestSpan");
@@ -91,11 +191,11 @@ void CreateSparseSpans(std::array<std::unique_ptr<sdk::trace::Recordable>, kBatc
 }
 
 // Helper function to create dense spans
-void CreateDenseSpans(std::array<std::unique_ptr<sdk::trace::Recordable>, kBatchSize> &recordables)
+void CreateDenseSpans(sdk::trace::SpanExporter &exporter, RecordableBatch &recordables)
 {
   for (int i = 0; i < kBatchSize; i++)
   {
-    auto recordable = std::unique_ptr<sdk::trace::Recordable>(new Recordable);
+    auto recordable = exporter.MakeRecordable();
 
     recordable->SetIds(kTraceId, kSpanId, kParentSpanId);
     recordable->SetName("TestSpan");
@@ -115,50 +215,144 @@ void CreateDenseSpans(std::array<std::unique_ptr<sdk::trace::Recordable>, kBatch
 
 // ------------------------------ Benchmark tests ------------------------------
 
-// Benchmark Export() with empty spans
-void BM_OtlpExporterEmptySpans(benchmark::State &state)
+// Benchmark Export() of batches made by create_spans, reporting the time and the number of heap
+// allocations per span, including those made while creating the spans. The benchmark's argument
+// is the arena block size.
+void BenchmarkExport(benchmark::State &state,
+                     void (*create_spans)(sdk::trace::SpanExporter &, RecordableBatch &))
 {
   std::unique_ptr<OtlpExporterTestPeer> testpeer(new OtlpExporterTestPeer());
-  auto exporter = testpeer->GetExporter();
+  OtlpExporterOptions options;
+  options.arena_block_size = static_cast<size_t>(state.range(0));
+  auto exporter            = testpeer->GetExporter(options);
 
+  uint64_t num_spans       = 0;
+  uint64_t num_allocations = 0;
   while (state.KeepRunningBatch(kNumIterations))
   {
-    std::array<std::unique_ptr<sdk::trace::Recordable>, kBatchSize> recordables;
-    CreateEmptySpans(recordables);
+    auto allocations_before = g_num_allocations.load();
+    RecordableBatch recordables;
+    create_spans(*exporter, recordables);
     exporter->Export(nostd::span<std::unique_ptr<sdk::trace::Recordable>>(recordables));
+    num_allocations += g_num_allocations.load() - allocations_before;
+    num_spans += kBatchSize;
   }
+  state.counters["allocations_per_span"] =
+      static_cast<double>(num_allocations) / static_cast<double>(num_spans);
+  state.counters["time_per_span"] = benchmark::Counter(
+      static_cast<double>(num_spans), benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
 }
-BENCHMARK(BM_OtlpExporterEmptySpans);
+
+// Benchmark Export() with empty spans
+void BM_OtlpExporterEmptySpans(benchmark::State &state)
+{
+  BenchmarkExport(state, CreateEmptySpans);
+}
+BENCHMARK(BM_OtlpExporterEmptySpans)->Arg(0)->Arg(256 * 1024);
 
 // Benchmark Export() with sparse spans
 void BM_OtlpExporterSparseSpans(benchmark::State &state)
 {
+  BenchmarkExport(state, CreateSparseSpans);
+}
+BENCHMARK(BM_OtlpExporterSparseSpans)->Arg(0)->Arg(256 * 1024);
+
+// Benchmark Export() with dense spans
+void BM_OtlpExporterDenseSpans(benchmark::State &state)
+{
+  BenchmarkExport(state, CreateDenseSpans);
+}
+BENCHMARK(BM_OtlpExporterDenseSpans)->Arg(0)->Arg(256 * 1024);
+
+// Benchmark Export() of sparse spans to a collector that takes 1ms to respond, either waiting for
+// each response or with up to 8 requests in flight
+void BM_OtlpExporterRoundTrip(benchmark::State &state)
+{
+  OtlpExporterOptions options;
+  options.async_export           = state.range(0) != 0;
+  options.max_in_flight_requests = 8;
   std::unique_ptr<OtlpExporterTestPeer> testpeer(new OtlpExporterTestPeer());
-  auto exporter = testpeer->GetExporter();
+  auto exporter = testpeer->GetExporter(options, std::chrono::milliseconds(1));
 
-  while (state.KeepRunningBatch(kNumIterations))
+  for (auto _ : state)
   {
-    std::array<std::unique_ptr<sdk::trace::Recordable>, kBatchSize> recordables;
-    CreateSparseSpans(recordables);
+    RecordableBatch recordables;
+    CreateSparseSpans(*exporter, recordables);
     exporter->Export(nostd::span<std::unique_ptr<sdk::trace::Recordable>>(recordables));
   }
+  // Count the requests still in flight.
+  exporter->Shutdown();
+  state.SetItemsProcessed(state.iterations() * kBatchSize);
 }
-BENCHMARK(BM_OtlpExporterSparseSpans);
+BENCHMARK(BM_OtlpExporterRoundTrip)->Arg(0)->Arg(1)->UseRealTime();
 
-// Benchmark Export() with dense spans
-void BM_OtlpExporterDenseSpans(benchmark::State &state)
+// Benchmark the compression of export requests of N dense spans at zlib level M, where level 0
+// only serializes the request. gRPC's gzip and deflate compression use zlib's default level, 6.
+// Reports the compression ratio, the compressed bytes per span and the time per span spent
+// serializing and compressing, to weigh the CPU cost of compression against the bytes it saves.
+void BM_OtlpExporterCompression(benchmark::State &state)
 {
-  std::unique_ptr<OtlpExporterTestPeer> testpeer(new OtlpExporterTestPeer());
-  auto exporter = testpeer->GetExporter();
+  const int num_spans = static_cast<int>(state.range(0));
+  const int level     = static_cast<int>(state.range(1));
 
-  while (state.KeepRunningBatch(kNumIterations))
+  proto::collector::trace::v1::ExportTraceServiceRequest request;
+  auto library_spans = request.add_resource_spans()->add_instrumentation_library_spans();
+  for (int i = 0; i < num_spans; i++)
   {
-    std::array<std::unique_ptr<sdk::trace::Recordable>, kBatchSize> recordables;
-    CreateDenseSpans(recordables);
-    exporter->Export(nostd::span<std::unique_ptr<sdk::trace::Recordable>>(recordables));
+    // Give each span its own id, as random ids are what compresses worst
+    uint8_t span_id[trace::SpanId::kSize] = {};
+    for (size_t j = 0; j < sizeof(span_id); j++)
+    {
+      span_id[j] = static_cast<uint8_t>((i * 2654435761u) >> (j * 4));
+    }
+    Recordable recordable;
+    recordable.SetIds(kTraceId, trace::SpanId(span_id), kParentSpanId);
+    recordable.SetName("TestSpan");
+    recordable.SetStartTime(core::SystemTimestamp(std::chrono::system_clock::now()));
+    recordable.SetDuration(std::chrono::nanoseconds(10));
+    for (int j = 0; j < kNumAttributes; j++)
+    {
+      recordable.SetAttribute("int_key_" + std::to_string(j), static_cast<int64_t>(j));
+      recordable.SetAttribute("str_key_" + std::to_string(j), "string_val_" + std::to_string(j));
+      recordable.SetAttribute("bool_key_" + std::to_string(j), true);
+    }
+    *library_spans->add_spans() = recordable.span();
   }
+
+  std::string serialized;
+  std::vector<Bytef> compressed;
+  uLongf compressed_size = 0;
+  for (auto _ : state)
+  {
+    request.SerializeToString(&serialized);
+    compressed_size = static_cast<uLongf>(serialized.size());
+    if (level > 0)
+    {
+      compressed.resize(compressBound(static_cast<uLong>(serialized.size())));
+      compressed_size = static_cast<uLongf>(compressed.size());
+      compress2(compressed.data(), &compressed_size,
+                reinterpret_cast<const Bytef *>(serialized.data()),
+                static_cast<uLong>(serialized.size()), level);
+    }
+    benchmark::DoNotOptimize(compressed.data());
+  }
+  state.counters["compression_ratio"] =
+      static_cast<double>(serialized.size()) / static_cast<double>(compressed_size);
+  state.counters["bytes_per_span"] =
+      static_cast<double>(compressed_size) / static_cast<double>(num_spans);
+  state.counters["time_per_span"] =
+      benchmark::Counter(static_cast<double>(state.iterations() * num_spans),
+                         benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
 }
-BENCHMARK(BM_OtlpExporterDenseSpans);
+BENCHMARK(BM_OtlpExporterCompression)->Apply([](benchmark::internal::Benchmark *benchmark) {
+  for (int num_spans : {16, 128, 512})
+  {
+    for (int level : {0, 1, 6, 9})
+    {
+      benchmark->Args({num_spans, level});
+    }
+  }
+});
 
 }  // namespace otlp
 }  // namespace exporter
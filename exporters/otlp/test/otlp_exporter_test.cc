@@ -1,12 +1,22 @@
 #include "opentelemetry/exporters/otlp/otlp_exporter.h"
 #include "opentelemetry/context/threadlocal_context.h"
+#include "opentelemetry/exporters/otlp/recordable.h"
 #include "opentelemetry/proto/collector/trace/v1/trace_service_mock.grpc.pb.h"
 #include "opentelemetry/sdk/trace/simple_processor.h"
 #include "opentelemetry/sdk/trace/tracer_provider.h"
 #include "opentelemetry/trace/provider.h"
 
+#include <grpcpp/alarm.h>
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
 using namespace testing;
 
 OPENTELEMETRY_BEGIN_NAMESPACE
@@ -15,13 +25,135 @@ namespace exporter
 namespace otlp
 {
 
+/**
+ * A response reader that completes its call with the given status after a delay. gRPC never
+ * deletes response readers, so the test owns them.
+ */
+class FakeAsyncResponseReader
+    : public grpc::ClientAsyncResponseReaderInterface<
+          proto::collector::trace::v1::ExportTraceServiceResponse>
+{
+public:
+  FakeAsyncResponseReader(grpc::CompletionQueue *cq,
+                          grpc::Status status,
+                          std::chrono::milliseconds latency)
+      : cq_(cq), status_(status), latency_(latency)
+  {}
+
+  void StartCall() override {}
+
+  void ReadInitialMetadata(void *) override {}
+
+  void Finish(proto::collector::trace::v1::ExportTraceServiceResponse *,
+              grpc::Status *status,
+              void *tag) override
+  {
+    *status = status_;
+    alarm_.Set(cq_, std::chrono::system_clock::now() + latency_, tag);
+  }
+
+private:
+  grpc::CompletionQueue *cq_;
+  grpc::Status status_;
+  const std::chrono::milliseconds latency_;
+  grpc::Alarm alarm_;
+};
+
+/**
+ * An in-process stand-in for the collector, listening on a free local port. It records the peer
+ * that each request came from, and can hold a request to stall the connection it came on.
+ */
+class FakeCollector final : public proto::collector::trace::v1::TraceService::Service
+{
+public:
+  FakeCollector()
+  {
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &port_);
+    builder.RegisterService(this);
+    server_ = builder.BuildAndStart();
+  }
+
+  ~FakeCollector()
+  {
+    Release();
+    server_->Shutdown();
+  }
+
+  std::string endpoint() const { return "127.0.0.1:" + std::to_string(port_); }
+
+  grpc::Status Export(grpc::ServerContext *context,
+                      const proto::collector::trace::v1::ExportTraceServiceRequest *request,
+                      proto::collector::trace::v1::ExportTraceServiceResponse *) override
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    peers_.push_back(context->peer());
+    num_spans_ += request->resource_spans(0).instrumentation_library_spans(0).spans_size();
+    cv_.notify_all();
+    if (stall_next_request_)
+    {
+      stall_next_request_ = false;
+      cv_.wait(lk, [this] { return released_; });
+    }
+    return grpc::Status::OK;
+  }
+
+  /* Hold the next request until Release is called */
+  void StallNextRequest()
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    stall_next_request_ = true;
+    released_           = false;
+  }
+
+  void Release()
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    released_ = true;
+    cv_.notify_all();
+  }
+
+  /* @return true if num_requests requests arrived within a second */
+  bool WaitForRequests(size_t num_requests)
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    return cv_.wait_for(lk, std::chrono::seconds(1),
+                        [&] { return peers_.size() >= num_requests; });
+  }
+
+  std::vector<std::string> peers()
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    return peers_;
+  }
+
+  int num_spans()
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    return num_spans_;
+  }
+
+private:
+  int port_ = 0;
+  std::unique_ptr<grpc::Server> server_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::vector<std::string> peers_;
+  int num_spans_           = 0;
+  bool stall_next_request_ = false;
+  bool released_           = true;
+};
+
 class OtlpExporterTestPeer : public ::testing::Test
 {
 public:
   std::unique_ptr<sdk::trace::SpanExporter> GetExporter(
-      std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface> &stub_interface)
+      std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface> &stub_interface,
+      const OtlpExporterOptions &options = OtlpExporterOptions())
   {
-    return std::unique_ptr<sdk::trace::SpanExporter>(new OtlpExporter(std::move(stub_interface)));
+    return std::unique_ptr<sdk::trace::SpanExporter>(
+        new OtlpExporter(std::move(stub_interface), options));
   }
 };
 
@@ -53,6 +185,174 @@ TEST_F(OtlpExporterTestPeer, ExportUnitTest)
   EXPECT_EQ(sdk::trace::ExportResult::kFailure, result);
 }
 
+// The request holds the recordables' spans, which the recordables keep
+TEST_F(OtlpExporterTestPeer, ExportRequestContents)
+{
+  auto mock_stub = new proto::collector::trace::v1::MockTraceServiceStub();
+  std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface> stub_interface(
+      mock_stub);
+  OtlpExporterOptions options;
+  options.arena_block_size = 64 * 1024;
+  auto exporter            = GetExporter(stub_interface, options);
+
+  std::unique_ptr<sdk::trace::Recordable> recordables[2] = {exporter->MakeRecordable(),
+                                                            exporter->MakeRecordable()};
+  recordables[0]->SetName("Test span 1");
+  recordables[1]->SetName("Test span 2");
+
+  EXPECT_CALL(*mock_stub, Export(_, _, _))
+      .Times(Exactly(1))
+      .WillOnce(Invoke([](grpc::ClientContext *,
+                          const proto::collector::trace::v1::ExportTraceServiceRequest &request,
+                          proto::collector::trace::v1::ExportTraceServiceResponse *) {
+        auto &spans = request.resource_spans(0).instrumentation_library_spans(0).spans();
+        EXPECT_EQ(2, spans.size());
+        EXPECT_EQ("Test span 1", spans.Get(0).name());
+        EXPECT_EQ("Test span 2", spans.Get(1).name());
+        return grpc::Status::OK;
+      }));
+  EXPECT_EQ(sdk::trace::ExportResult::kSuccess,
+            exporter->Export(nostd::span<std::unique_ptr<sdk::trace::Recordable>>(recordables)));
+
+  ASSERT_NE(nullptr, recordables[1]);
+  EXPECT_EQ("Test span 2", static_cast<Recordable *>(recordables[1].get())->span().name());
+}
+
+// Every request gets the configured deadline
+TEST_F(OtlpExporterTestPeer, ExportDeadline)
+{
+  auto mock_stub = new proto::collector::trace::v1::MockTraceServiceStub();
+  std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface> stub_interface(
+      mock_stub);
+  OtlpExporterOptions options;
+  options.timeout = std::chrono::milliseconds(500);
+  auto exporter   = GetExporter(stub_interface, options);
+
+  auto recordable = exporter->MakeRecordable();
+  nostd::span<std::unique_ptr<sdk::trace::Recordable>> batch(&recordable, 1);
+  auto latest_deadline = std::chrono::system_clock::now() + options.timeout;
+  EXPECT_CALL(*mock_stub, Export(_, _, _))
+      .Times(Exactly(1))
+      .WillOnce(Invoke([&](grpc::ClientContext *context,
+                           const proto::collector::trace::v1::ExportTraceServiceRequest &,
+                           proto::collector::trace::v1::ExportTraceServiceResponse *) {
+        EXPECT_LE(context->deadline(), latest_deadline + std::chrono::milliseconds(100));
+        return grpc::Status::OK;
+      }));
+  EXPECT_EQ(sdk::trace::ExportResult::kSuccess, exporter->Export(batch));
+}
+
+// Requests are compressed with the configured algorithm
+TEST_F(OtlpExporterTestPeer, ExportCompression)
+{
+  auto mock_stub = new proto::collector::trace::v1::MockTraceServiceStub();
+  std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface> stub_interface(
+      mock_stub);
+  OtlpExporterOptions options;
+  options.compression = OtlpCompression::kGzip;
+  auto exporter       = GetExporter(stub_interface, options);
+
+  auto recordable = exporter->MakeRecordable();
+  nostd::span<std::unique_ptr<sdk::trace::Recordable>> batch(&recordable, 1);
+  EXPECT_CALL(*mock_stub, Export(_, _, _))
+      .Times(Exactly(1))
+      .WillOnce(Invoke([](grpc::ClientContext *context,
+                          const proto::collector::trace::v1::ExportTraceServiceRequest &,
+                          proto::collector::trace::v1::ExportTraceServiceResponse *) {
+        EXPECT_EQ(GRPC_COMPRESS_GZIP, context->compression_algorithm());
+        return grpc::Status::OK;
+      }));
+  EXPECT_EQ(sdk::trace::ExportResult::kSuccess, exporter->Export(batch));
+}
+
+// Export() returns before the response arrives, with a bounded number of requests in flight
+TEST_F(OtlpExporterTestPeer, AsyncExportUnitTest)
+{
+  const auto latency = std::chrono::milliseconds(50);
+  std::vector<std::unique_ptr<FakeAsyncResponseReader>> readers;
+  auto make_reader   = [&](grpc::CompletionQueue *cq, grpc::Status status) {
+    readers.emplace_back(new FakeAsyncResponseReader(cq, status, latency));
+    return readers.back().get();
+  };
+
+  auto mock_stub = new proto::collector::trace::v1::MockTraceServiceStub();
+  std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface> stub_interface(
+      mock_stub);
+  OtlpExporterOptions options;
+  options.async_export           = true;
+  options.max_in_flight_requests = 1;
+  auto exporter                  = GetExporter(stub_interface, options);
+
+  EXPECT_CALL(*mock_stub, PrepareAsyncExportRaw(_, _, _))
+      .Times(Exactly(2))
+      .WillOnce(Invoke([&](grpc::ClientContext *,
+                           const proto::collector::trace::v1::ExportTraceServiceRequest &,
+                           grpc::CompletionQueue *cq) {
+        return make_reader(cq, grpc::Status::OK);
+      }))
+      .WillOnce(Invoke([&](grpc::ClientContext *,
+                           const proto::collector::trace::v1::ExportTraceServiceRequest &,
+                           grpc::CompletionQueue *cq) {
+        return make_reader(cq, grpc::Status::CANCELLED);
+      }));
+
+  auto start        = std::chrono::steady_clock::now();
+  auto recordable_1 = exporter->MakeRecordable();
+  nostd::span<std::unique_ptr<sdk::trace::Recordable>> batch_1(&recordable_1, 1);
+  EXPECT_EQ(sdk::trace::ExportResult::kSuccess, exporter->Export(batch_1));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, latency);
+
+  // The second request waits for the first one's response.
+  auto recordable_2 = exporter->MakeRecordable();
+  nostd::span<std::unique_ptr<sdk::trace::Recordable>> batch_2(&recordable_2, 1);
+  EXPECT_EQ(sdk::trace::ExportResult::kSuccess, exporter->Export(batch_2));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, latency);
+
+  // Shutdown waits for the response still in flight.
+  exporter->Shutdown();
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 2 * latency);
+  EXPECT_EQ(sdk::trace::ExportResult::kFailure, exporter->Export(batch_2));
+}
+
+// An Export() waiting for a free slot when the exporter shuts down fails without sending
+TEST_F(OtlpExporterTestPeer, AsyncExportDuringShutdown)
+{
+  const auto latency = std::chrono::milliseconds(200);
+  std::unique_ptr<FakeAsyncResponseReader> reader;
+
+  auto mock_stub = new proto::collector::trace::v1::MockTraceServiceStub();
+  std::unique_ptr<proto::collector::trace::v1::TraceService::StubInterface> stub_interface(
+      mock_stub);
+  OtlpExporterOptions options;
+  options.async_export           = true;
+  options.max_in_flight_requests = 1;
+  auto exporter                  = GetExporter(stub_interface, options);
+
+  EXPECT_CALL(*mock_stub, PrepareAsyncExportRaw(_, _, _))
+      .Times(Exactly(1))
+      .WillOnce(Invoke([&](grpc::ClientContext *,
+                           const proto::collector::trace::v1::ExportTraceServiceRequest &,
+                           grpc::CompletionQueue *cq) {
+        reader.reset(new FakeAsyncResponseReader(cq, grpc::Status::OK, latency));
+        return reader.get();
+      }));
+
+  auto recordable_1 = exporter->MakeRecordable();
+  nostd::span<std::unique_ptr<sdk::trace::Recordable>> batch_1(&recordable_1, 1);
+  EXPECT_EQ(sdk::trace::ExportResult::kSuccess, exporter->Export(batch_1));
+
+  auto result       = sdk::trace::ExportResult::kSuccess;
+  auto recordable_2 = exporter->MakeRecordable();
+  std::thread export_thread([&] {
+    nostd::span<std::unique_ptr<sdk::trace::Recordable>> batch_2(&recordable_2, 1);
+    result = exporter->Export(batch_2);
+  });
+
+  exporter->Shutdown(std::chrono::milliseconds(10));
+  export_thread.join();
+  EXPECT_EQ(sdk::trace::ExportResult::kFailure, result);
+}
+
 // Create spans, let processor call Export()
 TEST_F(OtlpExporterTestPeer, ExportIntegrationTest)
 {
@@ -77,6 +377,72 @@ TEST_F(OtlpExporterTestPeer, ExportIntegrationTest)
   child_span->End();
   parent_span->End();
 }
+// Requests reach a collector at the configured endpoint, taking turns between the channels
+TEST_F(OtlpExporterTestPeer, ExportToCollector)
+{
+  FakeCollector collector;
+  OtlpExporterOptions options;
+  options.endpoint      = collector.endpoint();
+  options.channel_count = 2;
+  options.timeout       = std::chrono::milliseconds(5000);
+  OtlpExporter exporter(options);
+
+  for (int i = 0; i < 4; ++i)
+  {
+    auto recordable = exporter.MakeRecordable();
+    recordable->SetName("Test span");
+    nostd::span<std::unique_ptr<sdk::trace::Recordable>> batch(&recordable, 1);
+    EXPECT_EQ(sdk::trace::ExportResult::kSuccess, exporter.Export(batch));
+  }
+
+  EXPECT_EQ(4, collector.num_spans());
+  auto peers = collector.peers();
+  EXPECT_EQ(2, std::set<std::string>(peers.begin(), peers.end()).size());
+}
+
+// A request held by the collector doesn't keep the next one from going out on another connection
+TEST_F(OtlpExporterTestPeer, ExportAroundStalledChannel)
+{
+  FakeCollector collector;
+  OtlpExporterOptions options;
+  options.endpoint      = collector.endpoint();
+  options.channel_count = 2;
+  options.async_export  = true;
+  options.timeout       = std::chrono::milliseconds(5000);
+  OtlpExporter exporter(options);
+
+  auto export_span = [&exporter] {
+    auto recordable = exporter.MakeRecordable();
+    nostd::span<std::unique_ptr<sdk::trace::Recordable>> batch(&recordable, 1);
+    exporter.Export(batch);
+  };
+  collector.StallNextRequest();
+  export_span();
+  ASSERT_TRUE(collector.WaitForRequests(1));
+  export_span();
+  ASSERT_TRUE(collector.WaitForRequests(2));
+
+  auto peers = collector.peers();
+  EXPECT_NE(peers[0], peers[1]);
+  collector.Release();
+  exporter.Shutdown();
+}
+
+// Requests over max_send_message_size fail without reaching the collector
+TEST_F(OtlpExporterTestPeer, ExportMaxSendMessageSize)
+{
+  FakeCollector collector;
+  OtlpExporterOptions options;
+  options.endpoint              = collector.endpoint();
+  options.max_send_message_size = 64;
+  OtlpExporter exporter(options);
+
+  auto recordable = exporter.MakeRecordable();
+  recordable->SetName(std::string(128, 'x'));
+  nostd::span<std::unique_ptr<sdk::trace::Recordable>> batch(&recordable, 1);
+  EXPECT_EQ(sdk::trace::ExportResult::kFailure, exporter.Export(batch));
+  EXPECT_EQ(0, collector.num_spans());
+}
 }  // namespace otlp
 }  // namespace exporter
 OPENTELEMETRY_END_NAMESPACE
@@ -0,0 +1,337 @@
+#include "opentelemetry/exporters/otlp/otlp_metrics_exporter.h"
+#include "opentelemetry/proto/collector/metrics/v1/metrics_service_mock.grpc.pb.h"
+#include "opentelemetry/sdk/metrics/aggregator/counter_aggregator.h"
+#include "opentelemetry/sdk/metrics/aggregator/exact_aggregator.h"
+#include "opentelemetry/sdk/metrics/aggregator/histogram_aggregator.h"
+#include "opentelemetry/sdk/metrics/aggregator/min_max_sum_count_aggregator.h"
+#include "opentelemetry/sdk/metrics/aggregator/sketch_aggregator.h"
+#include "opentelemetry/trace/key_value_iterable_view.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace testing;
+
+OPENTELEMETRY_BEGIN_NAMESPACE
+namespace exporter
+{
+namespace otlp
+{
+namespace metrics_proto = proto::metrics::v1;
+
+class OtlpMetricsExporterTestPeer : public ::testing::Test
+{
+public:
+  void SetUp() override
+  {
+    mock_stub_ = new proto::collector::metrics::v1::MockMetricsServiceStub();
+    exporter_.reset(new OtlpMetricsExporter(
+        std::unique_ptr<proto::collector::metrics::v1::MetricsService::StubInterface>(mock_stub_),
+        OtlpMetricsExporterOptions()));
+  }
+
+  /**
+   * Export records, and return the request that the collector received.
+   */
+  proto::collector::metrics::v1::ExportMetricsServiceRequest Export(
+      const std::vector<sdk::metrics::Record> &records)
+  {
+    proto::collector::metrics::v1::ExportMetricsServiceRequest received;
+    EXPECT_CALL(*mock_stub_, Export(_, _, _))
+        .Times(Exactly(1))
+        .WillOnce(DoAll(SaveArg<1>(&received), Return(grpc::Status::OK)));
+    EXPECT_EQ(sdk::metrics::ExportResult::kSuccess, exporter_->Export(records));
+    return received;
+  }
+
+  /**
+   * Create a record whose label set holds labels.
+   */
+  template <typename T>
+  sdk::metrics::Record MakeRecord(const std::string &name,
+                                  const std::map<std::string, std::string> &labels,
+                                  std::shared_ptr<sdk::metrics::Aggregator<T>> aggregator)
+  {
+    sdk::metrics::LabelSet label_set{
+        trace::KeyValueIterableView<std::map<std::string, std::string>>{labels}};
+    return sdk::metrics::Record(name, "desc", label_set.ToString(), label_set, aggregator);
+  }
+
+  const metrics_proto::Metric &GetMetric(
+      const proto::collector::metrics::v1::ExportMetricsServiceRequest &request,
+      int index)
+  {
+    return request.resource_metrics(0).instrumentation_library_metrics(0).metrics(index);
+  }
+
+protected:
+  proto::collector::metrics::v1::MockMetricsServiceStub *mock_stub_;
+  std::unique_ptr<OtlpMetricsExporter> exporter_;
+};
+
+// Records of the same counter become data points of one metric
+TEST_F(OtlpMetricsExporterTestPeer, ExportCounter)
+{
+  auto first = std::make_shared<sdk::metrics::CounterAggregator<int>>(
+      metrics_api::InstrumentKind::Counter);
+  auto second = std::make_shared<sdk::metrics::CounterAggregator<int>>(
+      metrics_api::InstrumentKind::Counter);
+  auto up_down = std::make_shared<sdk::metrics::CounterAggregator<double>>(
+      metrics_api::InstrumentKind::UpDownCounter);
+  first->update(5);
+  first->checkpoint();
+  second->update(7);
+  second->checkpoint();
+  up_down->update(-1.5);
+  up_down->checkpoint();
+
+  std::vector<sdk::metrics::Record> records = {
+      MakeRecord<int>("requests", {{"method", "GET"}, {"code", "200"}}, first),
+      MakeRecord<int>("requests", {}, second),
+      MakeRecord<double>("queue", {{"name", "a"}}, up_down)};
+  auto request = Export(records);
+
+  ASSERT_EQ(2, request.resource_metrics(0).instrumentation_library_metrics(0).metrics_size());
+  auto &requests = GetMetric(request, 0);
+  EXPECT_EQ("requests", requests.metric_descriptor().name());
+  EXPECT_EQ("desc", requests.metric_descriptor().description());
+  EXPECT_EQ(metrics_proto::MetricDescriptor::MONOTONIC_INT64, requests.metric_descriptor().type());
+  EXPECT_EQ(metrics_proto::MetricDescriptor::DELTA, requests.metric_descriptor().temporality());
+  ASSERT_EQ(2, requests.int64_data_points_size());
+  auto &point = requests.int64_data_points(0);
+  EXPECT_EQ(5, point.value());
+  EXPECT_LT(point.start_time_unix_nano(), point.time_unix_nano());
+  ASSERT_EQ(2, point.labels_size());
+  EXPECT_EQ("code", point.labels(0).key());
+  EXPECT_EQ("200", point.labels(0).value());
+  EXPECT_EQ("method", point.labels(1).key());
+  EXPECT_EQ("GET", point.labels(1).value());
+  EXPECT_EQ(7, requests.int64_data_points(1).value());
+  EXPECT_EQ(0, requests.int64_data_points(1).labels_size());
+
+  auto &queue = GetMetric(request, 1);
+  EXPECT_EQ(metrics_proto::MetricDescriptor::DOUBLE, queue.metric_descriptor().type());
+  ASSERT_EQ(1, queue.double_data_points_size());
+  EXPECT_EQ(-1.5, queue.double_data_points(0).value());
+  ASSERT_EQ(1, queue.double_data_points(0).labels_size());
+  EXPECT_EQ("a", queue.double_data_points(0).labels(0).value());
+}
+
+TEST_F(OtlpMetricsExporterTestPeer, ExportHistogram)
+{
+  auto aggregator = std::make_shared<sdk::metrics::HistogramAggregator<double>>(
+      metrics_api::InstrumentKind::ValueRecorder, std::vector<double>{10, 20});
+  aggregator->update(5);
+  aggregator->update(15);
+  aggregator->update(16);
+  aggregator->update(25);
+  aggregator->checkpoint();
+
+  auto request = Export({sdk::metrics::Record(
+      "latency", "", "{}", std::shared_ptr<sdk::metrics::Aggregator<double>>(aggregator))});
+
+  auto &metric = GetMetric(request, 0);
+  EXPECT_EQ(metrics_proto::MetricDescriptor::HISTOGRAM, metric.metric_descriptor().type());
+  ASSERT_EQ(1, metric.histogram_data_points_size());
+  auto &point = metric.histogram_data_points(0);
+  EXPECT_EQ(4, point.count());
+  EXPECT_EQ(61, point.sum());
+  ASSERT_EQ(3, point.buckets_size());
+  EXPECT_EQ(1, point.buckets(0).count());
+  EXPECT_EQ(2, point.buckets(1).count());
+  EXPECT_EQ(1, point.buckets(2).count());
+  ASSERT_EQ(2, point.explicit_bounds_size());
+  EXPECT_EQ(20, point.explicit_bounds(1));
+}
+
+// Min-max-sum-count, sketch and exact aggregators become summaries
+TEST_F(OtlpMetricsExporterTestPeer, ExportSummaries)
+{
+  auto mmsc = std::make_shared<sdk::metrics::MinMaxSumCountAggregator<int>>(
+      metrics_api::InstrumentKind::ValueRecorder);
+  auto sketch = std::make_shared<sdk::metrics::SketchAggregator<int>>(
+      metrics_api::InstrumentKind::ValueRecorder, 0.01);
+  auto exact = std::make_shared<sdk::metrics::ExactAggregator<int>>(
+      metrics_api::InstrumentKind::ValueRecorder, true);
+  auto empty_sketch = std::make_shared<sdk::metrics::SketchAggregator<int>>(
+      metrics_api::InstrumentKind::ValueRecorder, 0.01);
+  for (int i = 1; i <= 100; ++i)
+  {
+    mmsc->update(i);
+    sketch->update(i);
+    exact->update(i);
+  }
+  mmsc->checkpoint();
+  sketch->checkpoint();
+  exact->checkpoint();
+  empty_sketch->checkpoint();
+
+  auto request = Export(
+      {sdk::metrics::Record("mmsc", "", "{}", std::shared_ptr<sdk::metrics::Aggregator<int>>(mmsc)),
+       sdk::metrics::Record("sketch", "", "{}",
+                            std::shared_ptr<sdk::metrics::Aggregator<int>>(sketch)),
+       sdk::metrics::Record("exact", "", "{}",
+                            std::shared_ptr<sdk::metrics::Aggregator<int>>(exact)),
+       sdk::metrics::Record("empty", "", "{}",
+                            std::shared_ptr<sdk::metrics::Aggregator<int>>(empty_sketch))});
+
+  for (int i = 0; i < 3; ++i)
+  {
+    auto &metric = GetMetric(request, i);
+    EXPECT_EQ(metrics_proto::MetricDescriptor::SUMMARY, metric.metric_descriptor().type());
+    ASSERT_EQ(1, metric.summary_data_points_size());
+    auto &point = metric.summary_data_points(0);
+    EXPECT_EQ(100, point.count());
+    EXPECT_EQ(5050, point.sum());
+    ASSERT_LE(2, point.percentile_values_size());
+    EXPECT_EQ(0, point.percentile_values(0).percentile());
+    EXPECT_EQ(1, point.percentile_values(0).value());
+    auto &max = point.percentile_values(point.percentile_values_size() - 1);
+    EXPECT_EQ(100, max.percentile());
+    EXPECT_NEAR(100, max.value(), 1);
+  }
+  // Exact and sketch aggregators report the configured quantiles
+  auto &exact_point = GetMetric(request, 2).summary_data_points(0);
+  ASSERT_EQ(5, exact_point.percentile_values_size());
+  EXPECT_EQ(50, exact_point.percentile_values(1).percentile());
+  EXPECT_NEAR(50, exact_point.percentile_values(1).value(), 1);
+
+  auto &empty_point = GetMetric(request, 3).summary_data_points(0);
+  EXPECT_EQ(0, empty_point.count());
+  EXPECT_EQ(0, empty_point.percentile_values_size());
+}
+
+// The request is reused, without keeping anything from the previous export
+TEST_F(OtlpMetricsExporterTestPeer, ExportTwice)
+{
+  auto aggregator = std::make_shared<sdk::metrics::CounterAggregator<int>>(
+      metrics_api::InstrumentKind::Counter);
+  aggregator->update(1);
+  aggregator->checkpoint();
+  auto request = Export({sdk::metrics::Record(
+                             "first", "", "{}", std::shared_ptr<sdk::metrics::Aggregator<int>>(
+                                                    aggregator)),
+                         sdk::metrics::Record(
+                             "first", "", "{}", std::shared_ptr<sdk::metrics::Aggregator<int>>(
+                                                    aggregator))});
+  EXPECT_EQ(2, GetMetric(request, 0).int64_data_points_size());
+  auto first_export_time = GetMetric(request, 0).int64_data_points(0).time_unix_nano();
+
+  request = Export({sdk::metrics::Record(
+      "second", "", "{}", std::shared_ptr<sdk::metrics::Aggregator<int>>(aggregator))});
+  ASSERT_EQ(1, request.resource_metrics(0).instrumentation_library_metrics(0).metrics_size());
+  auto &metric = GetMetric(request, 0);
+  EXPECT_EQ("second", metric.metric_descriptor().name());
+  ASSERT_EQ(1, metric.int64_data_points_size());
+  EXPECT_EQ(first_export_time, metric.int64_data_points(0).start_time_unix_nano());
+}
+
+/**
+ * An in-process collector serving both the trace and the metrics service, recording the peer
+ * of every request.
+ */
+class FakeCollector
+{
+public:
+  FakeCollector()
+  {
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &port_);
+    builder.RegisterService(&trace_service_);
+    builder.RegisterService(&metrics_service_);
+    server_ = builder.BuildAndStart();
+  }
+
+  ~FakeCollector() { server_->Shutdown(); }
+
+  std::string endpoint() const { return "127.0.0.1:" + std::to_string(port_); }
+
+  std::vector<std::string> peers()
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    return peers_;
+  }
+
+private:
+  void AddPeer(grpc::ServerContext *context)
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    peers_.push_back(context->peer());
+  }
+
+  class TraceService final : public proto::collector::trace::v1::TraceService::Service
+  {
+  public:
+    explicit TraceService(FakeCollector &collector) : collector_(collector) {}
+
+    grpc::Status Export(grpc::ServerContext *context,
+                        const proto::collector::trace::v1::ExportTraceServiceRequest *,
+                        proto::collector::trace::v1::ExportTraceServiceResponse *) override
+    {
+      collector_.AddPeer(context);
+      return grpc::Status::OK;
+    }
+
+  private:
+    FakeCollector &collector_;
+  };
+
+  class MetricsService final : public proto::collector::metrics::v1::MetricsService::Service
+  {
+  public:
+    explicit MetricsService(FakeCollector &collector) : collector_(collector) {}
+
+    grpc::Status Export(grpc::ServerContext *context,
+                        const proto::collector::metrics::v1::ExportMetricsServiceRequest *,
+                        proto::collector::metrics::v1::ExportMetricsServiceResponse *) override
+    {
+      collector_.AddPeer(context);
+      return grpc::Status::OK;
+    }
+
+  private:
+    FakeCollector &collector_;
+  };
+
+  int port_ = 0;
+  TraceService trace_service_{*this};
+  MetricsService metrics_service_{*this};
+  std::unique_ptr<grpc::Server> server_;
+
+  std::mutex mu_;
+  std::vector<std::string> peers_;
+};
+
+// Spans and metrics exported over a shared channel go out on the same connection
+TEST(OtlpMetricsExporter, SharedChannel)
+{
+  FakeCollector collector;
+  OtlpExporterOptions options;
+  options.endpoint = collector.endpoint();
+  auto channel     = CreateOtlpChannel(options);
+
+  OtlpExporter span_exporter(channel, options);
+  OtlpMetricsExporter metrics_exporter(channel);
+
+  auto recordable = span_exporter.MakeRecordable();
+  nostd::span<std::unique_ptr<sdk::trace::Recordable>> batch(&recordable, 1);
+  EXPECT_EQ(sdk::trace::ExportResult::kSuccess, span_exporter.Export(batch));
+
+  auto aggregator = std::make_shared<sdk::metrics::CounterAggregator<int>>(
+      metrics_api::InstrumentKind::Counter);
+  aggregator->checkpoint();
+  EXPECT_EQ(sdk::metrics::ExportResult::kSuccess,
+            metrics_exporter.Export({sdk::metrics::Record(
+                "counter", "", "{}", std::shared_ptr<sdk::metrics::Aggregator<int>>(aggregator))}));
+
+  auto peers = collector.peers();
+  ASSERT_EQ(2, peers.size());
+  EXPECT_EQ(peers[0], peers[1]);
+}
+}  // namespace otlp
+}  // namespace exporter
+OPENTELEMETRY_END_NAMESPACE
@@ -188,6 +188,27 @@ TEST(Recordable, SetArrayAtrribute)
   }
 }
 
+// A recordable built in an arena keeps the arena alive
+TEST(Recordable, ArenaSpan)
+{
+  std::weak_ptr<google::protobuf::Arena> weak_arena;
+  std::unique_ptr<Recordable> rec;
+  {
+    auto arena = std::make_shared<google::protobuf::Arena>();
+    weak_arena = arena;
+    rec.reset(new Recordable(arena));
+  }
+  rec->SetName("Test Span");
+  rec->SetAttribute("str_attr", "string value that doesn't fit into a small string");
+  EXPECT_FALSE(weak_arena.expired());
+  EXPECT_EQ(rec->span().name(), "Test Span");
+  EXPECT_EQ(rec->span().attributes(0).value().string_value(),
+            "string value that doesn't fit into a small string");
+
+  rec.reset();
+  EXPECT_TRUE(weak_arena.expired());
+}
+
 /**
  * AttributeValue can contain different int types, such as int, int64_t,
  * unsigned int, and uint64_t. To avoid writing test cases for each, we can
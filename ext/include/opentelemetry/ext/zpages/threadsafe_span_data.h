@@ -2,7 +2,6 @@
 
 #include <chrono>
 #include <mutex>
-#include <unordered_map>
 #include <vector>
 
 #include "opentelemetry/core/timestamp.h"
@@ -14,7 +13,8 @@
 #include "opentelemetry/trace/span_id.h"
 #include "opentelemetry/trace/trace_id.h"
 
-using opentelemetry::sdk::trace::AttributeConverter;
+using opentelemetry::sdk::trace::AttributeMap;
+using opentelemetry::sdk::trace::FlatAttributeMap;
 using opentelemetry::sdk::trace::SpanDataAttributeValue;
 using opentelemetry::sdk::trace::SpanDataEvent;
 namespace trace_api = opentelemetry::trace;
@@ -68,7 +68,7 @@ class ThreadsafeSpanData final : public opentelemetry::sdk::trace::Recordable
   opentelemetry::nostd::string_view GetName() const noexcept
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    return name_;
+    return name_.view();
   }
 
   /**
@@ -115,10 +115,10 @@ class ThreadsafeSpanData final : public opentelemetry::sdk::trace::Recordable
    * Get the attributes for this span
    * @return the attributes for this span
    */
-  const std::unordered_map<std::string, SpanDataAttributeValue> GetAttributes() const noexcept
+  const FlatAttributeMap GetAttributes() const noexcept
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    return attributes_;
+    return attribute_map_.GetAttributes();
   }
 
   void SetIds(opentelemetry::trace::TraceId trace_id,
@@ -134,7 +134,7 @@ class ThreadsafeSpanData final : public opentelemetry::sdk::trace::Recordable
   void SetAttribute(nostd::string_view key, const common::AttributeValue &value) noexcept override
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    attributes_[std::string(key)] = nostd::visit(converter_, value);
+    attribute_map_.SetAttribute(key, value);
   }
 
   void SetStatus(trace_api::CanonicalCode code, nostd::string_view description) noexcept override
@@ -147,7 +147,7 @@ class ThreadsafeSpanData final : public opentelemetry::sdk::trace::Recordable
   void SetName(nostd::string_view name) noexcept override
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    name_ = std::string(name);
+    name_.Assign(name);
   }
 
   void SetStartTime(opentelemetry::core::SystemTimestamp start_time) noexcept override
@@ -179,7 +179,7 @@ class ThreadsafeSpanData final : public opentelemetry::sdk::trace::Recordable
           trace_api::KeyValueIterableView<std::map<std::string, int>>({})) noexcept override
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    events_.push_back(SpanDataEvent(std::string(name), timestamp, attributes));
+    events_.push_back(SpanDataEvent(name, timestamp, attributes));
   }
 
   ThreadsafeSpanData() {}
@@ -199,9 +199,8 @@ class ThreadsafeSpanData final : public opentelemetry::sdk::trace::Recordable
         name_(threadsafe_span_data.name_),
         status_code_(threadsafe_span_data.status_code_),
         status_desc_(threadsafe_span_data.status_desc_),
-        attributes_(threadsafe_span_data.attributes_),
-        events_(threadsafe_span_data.events_),
-        converter_(threadsafe_span_data.converter_)
+        attribute_map_(threadsafe_span_data.attribute_map_),
+        events_(threadsafe_span_data.events_)
   {}
 
   mutable std::mutex mutex_;
@@ -210,12 +209,11 @@ class ThreadsafeSpanData final : public opentelemetry::sdk::trace::Recordable
   opentelemetry::trace::SpanId parent_span_id_;
   core::SystemTimestamp start_time_;
   std::chrono::nanoseconds duration_{0};
-  std::string name_;
+  opentelemetry::sdk::common::InternedString name_;
   opentelemetry::trace::CanonicalCode status_code_{opentelemetry::trace::CanonicalCode::OK};
   std::string status_desc_;
-  std::unordered_map<std::string, SpanDataAttributeValue> attributes_;
+  AttributeMap attribute_map_;
   std::vector<SpanDataEvent> events_;
-  AttributeConverter converter_;
 };
 }  // namespace zpages
 }  // namespace ext
@@ -110,7 +110,7 @@ json TracezHttpServer::GetAttributesJSON(
   auto attributes_json = json::object();
   for (const auto &sample_attribute : sample.GetAttributes())
   {
-    auto &key = sample_attribute.first;
+    auto key = std::string(sample_attribute.first.data(), sample_attribute.first.size());
     auto &val = sample_attribute.second;  // SpanDataAttributeValue
 
     /* Convert variant types to into their nonvariant form. This is done this way because
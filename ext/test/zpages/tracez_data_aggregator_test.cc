@@ -1,6 +1,7 @@
 #include "opentelemetry/ext/zpages/tracez_data_aggregator.h"
 
 #include <gtest/gtest.h>
+#include <unordered_map>
 
 #include "opentelemetry/context/threadlocal_context.h"
 #include "opentelemetry/ext/zpages/tracez_processor.h"
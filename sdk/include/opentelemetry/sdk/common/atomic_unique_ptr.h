@@ -55,6 +55,28 @@ class AtomicUniquePtr
     return false;
   }
 
+  /**
+   * Atomically swap the pointer only if it's not null.
+   * @param owner the pointer to swap with; on success, it's set to the
+   * previous pointer
+   * @return true if the swap was successful
+   */
+  bool SwapIfNotNull(std::unique_ptr<T> &owner) noexcept
+  {
+    T *expected = ptr_.load(std::memory_order_relaxed);
+    while (expected != nullptr)
+    {
+      if (ptr_.compare_exchange_weak(expected, owner.get(), std::memory_order_acq_rel,
+                                     std::memory_order_relaxed))
+      {
+        owner.release();
+        owner.reset(expected);
+        return true;
+      }
+    }
+    return false;
+  }
+
   /**
    * Atomically swap the pointer with another.
    * @param ptr the pointer to swap with
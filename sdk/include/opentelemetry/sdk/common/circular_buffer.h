@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <memory>
 
+#include "opentelemetry/nostd/span.h"
 #include "opentelemetry/sdk/common/atomic_unique_ptr.h"
 #include "opentelemetry/sdk/common/circular_buffer_range.h"
 #include "opentelemetry/version.h"
@@ -16,14 +17,26 @@ namespace common
 /*
  * A lock-free circular buffer that supports multiple concurrent producers
  * and a single consumer.
+ *
+ * The number of slots is rounded up to a power of two so that positions map
+ * to slots with a mask, and the head and tail each sit on their own cache
+ * line so that the consumer advancing the tail doesn't invalidate the line
+ * producers contend on.
  */
 template <class T>
 class CircularBuffer
 {
 public:
-  explicit CircularBuffer(size_t max_size)
-      : data_{new AtomicUniquePtr<T>[max_size + 1]}, capacity_{max_size + 1}
-  {}
+  explicit CircularBuffer(size_t max_size) : max_size_{max_size}
+  {
+    size_t capacity = 1;
+    while (capacity < max_size)
+    {
+      capacity *= 2;
+    }
+    data_.reset(new AtomicUniquePtr<T>[capacity]);
+    mask_ = capacity - 1;
+  }
 
   /**
    * @return a range of the elements in the circular buffer
@@ -85,12 +98,12 @@ class CircularBuffer
       uint64_t head = head_;
 
       // The circular buffer is full, so return false.
-      if (head - tail >= capacity_ - 1)
+      if (head - tail >= max_size_)
       {
         return false;
       }
 
-      uint64_t head_index = head % capacity_;
+      uint64_t head_index = head & mask_;
       if (data_[head_index].SwapIfNull(ptr))
       {
         auto new_head      = head + 1;
@@ -113,6 +126,100 @@ class CircularBuffer
     return true;
   }
 
+  /**
+   * Adds several elements into the circular buffer, claiming their slots with a
+   * single update of the head. If not all of them fit, as many as fit are
+   * added, in order.
+   * @param ptrs pointers to the elements to add; the pointers to the added
+   * elements are reset
+   * @return the number of elements added
+   */
+  size_t AddBatch(const nostd::span<std::unique_ptr<T>> &ptrs) noexcept
+  {
+    while (true)
+    {
+      uint64_t tail = tail_;
+      uint64_t head = head_;
+
+      // The circular buffer is full, so add nothing. Reading the tail first
+      // means the head may have moved more than max_size_ past it.
+      if (head - tail >= max_size_)
+      {
+        return 0;
+      }
+
+      size_t n = max_size_ - static_cast<size_t>(head - tail);
+      if (n > ptrs.size())
+      {
+        n = ptrs.size();
+      }
+      if (n == 0)
+      {
+        return 0;
+      }
+
+      // Fill the slots past the head; they only become visible to the
+      // consumer once the head moves past them.
+      size_t num_swapped = 0;
+      while (num_swapped < n && data_[(head + num_swapped) & mask_].SwapIfNull(ptrs[num_swapped]))
+      {
+        ++num_swapped;
+      }
+
+      if (num_swapped == n)
+      {
+        auto expected_head = head;
+        if (head_.compare_exchange_weak(expected_head, head + n, std::memory_order_release,
+                                        std::memory_order_relaxed))
+        {
+          return n;
+        }
+      }
+
+      // Another producer got to one of the slots first, or elements were
+      // added and consumed since the head was read, so undo the swaps and
+      // attempt to add again.
+      for (size_t i = 0; i < num_swapped; ++i)
+      {
+        data_[(head + i) & mask_].Swap(ptrs[i]);
+      }
+    }
+  }
+
+  /**
+   * Replaces the oldest element in the circular buffer with another, for
+   * making room in a full buffer. The new element takes the old one's place,
+   * so it's consumed before elements added earlier; replacements made while
+   * the buffer stays full are consumed in the order they were made.
+   * @param ptr a pointer to the element to add; on success, it's set to the
+   * replaced element
+   * @return true if an element was replaced; false if there was no element to
+   * replace, e.g. because the consumer just took it.
+   */
+  bool ReplaceOldest(std::unique_ptr<T> &ptr) noexcept
+  {
+    // The replace cursor moves past each replaced slot, so that the next
+    // replacement evicts the next oldest element rather than the one just
+    // added. It starts over from the tail once it leaves [tail, head).
+    uint64_t cursor = replace_cursor_.load(std::memory_order_relaxed);
+    uint64_t index;
+    do
+    {
+      uint64_t tail = tail_;
+      uint64_t head = head_;
+      if (head == tail)
+      {
+        return false;
+      }
+      index = cursor < tail || cursor >= head ? tail : cursor;
+    } while (!replace_cursor_.compare_exchange_weak(cursor, index + 1, std::memory_order_relaxed));
+
+    // Only a populated slot is replaced, so the slots in [tail, head) stay
+    // populated. If the consumer took the element meanwhile, the slot is
+    // either null or holds a newer element, which is replaced instead.
+    return data_[index & mask_].SwapIfNotNull(ptr);
+  }
+
   /**
    * Clear the circular buffer.
    *
@@ -123,7 +230,7 @@ class CircularBuffer
   /**
    * @return the maximum number of bytes that can be stored in the buffer.
    */
-  size_t max_size() const noexcept { return capacity_ - 1; }
+  size_t max_size() const noexcept { return max_size_; }
 
   /**
    * @return true if the buffer is empty.
@@ -155,27 +262,39 @@ class CircularBuffer
   uint64_t production_count() const noexcept { return head_; }
 
 private:
+  static const size_t kCacheLineSize = 64;
+
+  // Read-only after construction, so kept apart from the head and tail.
   std::unique_ptr<AtomicUniquePtr<T>[]> data_;
-  size_t capacity_;
+  size_t mask_;
+  size_t max_size_;
+  char padding0_[kCacheLineSize];
   std::atomic<uint64_t> head_{0};
+  char padding1_[kCacheLineSize - sizeof(std::atomic<uint64_t>)];
   std::atomic<uint64_t> tail_{0};
+  char padding2_[kCacheLineSize - sizeof(std::atomic<uint64_t>)];
+  // Only written by producers once the buffer is full.
+  std::atomic<uint64_t> replace_cursor_{0};
 
   CircularBufferRange<AtomicUniquePtr<T>> PeekImpl() noexcept
   {
-    uint64_t tail_index = tail_ % capacity_;
-    uint64_t head_index = head_ % capacity_;
-    if (head_index == tail_index)
+    uint64_t tail = tail_;
+    uint64_t head = head_;
+    if (head == tail)
     {
       return {};
     }
-    auto data = data_.get();
-    if (tail_index < head_index)
+    const size_t capacity   = mask_ + 1;
+    const size_t tail_index = static_cast<size_t>(tail & mask_);
+    const size_t count      = static_cast<size_t>(head - tail);
+    auto data               = data_.get();
+    if (tail_index + count <= capacity)
     {
       return CircularBufferRange<AtomicUniquePtr<T>>{
-          nostd::span<AtomicUniquePtr<T>>{data + tail_index, head_index - tail_index}};
+          nostd::span<AtomicUniquePtr<T>>{data + tail_index, count}};
     }
-    return {nostd::span<AtomicUniquePtr<T>>{data + tail_index, capacity_ - tail_index},
-            nostd::span<AtomicUniquePtr<T>>{data, head_index}};
+    return {nostd::span<AtomicUniquePtr<T>>{data + tail_index, capacity - tail_index},
+            nostd::span<AtomicUniquePtr<T>>{data, tail_index + count - capacity}};
   }
 };
 }  // namespace common
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "opentelemetry/sdk/common/atomic_unique_ptr.h"
+#include "opentelemetry/version.h"
+
+OPENTELEMETRY_BEGIN_NAMESPACE
+namespace sdk
+{
+namespace common
+{
+/*
+ * A lock-free, bounded pool of reusable objects that supports multiple
+ * concurrent threads taking and returning objects.
+ *
+ * Objects are kept in a fixed array of slots. Taking or returning an object is
+ * a single atomic exchange on a slot; two cursors remember where the last
+ * object was taken or returned so that the next call usually finds a suitable
+ * slot on its first probe.
+ */
+template <class T>
+class ObjectPool
+{
+public:
+  explicit ObjectPool(size_t max_size)
+      : data_{new AtomicUniquePtr<T>[max_size]}, max_size_{max_size}
+  {}
+
+  /**
+   * Take an object out of the pool.
+   * @return an object previously returned to the pool, or nullptr if the pool
+   * is empty.
+   */
+  std::unique_ptr<T> Get() noexcept
+  {
+    if (size_.load(std::memory_order_relaxed) == 0)
+    {
+      return nullptr;
+    }
+    size_t start = get_index_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < max_size_; ++i)
+    {
+      size_t index = (start + i) % max_size_;
+      if (data_[index].IsNull())
+      {
+        continue;
+      }
+      std::unique_ptr<T> result;
+      data_[index].Swap(result);
+      if (result != nullptr)
+      {
+        get_index_.store(index + 1, std::memory_order_relaxed);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return result;
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * Return an object to the pool.
+   * @param ptr the object to return
+   * @return true if the object was added to the pool; false if the pool is
+   * full, in which case ptr is left untouched.
+   */
+  bool Put(std::unique_ptr<T> &ptr) noexcept
+  {
+    // Count the object before it becomes visible so that size_ never
+    // undercounts the objects in the pool.
+    if (size_.fetch_add(1, std::memory_order_relaxed) >= max_size_)
+    {
+      size_.fetch_sub(1, std::memory_order_relaxed);
+      return false;
+    }
+    size_t start = put_index_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < max_size_; ++i)
+    {
+      size_t index = (start + i) % max_size_;
+      if (data_[index].IsNull() && data_[index].SwapIfNull(ptr))
+      {
+        put_index_.store(index + 1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  /**
+   * @return the maximum number of objects the pool can hold.
+   */
+  size_t max_size() const noexcept { return max_size_; }
+
+  /**
+   * @return an approximation of the number of objects in the pool.
+   */
+  size_t size() const noexcept { return size_.load(std::memory_order_relaxed); }
+
+private:
+  std::unique_ptr<AtomicUniquePtr<T>[]> data_;
+  size_t max_size_;
+  std::atomic<size_t> size_{0};
+  std::atomic<size_t> get_index_{0};
+  std::atomic<size_t> put_index_{0};
+};
+}  // namespace common
+}  // namespace sdk
+OPENTELEMETRY_END_NAMESPACE
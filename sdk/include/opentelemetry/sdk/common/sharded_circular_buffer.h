@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "opentelemetry/sdk/common/circular_buffer.h"
+#include "opentelemetry/sdk/common/thread_index.h"
+#include "opentelemetry/version.h"
+
+OPENTELEMETRY_BEGIN_NAMESPACE
+namespace sdk
+{
+namespace common
+{
+/*
+ * A lock-free buffer that spreads multiple concurrent producers over several
+ * CircularBuffer shards and supports a single consumer.
+ *
+ * Each producer thread is pinned to one shard, so producers on different
+ * shards never contend on the same head index. The consumer drains the shards
+ * round-robin.
+ */
+template <class T>
+class ShardedCircularBuffer
+{
+public:
+  /**
+   * @param max_size the maximum number of elements stored across all shards
+   * @param num_shards the number of shards; a value of 0 is treated as 1
+   */
+  ShardedCircularBuffer(size_t max_size, size_t num_shards)
+  {
+    if (num_shards == 0)
+    {
+      num_shards = 1;
+    }
+    const size_t shard_size = (max_size + num_shards - 1) / num_shards;
+    shards_.reserve(num_shards);
+    for (size_t i = 0; i < num_shards; ++i)
+    {
+      shards_.emplace_back(new CircularBuffer<T>{shard_size});
+    }
+  }
+
+  /**
+   * @return the shard that the calling producer thread adds elements to.
+   */
+  CircularBuffer<T> &GetShard() noexcept
+  {
+    if (shards_.size() == 1)
+    {
+      return *shards_[0];
+    }
+    return *shards_[GetThreadIndex() % shards_.size()];
+  }
+
+  /**
+   * @return the i-th shard of the buffer.
+   */
+  CircularBuffer<T> &GetShard(size_t i) noexcept { return *shards_[i]; }
+
+  /**
+   * Adds an element into the calling thread's shard.
+   * @param ptr a pointer to the element to add
+   * @return true if the element was successfully added; false, otherwise.
+   */
+  bool Add(std::unique_ptr<T> &ptr) noexcept { return GetShard().Add(ptr); }
+
+  /**
+   * Adds several elements into the calling thread's shard.
+   * @param ptrs pointers to the elements to add
+   * @return the number of elements added
+   */
+  size_t AddBatch(const nostd::span<std::unique_ptr<T>> &ptrs) noexcept
+  {
+    return GetShard().AddBatch(ptrs);
+  }
+
+  /**
+   * Consume up to n elements, taking them from the shards in round-robin
+   * order. The callback may be invoked several times, once for each
+   * contiguous range taken from a shard.
+   * @param n the maximum number of elements to consume
+   * @param callback the callback to invoke with each consumed range
+   * @return the number of elements consumed
+   *
+   * Note: The callback must set each passed AtomicUniquePtr to null.
+   *
+   * Note: This method must only be called from the consumer thread.
+   */
+  template <class Callback>
+  size_t Consume(size_t n, Callback callback) noexcept
+  {
+    const size_t num_shards = shards_.size();
+    size_t consumed         = 0;
+    while (consumed < n)
+    {
+      // Give every shard an equal share of what is left so that a busy
+      // producer can't starve the others within a single batch.
+      size_t share = (n - consumed) / num_shards;
+      if (share == 0)
+      {
+        share = 1;
+      }
+      size_t consumed_this_pass = 0;
+      for (size_t i = 0; i < num_shards && consumed < n; ++i)
+      {
+        auto &shard = *shards_[next_shard_];
+        next_shard_ = (next_shard_ + 1) % num_shards;
+
+        size_t count = shard.size();
+        if (count > share)
+        {
+          count = share;
+        }
+        if (count > n - consumed)
+        {
+          count = n - consumed;
+        }
+        if (count == 0)
+        {
+          continue;
+        }
+        shard.Consume(count, callback);
+        consumed += count;
+        consumed_this_pass += count;
+      }
+      if (consumed_this_pass == 0)
+      {
+        break;
+      }
+    }
+    return consumed;
+  }
+
+  /**
+   * Consume up to n elements, deleting them.
+   * @param n the maximum number of elements to consume
+   *
+   * Note: This method must only be called from the consumer thread.
+   */
+  void Consume(size_t n) noexcept
+  {
+    Consume(
+        n, [](CircularBufferRange<AtomicUniquePtr<T>> & range) noexcept {
+          range.ForEach([](AtomicUniquePtr<T> & ptr) noexcept {
+            ptr.Reset();
+            return true;
+          });
+        });
+  }
+
+  /**
+   * Clear all the shards.
+   *
+   * Note: This method must only be called from the consumer thread.
+   */
+  void Clear() noexcept
+  {
+    for (auto &shard : shards_)
+    {
+      shard->Clear();
+    }
+  }
+
+  /**
+   * @return the number of shards.
+   */
+  size_t num_shards() const noexcept { return shards_.size(); }
+
+  /**
+   * @return the maximum number of elements that can be stored across all shards.
+   */
+  size_t max_size() const noexcept { return shards_.size() * shards_[0]->max_size(); }
+
+  /**
+   * @return true if every shard is empty.
+   */
+  bool empty() const noexcept
+  {
+    for (auto &shard : shards_)
+    {
+      if (!shard->empty())
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @return the number of elements added across all shards.
+   */
+  uint64_t production_count() const noexcept
+  {
+    uint64_t result = 0;
+    for (auto &shard : shards_)
+    {
+      result += shard->production_count();
+    }
+    return result;
+  }
+
+  /**
+   * @return the number of elements stored across all shards.
+   *
+   * Note: this method will only return a correct snapshot of the size if called
+   * from the consumer thread.
+   */
+  size_t size() const noexcept
+  {
+    size_t result = 0;
+    for (auto &shard : shards_)
+    {
+      result += shard->size();
+    }
+    return result;
+  }
+
+private:
+  std::vector<std::unique_ptr<CircularBuffer<T>>> shards_;
+  size_t next_shard_{0};
+};
+}  // namespace common
+}  // namespace sdk
+OPENTELEMETRY_END_NAMESPACE
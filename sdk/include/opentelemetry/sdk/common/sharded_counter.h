@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "opentelemetry/sdk/common/thread_index.h"
+#include "opentelemetry/version.h"
+
+OPENTELEMETRY_BEGIN_NAMESPACE
+namespace sdk
+{
+namespace common
+{
+/*
+ * A counter that multiple concurrent threads can add to without contending.
+ *
+ * Each thread adds to one of several cells, each on its own cache line, so an
+ * addition is a relaxed increment of a cache line the thread usually owns
+ * already. Reading the value sums the cells, which is slower and gives a
+ * snapshot that may miss concurrent additions.
+ */
+class ShardedCounter
+{
+public:
+  static const size_t kNumCells = 16;
+
+  /**
+   * Add to the counter.
+   * @param n the amount to add
+   */
+  void Add(uint64_t n = 1) noexcept
+  {
+    cells_[GetThreadIndex() % kNumCells].value.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  /**
+   * @return the sum of all the additions.
+   */
+  uint64_t Value() const noexcept
+  {
+    uint64_t result = 0;
+    for (auto &cell : cells_)
+    {
+      result += cell.value.load(std::memory_order_relaxed);
+    }
+    return result;
+  }
+
+private:
+  static const size_t kCacheLineSize = 64;
+
+  struct Cell
+  {
+    std::atomic<uint64_t> value{0};
+    char padding[kCacheLineSize - sizeof(std::atomic<uint64_t>)];
+  };
+
+  Cell cells_[kNumCells];
+};
+}  // namespace common
+}  // namespace sdk
+OPENTELEMETRY_END_NAMESPACE
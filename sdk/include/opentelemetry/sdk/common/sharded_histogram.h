@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "opentelemetry/sdk/common/thread_index.h"
+#include "opentelemetry/version.h"
+
+OPENTELEMETRY_BEGIN_NAMESPACE
+namespace sdk
+{
+namespace common
+{
+/**
+ * The counts of a histogram with power-of-two buckets: bucket 0 counts the
+ * value 0, and bucket i > 0 counts the values in [2^(i-1), 2^i). The last
+ * bucket also counts every larger value.
+ */
+struct HistogramSnapshot
+{
+  static const size_t kNumBuckets = 32;
+
+  std::array<uint64_t, kNumBuckets> counts{};
+
+  /**
+   * @return the smallest value counted in bucket i.
+   */
+  static uint64_t BucketLowerBound(size_t i) noexcept
+  {
+    return i == 0 ? 0 : uint64_t{1} << (i - 1);
+  }
+
+  /**
+   * @return the number of values counted in all buckets.
+   */
+  uint64_t TotalCount() const noexcept
+  {
+    uint64_t result = 0;
+    for (auto count : counts)
+    {
+      result += count;
+    }
+    return result;
+  }
+};
+
+/*
+ * A histogram with power-of-two buckets that multiple concurrent threads can
+ * record values into without contending.
+ *
+ * Like ShardedCounter, each thread records into one of several shards, each
+ * on its own cache lines, and taking a snapshot sums the shards.
+ */
+class ShardedHistogram
+{
+public:
+  static const size_t kNumShards  = 16;
+  static const size_t kNumBuckets = HistogramSnapshot::kNumBuckets;
+
+  /**
+   * Record a value.
+   * @param value the value to record
+   */
+  void Record(uint64_t value) noexcept
+  {
+    shards_[GetThreadIndex() % kNumShards].counts[BucketIndex(value)].fetch_add(
+        1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @return the number of values recorded into each bucket so far.
+   */
+  HistogramSnapshot GetSnapshot() const noexcept
+  {
+    HistogramSnapshot snapshot;
+    for (auto &shard : shards_)
+    {
+      for (size_t i = 0; i < kNumBuckets; ++i)
+      {
+        snapshot.counts[i] += shard.counts[i].load(std::memory_order_relaxed);
+      }
+    }
+    return snapshot;
+  }
+
+  /**
+   * @return the bucket a value is counted in.
+   */
+  static size_t BucketIndex(uint64_t value) noexcept
+  {
+    size_t index = 0;
+    while (value != 0 && index < kNumBuckets - 1)
+    {
+      value >>= 1;
+      ++index;
+    }
+    return index;
+  }
+
+private:
+  static const size_t kCacheLineSize = 64;
+
+  struct Shard
+  {
+    std::atomic<uint64_t> counts[kNumBuckets] = {};
+    char padding[kCacheLineSize];
+  };
+
+  Shard shards_[kNumShards];
+};
+}  // namespace common
+}  // namespace sdk
+OPENTELEMETRY_END_NAMESPACE
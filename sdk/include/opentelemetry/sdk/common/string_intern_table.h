@@ -0,0 +1,313 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "opentelemetry/nostd/string_view.h"
+#include "opentelemetry/version.h"
+
+OPENTELEMETRY_BEGIN_NAMESPACE
+namespace sdk
+{
+namespace common
+{
+/*
+ * A lock-free, bounded table of interned strings that supports multiple
+ * concurrent threads.
+ *
+ * Interning a string returns a pointer to a single shared copy of it that
+ * stays valid for the lifetime of the table, so that repeated strings such as
+ * attribute keys and span names are only stored once and can be compared by
+ * pointer. Strings are never removed; once max_size strings are interned,
+ * interning a new string fails and callers have to keep their own copy. The
+ * limit is checked before inserting, so threads that race to insert different
+ * strings may overshoot it by a few; the table has room for twice as many.
+ */
+class StringInternTable
+{
+public:
+  /**
+   * @param max_size the number of strings after which interning new strings fails
+   */
+  explicit StringInternTable(size_t max_size) : max_size_{max_size}
+  {
+    size_t num_slots = 1;
+    while (num_slots < max_size * 2)
+    {
+      num_slots *= 2;
+    }
+    slots_.reset(new std::atomic<const std::string *>[num_slots]);
+    for (size_t i = 0; i < num_slots; ++i)
+    {
+      slots_[i].store(nullptr, std::memory_order_relaxed);
+    }
+    mask_ = num_slots - 1;
+  }
+
+  ~StringInternTable()
+  {
+    for (size_t i = 0; i <= mask_; ++i)
+    {
+      delete slots_[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  StringInternTable(const StringInternTable &) = delete;
+  StringInternTable &operator=(const StringInternTable &) = delete;
+
+  /**
+   * Intern a string.
+   * @param str the string to intern
+   * @return a pointer to the interned copy of str, or nullptr if str isn't
+   * interned yet and the table is full.
+   */
+  const std::string *Intern(nostd::string_view str) { return Intern(str, Hash(str)); }
+
+  /**
+   * Intern a string whose hash is already known.
+   * @param str the string to intern
+   * @param hash Hash(str)
+   * @return a pointer to the interned copy of str, or nullptr if str isn't
+   * interned yet and the table is full.
+   */
+  const std::string *Intern(nostd::string_view str, uint64_t hash)
+  {
+    std::unique_ptr<std::string> candidate;
+    size_t slot = hash & mask_;
+    for (size_t num_probes = 0; num_probes <= mask_; ++num_probes, slot = (slot + 1) & mask_)
+    {
+      const std::string *interned = slots_[slot].load(std::memory_order_acquire);
+      while (interned == nullptr)
+      {
+        if (candidate == nullptr)
+        {
+          if (size_.load(std::memory_order_acquire) >= max_size_)
+          {
+            // Another thread may have interned str since this slot was read
+            return Find(str, hash);
+          }
+          candidate.reset(new std::string{str.data(), str.size()});
+        }
+        if (slots_[slot].compare_exchange_strong(interned, candidate.get(),
+                                                 std::memory_order_acq_rel))
+        {
+          size_.fetch_add(1, std::memory_order_release);
+          return candidate.release();
+        }
+      }
+      if (*interned == str)
+      {
+        return interned;
+      }
+    }
+    // Every slot is taken, which the size limit normally prevents
+    return nullptr;
+  }
+
+  /**
+   * Look up a string without interning it.
+   * @param str the string to look up
+   * @return a pointer to the interned copy of str, or nullptr if str isn't
+   * interned.
+   */
+  const std::string *Find(nostd::string_view str) const noexcept { return Find(str, Hash(str)); }
+
+  /**
+   * Look up a string whose hash is already known, without interning it.
+   * @param str the string to look up
+   * @param hash Hash(str)
+   * @return a pointer to the interned copy of str, or nullptr if str isn't
+   * interned.
+   */
+  const std::string *Find(nostd::string_view str, uint64_t hash) const noexcept
+  {
+    size_t slot = hash & mask_;
+    for (size_t num_probes = 0; num_probes <= mask_; ++num_probes, slot = (slot + 1) & mask_)
+    {
+      const std::string *interned = slots_[slot].load(std::memory_order_acquire);
+      if (interned == nullptr || *interned == str)
+      {
+        return interned;
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * @return the number of strings after which interning new strings fails.
+   */
+  size_t max_size() const noexcept { return max_size_; }
+
+  /**
+   * @return an approximation of the number of strings interned.
+   */
+  size_t size() const noexcept { return size_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return the process-wide table used for attribute keys and span names.
+   */
+  static StringInternTable &GetGlobal()
+  {
+    // Never destroyed, so that interned strings outlive every static object
+    // that may refer to them.
+    static StringInternTable *table = new StringInternTable{4096};
+    return *table;
+  }
+
+  /**
+   * @return the FNV-1a hash of a string.
+   */
+  static uint64_t Hash(nostd::string_view str) noexcept
+  {
+    uint64_t hash = 14695981039346656037ull;
+    for (auto c : str)
+    {
+      hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    return hash;
+  }
+
+private:
+  std::unique_ptr<std::atomic<const std::string *>[]> slots_;
+  size_t mask_;
+  size_t max_size_;
+  std::atomic<size_t> size_{0};
+};
+
+/**
+ * A handle to a string interned in the global StringInternTable.
+ *
+ * Handles to interned strings are compared by pointer. If the table is full,
+ * the handle keeps its own copy of the string instead. Either way, a handle
+ * is hashed by the string's content, which it computes once, so that an
+ * interned and an owned handle for the same string hash alike.
+ */
+class InternedString
+{
+public:
+  InternedString() noexcept = default;
+
+  explicit InternedString(nostd::string_view str) { Assign(str); }
+
+  /**
+   * Make the handle refer to str, interning it if possible.
+   */
+  void Assign(nostd::string_view str)
+  {
+    hash_     = StringInternTable::Hash(str);
+    interned_ = StringInternTable::GetGlobal().Intern(str, hash_);
+    if (interned_ == nullptr)
+    {
+      owned_.assign(str.data(), str.size());
+    }
+    else
+    {
+      owned_.clear();
+    }
+  }
+
+  /**
+   * Make the handle refer to the empty string.
+   */
+  void clear() noexcept
+  {
+    interned_ = nullptr;
+    owned_.clear();
+    hash_ = StringInternTable::Hash("");
+  }
+
+  /**
+   * @return a handle for str if it's interned already; otherwise, a handle
+   * with its own copy of str. Never adds str to the table.
+   */
+  static InternedString Lookup(nostd::string_view str)
+  {
+    InternedString result;
+    result.hash_     = StringInternTable::Hash(str);
+    result.interned_ = StringInternTable::GetGlobal().Find(str, result.hash_);
+    if (result.interned_ == nullptr)
+    {
+      result.owned_.assign(str.data(), str.size());
+    }
+    return result;
+  }
+
+  /**
+   * @return true if the string is stored in the intern table.
+   */
+  bool is_interned() const noexcept { return interned_ != nullptr; }
+
+  /**
+   * @return the string; it's null-terminated.
+   */
+  nostd::string_view view() const noexcept
+  {
+    return interned_ != nullptr ? nostd::string_view{*interned_} : nostd::string_view{owned_};
+  }
+
+  operator nostd::string_view() const noexcept { return view(); }
+
+  const char *data() const noexcept
+  {
+    return interned_ != nullptr ? interned_->data() : owned_.data();
+  }
+
+  size_t size() const noexcept { return interned_ != nullptr ? interned_->size() : owned_.size(); }
+
+  bool empty() const noexcept { return size() == 0; }
+
+  /**
+   * @return StringInternTable::Hash of the string.
+   */
+  uint64_t hash() const noexcept { return hash_; }
+
+  friend bool operator==(const InternedString &lhs, const InternedString &rhs) noexcept
+  {
+    if (lhs.interned_ != nullptr && rhs.interned_ != nullptr)
+    {
+      return lhs.interned_ == rhs.interned_;
+    }
+    return lhs.hash_ == rhs.hash_ && lhs.view() == rhs.view();
+  }
+
+  friend bool operator!=(const InternedString &lhs, const InternedString &rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+
+  friend bool operator==(const InternedString &lhs, nostd::string_view rhs) noexcept
+  {
+    return lhs.view() == rhs;
+  }
+
+  friend bool operator==(nostd::string_view lhs, const InternedString &rhs) noexcept
+  {
+    return lhs == rhs.view();
+  }
+
+  friend bool operator!=(const InternedString &lhs, nostd::string_view rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+
+  friend bool operator!=(nostd::string_view lhs, const InternedString &rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, const InternedString &str)
+  {
+    return os << str.view();
+  }
+
+private:
+  const std::string *interned_ = nullptr;
+  std::string owned_;
+  uint64_t hash_ = StringInternTable::Hash("");
+};
+}  // namespace common
+}  // namespace sdk
+OPENTELEMETRY_END_NAMESPACE
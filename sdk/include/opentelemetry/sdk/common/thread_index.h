@@ -0,0 +1,25 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "opentelemetry/version.h"
+
+OPENTELEMETRY_BEGIN_NAMESPACE
+namespace sdk
+{
+namespace common
+{
+/**
+ * @return a small per-thread index, handed out in the order threads first ask
+ * for one. Sharded data structures use it to spread threads over their shards.
+ */
+inline size_t GetThreadIndex() noexcept
+{
+  static std::atomic<size_t> next_thread_index{0};
+  static thread_local size_t thread_index = next_thread_index.fetch_add(1);
+  return thread_index;
+}
+}  // namespace common
+}  // namespace sdk
+OPENTELEMETRY_END_NAMESPACE
@@ -48,7 +48,8 @@ class Aggregator
 
   /**
    * Checkpoints the current value.  This function will overwrite the current checkpoint with the
-   * current value.
+   * current value. It must synchronize with the updates it doesn't include, as taking mu_ in both
+   * does, since collection relies on such updates seeing what it wrote before the checkpoint.
    *
    * @param none
    * @return none
@@ -1,8 +1,12 @@
 #pragma once
 
-#include <mutex>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 #include "opentelemetry/metrics/instrument.h"
+#include "opentelemetry/sdk/common/thread_index.h"
 #include "opentelemetry/sdk/metrics/aggregator/aggregator.h"
 #include "opentelemetry/version.h"
 
@@ -14,19 +18,45 @@ namespace sdk
 namespace metrics
 {
 
+/*
+ * Sums the values it receives. The sum and its checkpoint are atomics rather than the vectors of
+ * the base class, so that update and checkpoint never lock: integer sums are added to with
+ * fetch_add, floating point sums with a compare-and-swap loop, and checkpoint swaps the sum for
+ * zero in one exchange. These are acquire-release operations so that checkpoint synchronizes with
+ * the updates it misses, as the base class requires.
+ *
+ * A striped aggregator spreads its sum over cells on separate cache lines, indexed by thread like
+ * common::ShardedCounter, so that threads updating it at once don't contend for one cache line.
+ * Its checkpoint sums and resets the cells. Striping costs about a kilobyte per aggregator, so it
+ * is meant for the few bound instruments that many threads update.
+ */
 template <class T>
 class CounterAggregator final : public Aggregator<T>
 {
 
 public:
-  CounterAggregator(metrics_api::InstrumentKind kind)
+  /**
+   * @param kind the kind of the instrument that owns this aggregator
+   * @param striped whether to spread updates over per-thread cells
+   */
+  CounterAggregator(metrics_api::InstrumentKind kind, bool striped = false)
   {
-    this->kind_       = kind;
-    this->values_     = std::vector<T>(1, 0);
-    this->checkpoint_ = std::vector<T>(1, 0);
-    this->agg_kind_   = AggregatorKind::Counter;
+    this->kind_     = kind;
+    this->agg_kind_ = AggregatorKind::Counter;
+    if (striped)
+    {
+      cells_.reset(new Cell[kNumCells]);
+    }
   }
 
+  // Custom copy constructor to handle the atomics. The copy isn't striped; it holds the sum of the
+  // cells instead.
+  CounterAggregator(const CounterAggregator &cp)
+      : Aggregator<T>(cp),
+        value_(cp.LoadSum()),
+        checkpoint_value_(cp.checkpoint_value_.load(std::memory_order_relaxed))
+  {}
+
   /**
    * Recieves a captured value from the instrument and applies it to the current aggregator value.
    *
@@ -35,9 +65,14 @@ class CounterAggregator final : public Aggregator<T>
    */
   void update(T val) override
   {
-    this->mu_.lock();
-    this->values_[0] += val;  // atomic operation
-    this->mu_.unlock();
+    if (cells_ == nullptr)
+    {
+      Add(value_, val);
+    }
+    else
+    {
+      Add(cells_[common::GetThreadIndex() % kNumCells].value, val);
+    }
   }
 
   /**
@@ -49,10 +84,15 @@ class CounterAggregator final : public Aggregator<T>
    */
   void checkpoint() override
   {
-    this->mu_.lock();
-    this->checkpoint_ = this->values_;
-    this->values_[0]  = 0;
-    this->mu_.unlock();
+    T sum = value_.exchange(0, std::memory_order_acq_rel);
+    if (cells_ != nullptr)
+    {
+      for (size_t i = 0; i < kNumCells; ++i)
+      {
+        sum += cells_[i].value.exchange(0, std::memory_order_acq_rel);
+      }
+    }
+    checkpoint_value_.store(sum, std::memory_order_relaxed);
   }
 
   /**
@@ -66,10 +106,8 @@ class CounterAggregator final : public Aggregator<T>
   {
     if (this->agg_kind_ == other.agg_kind_)
     {
-      this->mu_.lock();
-      this->values_[0] += other.values_[0];
-      this->checkpoint_[0] += other.checkpoint_[0];
-      this->mu_.unlock();
+      Add(value_, other.value_.load(std::memory_order_relaxed));
+      Add(checkpoint_value_, other.checkpoint_value_.load(std::memory_order_relaxed));
     }
     else
     {
@@ -87,7 +125,10 @@ class CounterAggregator final : public Aggregator<T>
    * @param none
    * @return the value of the checkpoint
    */
-  virtual std::vector<T> get_checkpoint() override { return this->checkpoint_; }
+  virtual std::vector<T> get_checkpoint() override
+  {
+    return std::vector<T>(1, checkpoint_value_.load(std::memory_order_relaxed));
+  }
 
   /**
    * Returns the current values
@@ -95,7 +136,63 @@ class CounterAggregator final : public Aggregator<T>
    * @param none
    * @return the present aggregator values
    */
-  virtual std::vector<T> get_values() override { return this->values_; }
+  virtual std::vector<T> get_values() override { return std::vector<T>(1, LoadSum()); }
+
+  // The base class reads values_[0], which this aggregator leaves empty
+  virtual T get_quantiles(double /* q */) override { return LoadSum(); }
+
+  /**
+   * @return whether this aggregator spreads updates over per-thread cells
+   */
+  bool is_striped() const noexcept { return cells_ != nullptr; }
+
+private:
+  static const size_t kNumCells      = 16;
+  static const size_t kCacheLineSize = 64;
+
+  struct Cell
+  {
+    std::atomic<T> value{0};
+    char padding[kCacheLineSize - sizeof(std::atomic<T>)];
+  };
+
+  std::atomic<T> value_{0};
+  std::atomic<T> checkpoint_value_{0};
+
+  // Only allocated if the aggregator is striped; updates then go to the cells instead of value_
+  std::unique_ptr<Cell[]> cells_;
+
+  T LoadSum() const noexcept
+  {
+    T sum = value_.load(std::memory_order_relaxed);
+    if (cells_ != nullptr)
+    {
+      for (size_t i = 0; i < kNumCells; ++i)
+      {
+        sum += cells_[i].value.load(std::memory_order_relaxed);
+      }
+    }
+    return sum;
+  }
+
+  template <class U = T>
+  static typename std::enable_if<std::is_integral<U>::value>::type Add(std::atomic<U> &sum,
+                                                                        U val) noexcept
+  {
+    sum.fetch_add(val, std::memory_order_acq_rel);
+  }
+
+  // std::atomic has no fetch_add for floating point types before C++20
+  template <class U = T>
+  static typename std::enable_if<!std::is_integral<U>::value>::type Add(std::atomic<U> &sum,
+                                                                         U val) noexcept
+  {
+    U expected = sum.load(std::memory_order_relaxed);
+    while (!sum.compare_exchange_weak(expected, expected + val, std::memory_order_acq_rel,
+                                      std::memory_order_relaxed))
+    {
+    }
+  }
 };
 
 }  // namespace metrics
@@ -44,7 +44,7 @@ class ValueObserver : public AsynchronousInstrument<T>, virtual public metrics_a
    * contain the keys and values to be associated with this value.
    *
    * @param value is the numerical representation of the metric being captured
-   * @param labels the set of labels, as key-value pairs
+   * @param labels the set of labels, as key-value pairs; every value must be a string
    */
   virtual void observe(T value, const trace::KeyValueIterable &labels) override
   {
@@ -54,6 +54,7 @@ class ValueObserver : public AsynchronousInstrument<T>, virtual public metrics_a
     {
       auto sp1 = std::shared_ptr<Aggregator<T>>(new MinMaxSumCountAggregator<T>(this->kind_));
       boundAggregators_.insert(std::make_pair(labelset, sp1));
+      labelSets_.emplace(labelset, LabelSet(labels));
       sp1->update(value);
     }
     else
@@ -83,15 +84,21 @@ class ValueObserver : public AsynchronousInstrument<T>, virtual public metrics_a
     for (auto x : boundAggregators_)
     {
       x.second->checkpoint();
-      ret.push_back(Record(this->GetName(), this->GetDescription(), x.first, x.second));
+      ret.push_back(Record(this->GetName(), this->GetDescription(), x.first, labelSets_[x.first],
+                           x.second));
     }
     boundAggregators_.clear();
+    labelSets_.clear();
     this->mu_.unlock();
     return ret;
   }
 
   // Public mapping from labels (stored as strings) to their respective aggregators
   std::unordered_map<std::string, std::shared_ptr<Aggregator<T>>> boundAggregators_;
+
+private:
+  // The labels of each entry in boundAggregators_ as a label set
+  std::unordered_map<std::string, LabelSet> labelSets_;
 };
 
 template <class T>
@@ -119,7 +126,7 @@ class SumObserver : public AsynchronousInstrument<T>, virtual public metrics_api
    * contain the keys and values to be associated with this value.
    *
    * @param value is the numerical representation of the metric being captured
-   * @param labels the set of labels, as key-value pairs
+   * @param labels the set of labels, as key-value pairs; every value must be a string
    */
   virtual void observe(T value, const trace::KeyValueIterable &labels) override
   {
@@ -129,6 +136,7 @@ class SumObserver : public AsynchronousInstrument<T>, virtual public metrics_api
     {
       auto sp1 = std::shared_ptr<Aggregator<T>>(new CounterAggregator<T>(this->kind_));
       boundAggregators_.insert(std::make_pair(labelset, sp1));
+      labelSets_.emplace(labelset, LabelSet(labels));
       if (value < 0)
       {
 #if __EXCEPTIONS
@@ -180,15 +188,21 @@ class SumObserver : public AsynchronousInstrument<T>, virtual public metrics_api
     for (auto x : boundAggregators_)
     {
       x.second->checkpoint();
-      ret.push_back(Record(this->GetName(), this->GetDescription(), x.first, x.second));
+      ret.push_back(Record(this->GetName(), this->GetDescription(), x.first, labelSets_[x.first],
+                           x.second));
     }
     boundAggregators_.clear();
+    labelSets_.clear();
     this->mu_.unlock();
     return ret;
   }
 
   // Public mapping from labels (stored as strings) to their respective aggregators
   std::unordered_map<std::string, std::shared_ptr<Aggregator<T>>> boundAggregators_;
+
+private:
+  // The labels of each entry in boundAggregators_ as a label set
+  std::unordered_map<std::string, LabelSet> labelSets_;
 };
 
 template <class T>
@@ -217,7 +231,7 @@ class UpDownSumObserver : public AsynchronousInstrument<T>,
    * contain the keys and values to be associated with this value.
    *
    * @param value is the numerical representation of the metric being captured
-   * @param labels the set of labels, as key-value pairs
+   * @param labels the set of labels, as key-value pairs; every value must be a string
    */
   virtual void observe(T value, const trace::KeyValueIterable &labels) override
   {
@@ -227,6 +241,7 @@ class UpDownSumObserver : public AsynchronousInstrument<T>,
     {
       auto sp1 = std::shared_ptr<Aggregator<T>>(new CounterAggregator<T>(this->kind_));
       boundAggregators_.insert(std::make_pair(labelset, sp1));
+      labelSets_.emplace(labelset, LabelSet(labels));
       sp1->update(value);
     }
     else
@@ -256,15 +271,21 @@ class UpDownSumObserver : public AsynchronousInstrument<T>,
     for (auto x : boundAggregators_)
     {
       x.second->checkpoint();
-      ret.push_back(Record(this->GetName(), this->GetDescription(), x.first, x.second));
+      ret.push_back(Record(this->GetName(), this->GetDescription(), x.first, labelSets_[x.first],
+                           x.second));
     }
     boundAggregators_.clear();
+    labelSets_.clear();
     this->mu_.unlock();
     return ret;
   }
 
   // Public mapping from labels (stored as strings) to their respective aggregators
   std::unordered_map<std::string, std::shared_ptr<Aggregator<T>>> boundAggregators_;
+
+private:
+  // The labels of each entry in boundAggregators_ as a label set
+  std::unordered_map<std::string, LabelSet> labelSets_;
 };
 
 }  // namespace metrics
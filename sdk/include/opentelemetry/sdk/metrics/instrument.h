@@ -1,14 +1,17 @@
 #pragma once
 
+#include <atomic>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include "opentelemetry/metrics/instrument.h"
 #include "opentelemetry/sdk/metrics/aggregator/aggregator.h"
+#include "opentelemetry/sdk/metrics/label_set.h"
 #include "opentelemetry/sdk/metrics/record.h"
 #include "opentelemetry/version.h"
 
@@ -59,8 +62,63 @@ class Instrument : virtual public metrics_api::Instrument
 };
 
 template <class T>
-class BoundSynchronousInstrument : public Instrument,
-                                   virtual public metrics_api::BoundSynchronousInstrument<T>
+class BoundSynchronousInstrument;
+
+/*
+ * The bound instruments of a synchronous instrument that changed since it was last collected.
+ *
+ * A bound instrument adds itself on its first update, or when its last reference is unbound,
+ * after a collection, so that collecting only visits the label sets that changed. The list is
+ * shared with the bound instruments, which may outlive the instrument that created them; it holds
+ * references to them so that they outlive their turn in it.
+ */
+template <class T>
+class ChangedBoundInstruments
+{
+public:
+  void Add(std::shared_ptr<BoundSynchronousInstrument<T>> bound)
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (!closed_)
+    {
+      bounds_.push_back(std::move(bound));
+    }
+  }
+
+  /**
+   * @return the bound instruments added since the last call, in the order they were added
+   */
+  std::vector<std::shared_ptr<BoundSynchronousInstrument<T>>> Take()
+  {
+    std::vector<std::shared_ptr<BoundSynchronousInstrument<T>>> result;
+    std::lock_guard<std::mutex> lk(mu_);
+    result.swap(bounds_);
+    return result;
+  }
+
+  /**
+   * Drops the bound instruments in the list and ignores those added later, once nothing collects
+   * them any more.
+   */
+  void Close()
+  {
+    std::vector<std::shared_ptr<BoundSynchronousInstrument<T>>> bounds;
+    std::lock_guard<std::mutex> lk(mu_);
+    closed_ = true;
+    bounds.swap(bounds_);
+  }
+
+private:
+  std::mutex mu_;
+  std::vector<std::shared_ptr<BoundSynchronousInstrument<T>>> bounds_;
+  bool closed_ = false;
+};
+
+template <class T>
+class BoundSynchronousInstrument
+    : public Instrument,
+      virtual public metrics_api::BoundSynchronousInstrument<T>,
+      public std::enable_shared_from_this<BoundSynchronousInstrument<T>>
 {
 
 public:
@@ -86,9 +144,10 @@ class BoundSynchronousInstrument : public Instrument,
    */
   virtual void unbind() override
   {
-    this->mu_.lock();
-    ref_ -= 1;
-    this->mu_.unlock();
+    if (ref_.fetch_sub(1, std::memory_order_relaxed) == 1)
+    {
+      MarkChanged();  // so that the next collection can remove it
+    }
   }
 
   /**
@@ -97,12 +156,7 @@ class BoundSynchronousInstrument : public Instrument,
    * @param none
    * @return void
    */
-  virtual void inc_ref() override
-  {
-    this->mu_.lock();
-    ref_ += 1;
-    this->mu_.unlock();
-  }
+  virtual void inc_ref() override { ref_.fetch_add(1, std::memory_order_relaxed); }
 
   /**
    * Returns the current reference count of the instrument.  This value is used to
@@ -111,27 +165,20 @@ class BoundSynchronousInstrument : public Instrument,
    * @param none
    * @return current ref count of the instrument
    */
-  virtual int get_ref() override
-  {
-    this->mu_.lock();
-    auto ret = ref_;
-    this->mu_.unlock();
-    return ret;
-  }
+  virtual int get_ref() override { return ref_.load(std::memory_order_relaxed); }
 
   /**
    * Records a single synchronous metric event via a call to the aggregator.
    * Since this is a bound synchronous instrument, labels are not required in
-   * metric capture calls.
+   * metric capture calls. Aggregators synchronize their own updates, so this doesn't lock.
    *
    * @param value is the numerical representation of the metric being captured
    * @return void
    */
   virtual void update(T value) override
   {
-    this->mu_.lock();
     agg_->update(value);
-    this->mu_.unlock();
+    MarkChanged();
   }
 
   /**
@@ -142,9 +189,48 @@ class BoundSynchronousInstrument : public Instrument,
    */
   virtual std::shared_ptr<Aggregator<T>> GetAggregator() final { return agg_; }
 
+  /**
+   * Makes this instrument add itself to changed whenever it changes after a collection. Called by
+   * the synchronous instrument that creates it, which must own it through a shared pointer.
+   *
+   * @param changed the list of changed bound instruments of the synchronous instrument
+   * @param labels the labels this instrument is bound to
+   */
+  void TrackChanges(std::shared_ptr<ChangedBoundInstruments<T>> changed, const LabelSet &labels)
+  {
+    changed_list_ = std::move(changed);
+    labels_       = labels;
+  }
+
+  // Return the labels this instrument is bound to, if it tracks changes
+  const LabelSet &GetLabels() const noexcept { return labels_; }
+
+  // Return whether this instrument changed since ClearChanged was last called
+  bool IsChanged() const noexcept { return changed_.load(std::memory_order_relaxed); }
+
+  /**
+   * Clears the changed mark, so that the next change adds this instrument to its list again.
+   * Collection calls this before it checkpoints the aggregator. Since the checkpoint synchronizes
+   * with the updates it misses, those updates see the mark cleared and add the instrument again.
+   */
+  void ClearChanged() noexcept { changed_.store(false, std::memory_order_relaxed); }
+
 private:
   std::shared_ptr<Aggregator<T>> agg_;
-  int ref_ = 0;
+  std::atomic<int> ref_{0};
+
+  std::shared_ptr<ChangedBoundInstruments<T>> changed_list_;
+  LabelSet labels_;
+  std::atomic<bool> changed_{false};
+
+  void MarkChanged()
+  {
+    if (changed_list_ != nullptr && !changed_.load(std::memory_order_relaxed) &&
+        !changed_.exchange(true, std::memory_order_relaxed))
+    {
+      changed_list_->Add(this->shared_from_this());
+    }
+  }
 };
 
 template <class T>
@@ -163,6 +249,9 @@ class SynchronousInstrument : public Instrument,
       : Instrument(name, description, unit, enabled, kind)
   {}
 
+  // Bound instruments that outlive this instrument stop tracking their changes
+  ~SynchronousInstrument() { changed_->Close(); }
+
   /**
    * Returns a Bound Instrument associated with the specified labels. Multiples requests
    * with the same set of labels may return the same Bound Instrument instance.
@@ -191,6 +280,62 @@ class SynchronousInstrument : public Instrument,
    * @return vector of Records which hold the data attached to this synchronous instrument
    */
   virtual std::vector<Record> GetRecords() = 0;
+
+protected:
+  // The labels being looked up by a bind call, kept to reuse their buffer; guarded by mu_
+  LabelSet lookup_labels_;
+
+  // The bound instruments that changed since the last collection
+  std::shared_ptr<ChangedBoundInstruments<T>> changed_ =
+      std::make_shared<ChangedBoundInstruments<T>>();
+
+  /**
+   * Checkpoints the bound instruments that changed since the last collection and returns their
+   * records, then removes from bound_instruments those that have no references left.
+   *
+   * Only the removal takes mu_, so recording through this instrument doesn't wait for the
+   * checkpoints, and the cost of a collection grows with the number of label sets that changed
+   * rather than with all of them.
+   *
+   * @param bound_instruments the bound instruments of this instrument, by their labels
+   */
+  template <class BoundInstruments>
+  std::vector<Record> CollectChanged(BoundInstruments &bound_instruments)
+  {
+    // Collections of one instrument take turns, so that one can't remove a bound instrument that
+    // another is still checkpointing
+    std::lock_guard<std::mutex> collect_lock(collect_mu_);
+    auto changed = changed_->Take();
+
+    std::vector<Record> ret;
+    ret.reserve(changed.size());
+    for (auto &bound : changed)
+    {
+      bound->ClearChanged();
+      auto agg_ptr = bound->GetAggregator();
+      agg_ptr->checkpoint();
+      ret.emplace_back(this->name_, this->description_, bound->GetLabels().ToString(),
+                       bound->GetLabels(), std::move(agg_ptr));
+    }
+
+    std::lock_guard<std::mutex> lk(this->mu_);
+    for (auto &bound : changed)
+    {
+      // Without references, only a call holding mu_ can change the instrument after this
+      if (bound->get_ref() == 0 && !bound->IsChanged())
+      {
+        auto it = bound_instruments.find(bound->GetLabels());
+        if (it != bound_instruments.end() && it->second == bound)
+        {
+          bound_instruments.erase(it);
+        }
+      }
+    }
+    return ret;
+  }
+
+private:
+  std::mutex collect_mu_;
 };
 
 template <class T>
@@ -238,12 +383,12 @@ class AsynchronousInstrument : public Instrument,
 
 // Helper functions for turning a trace::KeyValueIterable into a string
 inline void print_value(std::stringstream &ss,
-                        common::AttributeValue &value,
+                        opentelemetry::common::AttributeValue &value,
                         bool jsonTypes = false)
 {
   switch (value.index())
   {
-    case common::AttributeType::TYPE_STRING:
+    case opentelemetry::common::AttributeType::TYPE_STRING:
       if (jsonTypes)
         ss << '"';
       ss << nostd::get<nostd::string_view>(value);
@@ -281,7 +426,8 @@ inline std::string KvToString(const trace::KeyValueIterable &kv) noexcept
   if (size)
   {
     size_t i = 1;
-    kv.ForEachKeyValue([&](nostd::string_view key, common::AttributeValue value) noexcept {
+    kv.ForEachKeyValue([&](nostd::string_view key,
+                           opentelemetry::common::AttributeValue value) noexcept {
       ss << "\"" << key << "\":";
       print_value(ss, value, true);
       if (size != i)
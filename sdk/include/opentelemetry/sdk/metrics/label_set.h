@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "opentelemetry/nostd/string_view.h"
+#include "opentelemetry/sdk/common/string_intern_table.h"
+#include "opentelemetry/trace/key_value_iterable.h"
+#include "opentelemetry/version.h"
+
+OPENTELEMETRY_BEGIN_NAMESPACE
+namespace sdk
+{
+namespace metrics
+{
+/*
+ * The canonical form of a set of string labels, used to look up the bound instrument of a
+ * synchronous instrument.
+ *
+ * The labels are sorted by key and packed into one buffer as length-prefixed keys and values,
+ * with a 64-bit hash computed when they are assigned. Two label sets are equal if they hold the
+ * same labels in any order. Assign reuses the buffer, so reassigning a label set that has held
+ * labels as large before doesn't allocate.
+ */
+class LabelSet
+{
+public:
+  LabelSet() = default;
+
+  explicit LabelSet(const opentelemetry::trace::KeyValueIterable &labels) { Assign(labels); }
+
+  /**
+   * Replace the labels of this set.
+   * @param labels the labels; every value must be a string.
+   */
+  void Assign(const opentelemetry::trace::KeyValueIterable &labels)
+  {
+    using Label = std::pair<nostd::string_view, nostd::string_view>;
+
+    // Sort labels on the stack unless there are a lot of them
+    const size_t kMaxStackLabels = 16;
+    Label stack_labels[kMaxStackLabels];
+    std::vector<Label> heap_labels;
+    Label *sorted = stack_labels;
+    if (labels.size() > kMaxStackLabels)
+    {
+      heap_labels.resize(labels.size());
+      sorted = heap_labels.data();
+    }
+
+    size_t num_labels    = 0;
+    bool has_non_strings = false;
+    labels.ForEachKeyValue([&](nostd::string_view key,
+                               opentelemetry::common::AttributeValue value) noexcept {
+      if (num_labels == labels.size())
+      {
+        return false;
+      }
+      if (!nostd::holds_alternative<nostd::string_view>(value))
+      {
+        has_non_strings = true;
+        return false;
+      }
+      sorted[num_labels++] = Label{key, nostd::get<nostd::string_view>(value)};
+      return true;
+    });
+    if (has_non_strings)
+    {
+#if __EXCEPTIONS
+      throw std::invalid_argument("Labels must be strings");
+#else
+      std::terminate();
+#endif
+    }
+    std::sort(sorted, sorted + num_labels,
+              [](const Label &lhs, const Label &rhs) { return lhs.first < rhs.first; });
+
+    encoding_.clear();
+    for (size_t i = 0; i < num_labels; ++i)
+    {
+      Append(sorted[i].first);
+      Append(sorted[i].second);
+    }
+    num_labels_ = num_labels;
+    hash_       = common::StringInternTable::Hash(encoding_);
+  }
+
+  /**
+   * @return the number of labels
+   */
+  size_t size() const noexcept { return num_labels_; }
+
+  /**
+   * @return the hash of the labels
+   */
+  uint64_t hash() const noexcept { return hash_; }
+
+  /**
+   * Call callback with the key and the value of each label, in order of their keys.
+   */
+  template <class Callback>
+  void ForEachLabel(Callback callback) const
+  {
+    const char *position = encoding_.data();
+    const char *end      = position + encoding_.size();
+    while (position < end)
+    {
+      auto key   = Read(position);
+      auto value = Read(position);
+      callback(key, value);
+    }
+  }
+
+  /**
+   * @return the labels formatted as {"key1":"value1","key2":"value2"}, in order of their keys
+   */
+  std::string ToString() const
+  {
+    std::string result = "{";
+    ForEachLabel([&result](nostd::string_view key, nostd::string_view value) {
+      if (result.size() > 1)
+      {
+        result += ',';
+      }
+      result += '"';
+      result.append(key.data(), key.size());
+      result += "\":\"";
+      result.append(value.data(), value.size());
+      result += '"';
+    });
+    result += '}';
+    return result;
+  }
+
+  friend bool operator==(const LabelSet &lhs, const LabelSet &rhs) noexcept
+  {
+    return lhs.hash_ == rhs.hash_ && lhs.encoding_ == rhs.encoding_;
+  }
+
+  friend bool operator!=(const LabelSet &lhs, const LabelSet &rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+
+  /**
+   * A hash function for keying hash tables by label sets.
+   */
+  struct Hash
+  {
+    size_t operator()(const LabelSet &labels) const noexcept
+    {
+      return static_cast<size_t>(labels.hash_);
+    }
+  };
+
+private:
+  std::string encoding_;
+  size_t num_labels_ = 0;
+  uint64_t hash_     = common::StringInternTable::Hash("");
+
+  void Append(nostd::string_view str)
+  {
+    uint32_t size = static_cast<uint32_t>(str.size());
+    encoding_.append(reinterpret_cast<const char *>(&size), sizeof(size));
+    encoding_.append(str.data(), str.size());
+  }
+
+  static nostd::string_view Read(const char *&position) noexcept
+  {
+    uint32_t size;
+    std::memcpy(&size, position, sizeof(size));
+    nostd::string_view result{position + sizeof(size), size};
+    position += sizeof(size) + size;
+    return result;
+  }
+};
+}  // namespace metrics
+}  // namespace sdk
+OPENTELEMETRY_END_NAMESPACE
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <utility>
 #include "opentelemetry/metrics/instrument.h"
 #include "opentelemetry/nostd/variant.h"
 #include "opentelemetry/sdk/metrics/aggregator/aggregator.h"
+#include "opentelemetry/sdk/metrics/label_set.h"
 
 OPENTELEMETRY_BEGIN_NAMESPACE
 
@@ -24,22 +27,44 @@ class Record
                   nostd::string_view description,
                   std::string labels,
                   AggregatorVariant aggregator)
-  {
-    name_        = std::string(name);
-    description_ = std::string(description);
-    labels_      = labels;
-    aggregator_  = aggregator;
-  }
-
-  std::string GetName() { return name_; }
-  std::string GetDescription() { return description_; }
-  std::string GetLabels() { return labels_; }
-  AggregatorVariant GetAggregator() { return aggregator_; }
+      : name_(name),
+        description_(description),
+        labels_(std::move(labels)),
+        aggregator_(std::move(aggregator))
+  {}
+
+  /**
+   * Create a record that also carries its labels as a label set, for exporters that need the
+   * individual labels.
+   */
+  explicit Record(nostd::string_view name,
+                  nostd::string_view description,
+                  std::string labels,
+                  LabelSet label_set,
+                  AggregatorVariant aggregator)
+      : name_(name),
+        description_(description),
+        labels_(std::move(labels)),
+        label_set_(std::move(label_set)),
+        aggregator_(std::move(aggregator))
+  {}
+
+  const std::string &GetName() const noexcept { return name_; }
+  const std::string &GetDescription() const noexcept { return description_; }
+  const std::string &GetLabels() const noexcept { return labels_; }
+
+  /**
+   * @return the labels as a label set; empty if the record was created without one
+   */
+  const LabelSet &GetLabelSet() const noexcept { return label_set_; }
+
+  const AggregatorVariant &GetAggregator() const noexcept { return aggregator_; }
 
 private:
   std::string name_;
   std::string description_;
   std::string labels_;
+  LabelSet label_set_;
   AggregatorVariant aggregator_;
 };
 }  // namespace metrics
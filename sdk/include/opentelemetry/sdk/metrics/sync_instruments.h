@@ -2,6 +2,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
@@ -9,6 +10,7 @@
 #include "opentelemetry/sdk/metrics/aggregator/counter_aggregator.h"
 #include "opentelemetry/sdk/metrics/aggregator/min_max_sum_count_aggregator.h"
 #include "opentelemetry/sdk/metrics/instrument.h"
+#include "opentelemetry/sdk/metrics/label_set.h"
 
 namespace metrics_api = opentelemetry::metrics;
 
@@ -25,10 +27,15 @@ class BoundCounter final : public BoundSynchronousInstrument<T>, public metrics_
 public:
   BoundCounter() = default;
 
+  /**
+   * @param striped whether the counter's aggregator spreads updates over per-thread cells; see
+   * CounterAggregator.
+   */
   BoundCounter(nostd::string_view name,
                nostd::string_view description,
                nostd::string_view unit,
-               bool enabled)
+               bool enabled,
+               bool striped = false)
       : BoundSynchronousInstrument<T>(
             name,
             description,
@@ -36,7 +43,7 @@ class BoundCounter final : public BoundSynchronousInstrument<T>, public metrics_
             enabled,
             metrics_api::InstrumentKind::Counter,
             std::shared_ptr<Aggregator<T>>(new CounterAggregator<T>(
-                metrics_api::InstrumentKind::Counter)))  // Aggregator is chosen here
+                metrics_api::InstrumentKind::Counter, striped)))  // Aggregator is chosen here
   {}
 
   /*
@@ -70,15 +77,21 @@ class Counter final : public SynchronousInstrument<T>, public metrics_api::Count
 public:
   Counter() = default;
 
+  /**
+   * @param striped whether the aggregators of the bound counters spread updates over per-thread
+   * cells; see CounterAggregator.
+   */
   Counter(nostd::string_view name,
           nostd::string_view description,
           nostd::string_view unit,
-          bool enabled)
+          bool enabled,
+          bool striped = false)
       : SynchronousInstrument<T>(name,
                                  description,
                                  unit,
                                  enabled,
-                                 metrics_api::InstrumentKind::Counter)
+                                 metrics_api::InstrumentKind::Counter),
+        striped_(striped)
   {}
 
   /*
@@ -92,23 +105,11 @@ class Counter final : public SynchronousInstrument<T>, public metrics_api::Count
   virtual nostd::shared_ptr<metrics_api::BoundCounter<T>> bindCounter(
       const trace::KeyValueIterable &labels) override
   {
-    this->mu_.lock();
-    std::string labelset = KvToString(labels);
-    if (boundInstruments_.find(labelset) == boundInstruments_.end())
-    {
-      auto sp1 = nostd::shared_ptr<metrics_api::BoundCounter<T>>(
-          new BoundCounter<T>(this->name_, this->description_, this->unit_, this->enabled_));
-      boundInstruments_[labelset] = sp1;
-      this->mu_.unlock();
-      return sp1;
-    }
-    else
-    {
-      boundInstruments_[labelset]->inc_ref();
-      auto ret = boundInstruments_[labelset];
-      this->mu_.unlock();
-      return ret;
-    }
+    std::lock_guard<std::mutex> lk(this->mu_);
+    auto &bound = FindOrAddBound(labels);
+    bound->inc_ref();
+    return nostd::shared_ptr<metrics_api::BoundCounter<T>>(
+        std::shared_ptr<metrics_api::BoundCounter<T>>(bound));
   }
 
   /*
@@ -131,41 +132,44 @@ class Counter final : public SynchronousInstrument<T>, public metrics_api::Count
     }
     else
     {
-      auto sp = bindCounter(labels);
-      sp->update(value);
-      sp->unbind();
+      // Update the bound counter in place rather than binding it, which would copy and release a
+      // shared pointer and bump its reference count twice.
+      std::lock_guard<std::mutex> lk(this->mu_);
+      FindOrAddBound(labels)->update(value);
     }
   }
 
   virtual std::vector<Record> GetRecords() override
   {
-    this->mu_.lock();
-    std::vector<Record> ret;
-    std::vector<std::string> toDelete;
-    for (const auto &x : boundInstruments_)
-    {
-      if (x.second->get_ref() == 0)
-      {
-        toDelete.push_back(x.first);
-      }
-      auto agg_ptr = dynamic_cast<BoundCounter<T> *>(x.second.get())->GetAggregator();
-      agg_ptr->checkpoint();
-      ret.push_back(Record(x.second->GetName(), x.second->GetDescription(), x.first, agg_ptr));
-    }
-    for (const auto &x : toDelete)
-    {
-      boundInstruments_.erase(x);
-    }
-    this->mu_.unlock();
-    return ret;
+    return this->CollectChanged(boundInstruments_);
   }
 
   virtual void update(T val, const trace::KeyValueIterable &labels) override { add(val, labels); }
 
   // A collection of the bound instruments created by this unbound instrument identified by their
   // labels.
-  std::unordered_map<std::string, nostd::shared_ptr<metrics_api::BoundCounter<T>>>
-      boundInstruments_;
+  std::unordered_map<LabelSet, std::shared_ptr<BoundCounter<T>>, LabelSet::Hash> boundInstruments_;
+
+private:
+  bool striped_ = false;
+
+  /**
+   * @return the bound counter for labels, added unbound if there is none yet. mu_ must be held.
+   */
+  std::shared_ptr<BoundCounter<T>> &FindOrAddBound(const trace::KeyValueIterable &labels)
+  {
+    this->lookup_labels_.Assign(labels);
+    auto it = boundInstruments_.find(this->lookup_labels_);
+    if (it == boundInstruments_.end())
+    {
+      std::shared_ptr<BoundCounter<T>> bound(new BoundCounter<T>(
+          this->name_, this->description_, this->unit_, this->enabled_, striped_));
+      bound->unbind();
+      bound->TrackChanges(this->changed_, this->lookup_labels_);
+      it = boundInstruments_.emplace(this->lookup_labels_, std::move(bound)).first;
+    }
+    return it->second;
+  }
 };
 
 template <class T>
@@ -176,17 +180,22 @@ class BoundUpDownCounter final : public BoundSynchronousInstrument<T>,
 public:
   BoundUpDownCounter<T>() = default;
 
+  /**
+   * @param striped whether the counter's aggregator spreads updates over per-thread cells; see
+   * CounterAggregator.
+   */
   BoundUpDownCounter<T>(nostd::string_view name,
                         nostd::string_view description,
                         nostd::string_view unit,
-                        bool enabled)
+                        bool enabled,
+                        bool striped = false)
       : BoundSynchronousInstrument<T>(name,
                                       description,
                                       unit,
                                       enabled,
                                       metrics_api::InstrumentKind::UpDownCounter,
                                       std::shared_ptr<Aggregator<T>>(new CounterAggregator<T>(
-                                          metrics_api::InstrumentKind::UpDownCounter)))
+                                          metrics_api::InstrumentKind::UpDownCounter, striped)))
   {}
 
   /*
@@ -206,15 +215,21 @@ class UpDownCounter final : public SynchronousInstrument<T>, public metrics_api:
 public:
   UpDownCounter() = default;
 
+  /**
+   * @param striped whether the aggregators of the bound counters spread updates over per-thread
+   * cells; see CounterAggregator.
+   */
   UpDownCounter(nostd::string_view name,
                 nostd::string_view description,
                 nostd::string_view unit,
-                bool enabled)
+                bool enabled,
+                bool striped = false)
       : SynchronousInstrument<T>(name,
                                  description,
                                  unit,
                                  enabled,
-                                 metrics_api::InstrumentKind::UpDownCounter)
+                                 metrics_api::InstrumentKind::UpDownCounter),
+        striped_(striped)
   {}
 
   /*
@@ -227,23 +242,11 @@ class UpDownCounter final : public SynchronousInstrument<T>, public metrics_api:
   nostd::shared_ptr<metrics_api::BoundUpDownCounter<T>> bindUpDownCounter(
       const trace::KeyValueIterable &labels) override
   {
-    this->mu_.lock();
-    std::string labelset = KvToString(labels);
-    if (boundInstruments_.find(labelset) == boundInstruments_.end())
-    {
-      auto sp1 = nostd::shared_ptr<metrics_api::BoundUpDownCounter<T>>(
-          new BoundUpDownCounter<T>(this->name_, this->description_, this->unit_, this->enabled_));
-      boundInstruments_[labelset] = sp1;
-      this->mu_.unlock();
-      return sp1;
-    }
-    else
-    {
-      boundInstruments_[labelset]->inc_ref();
-      auto ret = boundInstruments_[labelset];
-      this->mu_.unlock();
-      return ret;
-    }
+    std::lock_guard<std::mutex> lk(this->mu_);
+    auto &bound = FindOrAddBound(labels);
+    bound->inc_ref();
+    return nostd::shared_ptr<metrics_api::BoundUpDownCounter<T>>(
+        std::shared_ptr<metrics_api::BoundUpDownCounter<T>>(bound));
   }
 
   /*
@@ -256,38 +259,40 @@ class UpDownCounter final : public SynchronousInstrument<T>, public metrics_api:
    */
   void add(T value, const trace::KeyValueIterable &labels) override
   {
-    auto sp = bindUpDownCounter(labels);
-    sp->update(value);
-    sp->unbind();
+    std::lock_guard<std::mutex> lk(this->mu_);
+    FindOrAddBound(labels)->update(value);
   }
 
   virtual std::vector<Record> GetRecords() override
   {
-    this->mu_.lock();
-    std::vector<Record> ret;
-    std::vector<std::string> toDelete;
-    for (const auto &x : boundInstruments_)
-    {
-      if (x.second->get_ref() == 0)
-      {
-        toDelete.push_back(x.first);
-      }
-      auto agg_ptr = dynamic_cast<BoundUpDownCounter<T> *>(x.second.get())->GetAggregator();
-      agg_ptr->checkpoint();
-      ret.push_back(Record(x.second->GetName(), x.second->GetDescription(), x.first, agg_ptr));
-    }
-    for (const auto &x : toDelete)
-    {
-      boundInstruments_.erase(x);
-    }
-    this->mu_.unlock();
-    return ret;
+    return this->CollectChanged(boundInstruments_);
   }
 
   virtual void update(T val, const trace::KeyValueIterable &labels) override { add(val, labels); }
 
-  std::unordered_map<std::string, nostd::shared_ptr<metrics_api::BoundUpDownCounter<T>>>
+  std::unordered_map<LabelSet, std::shared_ptr<BoundUpDownCounter<T>>, LabelSet::Hash>
       boundInstruments_;
+
+private:
+  bool striped_ = false;
+
+  /**
+   * @return the bound counter for labels, added unbound if there is none yet. mu_ must be held.
+   */
+  std::shared_ptr<BoundUpDownCounter<T>> &FindOrAddBound(const trace::KeyValueIterable &labels)
+  {
+    this->lookup_labels_.Assign(labels);
+    auto it = boundInstruments_.find(this->lookup_labels_);
+    if (it == boundInstruments_.end())
+    {
+      std::shared_ptr<BoundUpDownCounter<T>> bound(new BoundUpDownCounter<T>(
+          this->name_, this->description_, this->unit_, this->enabled_, striped_));
+      bound->unbind();
+      bound->TrackChanges(this->changed_, this->lookup_labels_);
+      it = boundInstruments_.emplace(this->lookup_labels_, std::move(bound)).first;
+    }
+    return it->second;
+  }
 };
 
 template <class T>
@@ -350,23 +355,11 @@ class ValueRecorder final : public SynchronousInstrument<T>, public metrics_api:
   nostd::shared_ptr<metrics_api::BoundValueRecorder<T>> bindValueRecorder(
       const trace::KeyValueIterable &labels) override
   {
-    this->mu_.lock();
-    std::string labelset = KvToString(labels);
-    if (boundInstruments_.find(labelset) == boundInstruments_.end())
-    {
-      auto sp1 = nostd::shared_ptr<metrics_api::BoundValueRecorder<T>>(
-          new BoundValueRecorder<T>(this->name_, this->description_, this->unit_, this->enabled_));
-      boundInstruments_[labelset] = sp1;
-      this->mu_.unlock();
-      return sp1;
-    }
-    else
-    {
-      boundInstruments_[labelset]->inc_ref();
-      auto ret = boundInstruments_[labelset];
-      this->mu_.unlock();
-      return ret;
-    }
+    std::lock_guard<std::mutex> lk(this->mu_);
+    auto &bound = FindOrAddBound(labels);
+    bound->inc_ref();
+    return nostd::shared_ptr<metrics_api::BoundValueRecorder<T>>(
+        std::shared_ptr<metrics_api::BoundValueRecorder<T>>(bound));
   }
 
   /*
@@ -379,32 +372,13 @@ class ValueRecorder final : public SynchronousInstrument<T>, public metrics_api:
    */
   void record(T value, const trace::KeyValueIterable &labels) override
   {
-    auto sp = bindValueRecorder(labels);
-    sp->update(value);
-    sp->unbind();
+    std::lock_guard<std::mutex> lk(this->mu_);
+    FindOrAddBound(labels)->update(value);
   }
 
   virtual std::vector<Record> GetRecords() override
   {
-    this->mu_.lock();
-    std::vector<Record> ret;
-    std::vector<std::string> toDelete;
-    for (const auto &x : boundInstruments_)
-    {
-      if (x.second->get_ref() == 0)
-      {
-        toDelete.push_back(x.first);
-      }
-      auto agg_ptr = dynamic_cast<BoundValueRecorder<T> *>(x.second.get())->GetAggregator();
-      agg_ptr->checkpoint();
-      ret.push_back(Record(x.second->GetName(), x.second->GetDescription(), x.first, agg_ptr));
-    }
-    for (const auto &x : toDelete)
-    {
-      boundInstruments_.erase(x);
-    }
-    this->mu_.unlock();
-    return ret;
+    return this->CollectChanged(boundInstruments_);
   }
 
   virtual void update(T value, const trace::KeyValueIterable &labels) override
@@ -412,8 +386,27 @@ class ValueRecorder final : public SynchronousInstrument<T>, public metrics_api:
     record(value, labels);
   }
 
-  std::unordered_map<std::string, nostd::shared_ptr<metrics_api::BoundValueRecorder<T>>>
+  std::unordered_map<LabelSet, std::shared_ptr<BoundValueRecorder<T>>, LabelSet::Hash>
       boundInstruments_;
+
+private:
+  /**
+   * @return the bound recorder for labels, added unbound if there is none yet. mu_ must be held.
+   */
+  std::shared_ptr<BoundValueRecorder<T>> &FindOrAddBound(const trace::KeyValueIterable &labels)
+  {
+    this->lookup_labels_.Assign(labels);
+    auto it = boundInstruments_.find(this->lookup_labels_);
+    if (it == boundInstruments_.end())
+    {
+      std::shared_ptr<BoundValueRecorder<T>> bound(new BoundValueRecorder<T>(
+          this->name_, this->description_, this->unit_, this->enabled_));
+      bound->unbind();
+      bound->TrackChanges(this->changed_, this->lookup_labels_);
+      it = boundInstruments_.emplace(this->lookup_labels_, std::move(bound)).first;
+    }
+    return it->second;
+  }
 };
 
 }  // namespace metrics
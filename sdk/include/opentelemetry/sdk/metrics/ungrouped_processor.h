@@ -26,16 +26,22 @@ struct KeyStruct
   std::string labels;
   metrics_api::InstrumentKind ins_kind;
 
+  // The labels as a label set, carried over into the checkpointed record; equal label strings
+  // have equal label sets, so it isn't compared
+  LabelSet label_set;
+
   // constructor
   KeyStruct(std::string name,
             std::string description,
             std::string labels,
-            metrics_api::InstrumentKind ins_kind)
+            metrics_api::InstrumentKind ins_kind,
+            LabelSet label_set = LabelSet())
   {
     this->name        = name;
     this->description = description;
     this->labels      = labels;
     this->ins_kind    = ins_kind;
+    this->label_set   = std::move(label_set);
   }
 
   // operator== is required to compare keys in case of hash collision
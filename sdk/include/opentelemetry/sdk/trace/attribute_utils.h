@@ -1,8 +1,13 @@
 #pragma once
 
-#include <unordered_map>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 #include "opentelemetry/common/attribute_value.h"
+#include "opentelemetry/sdk/common/string_intern_table.h"
 #include "opentelemetry/trace/key_value_iterable_view.h"
 
 OPENTELEMETRY_BEGIN_NAMESPACE
@@ -84,6 +89,200 @@ struct AttributeConverter
   }
 };
 
+/**
+ * A flat, insertion-ordered container of owned attributes.
+ *
+ * Keys are interned in the global StringInternTable, so that repeated keys don't need a copy of
+ * their own and are compared by pointer. Looking up a key by a string_view compares and hashes its
+ * content instead, so it never interns or copies the key.
+ *
+ * The attributes are stored in a single vector. Spans usually carry only a handful of attributes,
+ * so up to kLinearScanLimit attributes are looked up by a linear scan, without hashing. Above that,
+ * an open-addressing index with linear probing is built over them. Setting an existing key
+ * overwrites its value in place.
+ */
+class FlatAttributeMap
+{
+public:
+  using value_type = std::pair<sdk::common::InternedString, SpanDataAttributeValue>;
+
+  static constexpr size_t kLinearScanLimit = 8;
+
+  using const_iterator = std::vector<value_type>::const_iterator;
+
+  /**
+   * @return the number of attributes stored
+   */
+  size_t size() const noexcept { return entries_.size(); }
+
+  /**
+   * @return true if no attributes are stored
+   */
+  bool empty() const noexcept { return entries_.empty(); }
+
+  const_iterator begin() const noexcept { return entries_.begin(); }
+
+  const_iterator end() const noexcept { return entries_.end(); }
+
+  /**
+   * Find the attribute with the given key.
+   * @return an iterator to the attribute, or end() if there's no such attribute
+   */
+  const_iterator find(nostd::string_view key) const noexcept
+  {
+    return entries_.begin() + IndexOf(key, sdk::common::StringInternTable::Hash(key));
+  }
+
+  /**
+   * @return 1 if there's an attribute with the given key, 0 otherwise
+   */
+  size_t count(nostd::string_view key) const noexcept { return find(key) == end() ? 0 : 1; }
+
+  /**
+   * Get the value of the attribute with the given key.
+   * @throws std::out_of_range if there's no such attribute
+   */
+  const SpanDataAttributeValue &at(nostd::string_view key) const
+  {
+    auto index = IndexOf(key, sdk::common::StringInternTable::Hash(key));
+    if (index == entries_.size())
+    {
+      throw std::out_of_range{"FlatAttributeMap::at"};
+    }
+    return entries_[index].second;
+  }
+
+  /**
+   * Get the value of the attribute with the given key, inserting an attribute with a
+   * default-constructed value if there's no such attribute.
+   */
+  SpanDataAttributeValue &operator[](nostd::string_view key)
+  {
+    return (*this)[sdk::common::InternedString{key}];
+  }
+
+  /**
+   * Get the value of the attribute with the given interned key, inserting an attribute with a
+   * default-constructed value if there's no such attribute.
+   */
+  SpanDataAttributeValue &operator[](const sdk::common::InternedString &key)
+  {
+    if (entries_.size() <= kLinearScanLimit)
+    {
+      auto index = IndexOf(key, key.hash());
+      if (index < entries_.size())
+      {
+        return entries_[index].second;
+      }
+      auto &entry = Append(key);
+      if (entries_.size() > kLinearScanLimit)
+      {
+        Rehash();
+      }
+      return entry.second;
+    }
+
+    if ((entries_.size() + 1) * 2 > slots_.size())
+    {
+      Rehash();
+    }
+    auto slot = FindSlot(key, key.hash());
+    if (slots_[slot] != 0)
+    {
+      return entries_[slots_[slot] - 1].second;
+    }
+    auto &entry  = Append(key);
+    slots_[slot] = static_cast<uint32_t>(entries_.size());
+    return entry.second;
+  }
+
+  /**
+   * Reserve storage for the given number of attributes.
+   */
+  void reserve(size_t num_attributes) { entries_.reserve(num_attributes); }
+
+  /**
+   * Remove all attributes.
+   */
+  void clear() noexcept
+  {
+    entries_.clear();
+    slots_.clear();
+  }
+
+private:
+  std::vector<value_type> entries_;
+
+  // Open-addressing index over the entries, only valid while there are more than
+  // kLinearScanLimit of them. Each slot holds an entry's index plus one, or 0 if the slot is empty.
+  std::vector<uint32_t> slots_;
+
+  value_type &Append(const sdk::common::InternedString &key)
+  {
+    if (entries_.capacity() == 0)
+    {
+      entries_.reserve(kLinearScanLimit);
+    }
+    entries_.emplace_back(key, SpanDataAttributeValue{});
+    return entries_.back();
+  }
+
+  // Look up an interned key or a string_view, given its hash.
+  template <class Key>
+  size_t IndexOf(const Key &key, uint64_t hash) const noexcept
+  {
+    if (entries_.size() <= kLinearScanLimit)
+    {
+      for (size_t index = 0; index < entries_.size(); ++index)
+      {
+        if (entries_[index].first == key)
+        {
+          return index;
+        }
+      }
+      return entries_.size();
+    }
+    auto slot = FindSlot(key, hash);
+    return slots_[slot] == 0 ? entries_.size() : slots_[slot] - 1;
+  }
+
+  // Find the slot that holds key, or the empty slot where it would be inserted. The index is at
+  // most half full, so there always is one.
+  template <class Key>
+  size_t FindSlot(const Key &key, uint64_t hash) const noexcept
+  {
+    const size_t mask = slots_.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+    {
+      if (slots_[slot] == 0)
+      {
+        return slot;
+      }
+      auto &entry_key = entries_[slots_[slot] - 1].first;
+      if (entry_key.hash() == hash && entry_key == key)
+      {
+        return slot;
+      }
+    }
+  }
+
+  // Rebuild the index so that it covers all entries and one more, and stays at most half full.
+  void Rehash()
+  {
+    size_t num_slots = 4 * kLinearScanLimit;
+    while (num_slots < (entries_.size() + 1) * 2)
+    {
+      num_slots *= 2;
+    }
+    slots_.assign(num_slots, 0);
+    for (size_t index = 0; index < entries_.size(); ++index)
+    {
+      auto &key                         = entries_[index].first;
+      slots_[FindSlot(key, key.hash())] = static_cast<uint32_t>(index + 1);
+    }
+  }
+};
+
 /**
  * Class for storing attributes.
  */
@@ -96,6 +295,7 @@ class AttributeMap
   // Contruct attribute map and populate with attributes
   AttributeMap(const opentelemetry::trace::KeyValueIterable &attributes)
   {
+    attributes_.reserve(attributes.size());
     attributes.ForEachKeyValue([&](nostd::string_view key,
                                    opentelemetry::common::AttributeValue value) noexcept {
       SetAttribute(key, value);
@@ -103,19 +303,16 @@ class AttributeMap
     });
   }
 
-  const std::unordered_map<std::string, SpanDataAttributeValue> &GetAttributes() const noexcept
-  {
-    return attributes_;
-  }
+  const FlatAttributeMap &GetAttributes() const noexcept { return attributes_; }
 
   void SetAttribute(nostd::string_view key,
                     const opentelemetry::common::AttributeValue &value) noexcept
   {
-    attributes_[std::string(key)] = nostd::visit(converter_, value);
+    attributes_[key] = nostd::visit(converter_, value);
   }
 
 private:
-  std::unordered_map<std::string, SpanDataAttributeValue> attributes_;
+  FlatAttributeMap attributes_;
   AttributeConverter converter_;
 };
 }  // namespace trace
@@ -1,20 +1,151 @@
 #pragma once
 
-#include "opentelemetry/sdk/common/circular_buffer.h"
+#include "opentelemetry/sdk/common/object_pool.h"
+#include "opentelemetry/sdk/common/sharded_circular_buffer.h"
 #include "opentelemetry/sdk/trace/exporter.h"
 #include "opentelemetry/sdk/trace/processor.h"
+#include "opentelemetry/sdk/trace/span_processor_stats.h"
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <thread>
+#include <vector>
 
 OPENTELEMETRY_BEGIN_NAMESPACE
+class BatchSpanProcessorTestPeer;
+
 namespace sdk
 {
 
 namespace trace
 {
 
+/**
+ * What a BatchSpanProcessor does with an ended span when its queue is full.
+ */
+enum class OverflowPolicy
+{
+  /* Drop the ended span. */
+  kDropNewest,
+
+  /* Drop the oldest queued span, and queue the ended span in its place. Spans may then be exported
+   * out of order. */
+  kDropOldest
+};
+
+/**
+ * Struct to hold batch SpanProcessor options.
+ */
+struct BatchSpanProcessorOptions
+{
+  /**
+   * The maximum buffer/queue size. After the size is reached, spans are
+   * dropped. If num_queue_shards is greater than 1, the queue is split evenly
+   * between the shards: each holds max_queue_size / num_queue_shards spans,
+   * rounded up, and a thread's spans are dropped once its own shard is full,
+   * even if other shards have room.
+   */
+  size_t max_queue_size = 2048;
+
+  /* The time interval between two consecutive exports. */
+  std::chrono::milliseconds schedule_delay_millis = std::chrono::milliseconds(5000);
+
+  /**
+   * The maximum batch size of every export. It must be smaller or
+   * equal to max_queue_size.
+   */
+  size_t max_export_batch_size = 512;
+
+  /**
+   * The number of shards the queue is split into. Each thread calling OnEnd is
+   * assigned one shard, so producers on different shards don't contend with
+   * each other. The worker thread drains the shards round-robin. The default of
+   * 1 keeps a single shared queue. Each shard gets an equal part of
+   * max_queue_size, so a single busy thread can fill its shard and drop spans
+   * well below max_queue_size.
+   */
+  size_t num_queue_shards = 1;
+
+  /**
+   * The number of threads that call the exporter. With the default of 0 the worker thread exports
+   * each batch itself, so the queue isn't drained while an export is in progress. Otherwise, the
+   * worker thread only drains the queue into batches and hands them to the export threads, so that
+   * the next batch is collected while the previous one is being exported. If this is greater than
+   * 1, batches may be exported out of order. Only one export thread is started if the exporter's
+   * SupportsConcurrentExport returns false.
+   */
+  size_t num_export_threads = 0;
+
+  /**
+   * The maximum number of batches handed to the export threads that haven't been exported yet.
+   * Once reached, the worker thread stops draining the queue until an export completes, and spans
+   * are dropped once the queue fills up. Only used if num_export_threads is greater than 0; a value
+   * of 0 is treated as 1.
+   */
+  size_t max_in_flight_batches = 2;
+
+  /**
+   * Whether to tune the export batch size and the schedule delay from the observed span arrival
+   * rate, exporter latency and drops. max_export_batch_size and schedule_delay_millis become upper
+   * bounds: each batch holds about as many spans as arrive within schedule_delay_millis, and the
+   * worker thread waits about as long as it takes for a batch to arrive, so that no span waits
+   * much longer than schedule_delay_millis to be exported. While spans are dropped faster than
+   * target_drop_ratio allows, batches are kept at their largest and exported more often.
+   */
+  bool adaptive_scheduling = false;
+
+  /* The smallest batch size the adaptive scheduler picks. */
+  size_t min_export_batch_size = 64;
+
+  /* The shortest schedule delay the adaptive scheduler picks. */
+  std::chrono::milliseconds min_schedule_delay_millis = std::chrono::milliseconds(100);
+
+  /* The fraction of ended spans that may be dropped before the adaptive scheduler reacts. */
+  double target_drop_ratio = 0.0;
+
+  /* What to do with an ended span when the queue is full. */
+  OverflowPolicy overflow_policy = OverflowPolicy::kDropNewest;
+
+  /**
+   * The size of a separate queue for spans whose status isn't OK. The worker thread exports it
+   * before the main queue, so that error spans aren't dropped while ordinary spans overflow; error
+   * spans only go to the main queue once it's full. The default of 0 disables it.
+   */
+  size_t priority_queue_size = 0;
+
+  /**
+   * The number of exported recordables kept for reuse. Recordables that the exporter leaves in the
+   * batch are reset after Export returns and handed out again by MakeRecordable, instead of being
+   * destroyed and allocated anew for the next spans. The default of 0 disables reuse.
+   */
+  size_t recordable_pool_size = 0;
+};
+
+/**
+ * The current decisions of a BatchSpanProcessor's scheduler, and the measurements they're based on.
+ */
+struct BatchSpanProcessorScheduleStats
+{
+  /* The maximum number of spans exported per batch. */
+  size_t export_batch_size;
+
+  /* The longest the worker thread waits between exports. */
+  std::chrono::milliseconds schedule_delay;
+
+  /* The number of queued spans per shard at which producers wake the worker thread. */
+  size_t wake_threshold;
+
+  /* The smoothed rate at which spans are ended, in spans per second, including dropped ones. */
+  double arrival_rate;
+
+  /* The smoothed time the exporter takes to export a batch. */
+  std::chrono::microseconds export_latency;
+
+  /* The fraction of the spans ended during the last export cycle that were dropped. */
+  double drop_ratio;
+};
+
 /**
  * This is an implementation of the SpanProcessor which creates batches of finished spans and passes
  * the export-friendly span data representations to the configured SpanExporter.
@@ -40,7 +171,18 @@ class BatchSpanProcessor : public SpanProcessor
       const size_t max_export_batch_size                    = 512);
 
   /**
-   * Requests a Recordable(Span) from the configured exporter.
+   * Creates a batch span processor by configuring the specified exporter and other parameters
+   * as per the official, language-agnostic opentelemetry specs.
+   *
+   * @param exporter - The backend exporter to pass the ended spans to
+   * @param options - The batch SpanProcessor options
+   */
+  BatchSpanProcessor(std::unique_ptr<SpanExporter> &&exporter,
+                     const BatchSpanProcessorOptions &options);
+
+  /**
+   * Returns a reset Recordable(Span) from the pool of exported recordables, or requests a new one
+   * from the configured exporter if the pool is empty.
    *
    * @return A recordable generated by the backend exporter
    */
@@ -63,9 +205,18 @@ class BatchSpanProcessor : public SpanProcessor
   void OnEnd(std::unique_ptr<Recordable> &&span) noexcept override;
 
   /**
-   * Export all ended spans that have not been exported yet.
+   * Adds several spans to the buffer at once, waking the worker thread at most once.
    *
-   * NOTE: Timeout functionality not supported yet.
+   * @param spans - Recordables for spans that just ended
+   */
+  void OnEndBatch(const nostd::span<std::unique_ptr<Recordable>> &spans) noexcept override;
+
+  /**
+   * Export all ended spans that have not been exported yet, and wait until they have been.
+   * Concurrent calls are served by the same export cycle. The calling thread sleeps while it
+   * waits.
+   *
+   * @param timeout - The maximum time to wait; the default of 0 waits until the spans are exported
    */
   void ForceFlush(
       std::chrono::microseconds timeout = std::chrono::milliseconds(0)) noexcept override;
@@ -87,7 +238,21 @@ class BatchSpanProcessor : public SpanProcessor
    */
   ~BatchSpanProcessor();
 
+  /**
+   * @return the scheduler's current decisions. If adaptive scheduling is disabled, they're the
+   * configured values.
+   */
+  BatchSpanProcessorScheduleStats GetScheduleStats() const noexcept;
+
+  /**
+   * @return a snapshot of the processor's statistics. The queue's high-water mark is sampled by
+   * the worker thread before each export, and whenever a span is dropped.
+   */
+  SpanProcessorStats GetStats() const noexcept;
+
 private:
+  friend class opentelemetry::BatchSpanProcessorTestPeer;
+
   /**
    * The background routine performed by the worker thread.
    */
@@ -97,12 +262,67 @@ class BatchSpanProcessor : public SpanProcessor
    * Exports all ended spans to the configured exporter.
    *
    * @param was_force_flush_called - A flag to check if the current export is the result
-   *                                 of a call to ForceFlush method. If true, then we have to
-   *                                 notify the main thread to wake it up in the ForceFlush
-   *                                 method.
+   *                                 of a call to ForceFlush method. If true, then every span in
+   *                                 the queue is exported before returning.
    */
   void Export(const bool was_for_flush_called);
 
+  /**
+   * Passes a batch of spans to the configured exporter, and records its latency and result.
+   * Recordables that the exporter leaves in the batch go back to the recordable pool.
+   */
+  void ExportBatch(std::vector<std::unique_ptr<Recordable>> &spans);
+
+  /**
+   * The routine performed by each export thread.
+   */
+  void DoExportWork();
+
+  /**
+   * Hands a batch to the export threads, waiting while max_in_flight_batches batches are in
+   * flight.
+   */
+  void ScheduleBatch(std::vector<std::unique_ptr<Recordable>> &&spans);
+
+  /**
+   * Waits until every batch handed to the export threads has been exported.
+   */
+  void WaitForExports();
+
+  /**
+   * Updates the arrival rate and drop ratio measured since the last call, and, if adaptive
+   * scheduling is enabled, picks the batch size and schedule delay from them.
+   *
+   * @param now - The current time
+   */
+  void UpdateSchedule(std::chrono::steady_clock::time_point now);
+
+  /**
+   * Adds an ended span to the priority queue if it's an error span, or to the calling thread's
+   * shard, applying the overflow policy if they're full.
+   *
+   * @return true if the span was queued
+   */
+  bool Enqueue(std::unique_ptr<Recordable> &span,
+               common::CircularBuffer<Recordable> &shard) noexcept;
+
+  /**
+   * @return true if enough spans are queued in the shard or the priority queue to wake the worker
+   * thread.
+   */
+  bool ShouldWakeWorker(const common::CircularBuffer<Recordable> &shard) const noexcept;
+
+  /**
+   * @return true if a full batch is queued, or enough spans are queued in any shard to wake the
+   * worker thread.
+   */
+  bool IsBatchQueued() noexcept;
+
+  /**
+   * @return the number of spans queued, including those in the priority queue.
+   */
+  size_t QueueSize() const noexcept;
+
   /**
    * Called when Shutdown() is invoked. Completely drains the queue of all its ended spans and
    * passes them to the exporter.
@@ -112,22 +332,68 @@ class BatchSpanProcessor : public SpanProcessor
   /* The configured backend exporter */
   std::unique_ptr<SpanExporter> exporter_;
 
+  /* Exported recordables kept for reuse; null if disabled */
+  std::unique_ptr<common::ObjectPool<Recordable>> recordable_pool_;
+
   /* Configurable parameters as per the official specs */
   const size_t max_queue_size_;
   const std::chrono::milliseconds schedule_delay_millis_;
   const size_t max_export_batch_size_;
 
+  /* Bounds for the adaptive scheduler */
+  const bool adaptive_scheduling_;
+  const size_t min_export_batch_size_;
+  const std::chrono::milliseconds min_schedule_delay_millis_;
+  const double target_drop_ratio_;
+
+  /* The scheduler's current decisions */
+  std::atomic<size_t> export_batch_size_;
+  std::atomic<int64_t> schedule_delay_millis_count_;
+  std::atomic<size_t> wake_threshold_;
+
+  /* The measurements behind them, guarded by schedule_m_ */
+  mutable std::mutex schedule_m_;
+  double arrival_rate_                         = 0;
+  double drop_ratio_                           = 0;
+  std::chrono::microseconds export_latency_    = std::chrono::microseconds::zero();
+  std::chrono::steady_clock::time_point last_update_time_;
+  uint64_t last_production_count_ = 0;
+  uint64_t last_num_dropped_      = 0;
+
+  /* What to do when the queue is full */
+  const OverflowPolicy overflow_policy_;
+
+  /* Counts of the spans received, dropped and exported */
+  SpanProcessorStatsRecorder stats_;
+
   /* Synchronization primitives */
   std::condition_variable cv_, force_flush_cv_;
   std::mutex cv_m_, force_flush_cv_m_;
 
   /* The buffer/queue to which the ended spans are added */
-  common::CircularBuffer<Recordable> buffer_;
+  common::ShardedCircularBuffer<Recordable> buffer_;
+
+  /* The queue for error spans, exported first; null if disabled */
+  std::unique_ptr<common::CircularBuffer<Recordable>> priority_buffer_;
 
   /* Important boolean flags to handle the workflow of the processor */
   std::atomic<bool> is_shutdown_{false};
-  std::atomic<bool> is_force_flush_{false};
-  std::atomic<bool> is_force_flush_notified_{false};
+
+  /* The number of ForceFlush calls made, guarded by cv_m_, and the number whose spans have been
+   * exported, guarded by force_flush_cv_m_ */
+  uint64_t flush_requested_seq_ = 0;
+  uint64_t flush_completed_seq_ = 0;
+
+  /* Batches waiting for an export thread, and the number of batches not exported yet */
+  const size_t max_in_flight_batches_;
+  std::deque<std::vector<std::unique_ptr<Recordable>>> pending_batches_;
+  size_t num_in_flight_batches_ = 0;
+  bool is_export_shutdown_      = false;
+  std::condition_variable export_cv_, export_done_cv_;
+  std::mutex export_m_;
+
+  /* The threads that call the exporter, if export is pipelined */
+  std::vector<std::thread> export_threads_;
 
   /* The background worker thread */
   std::thread worker_thread_;
@@ -44,13 +44,21 @@ class SpanExporter
 
   /**
    * Exports a batch of span recordables. This method must not be called
-   * concurrently for the same exporter instance.
+   * concurrently for the same exporter instance, unless
+   * SupportsConcurrentExport returns true. Exporters that keep recordables
+   * after Export returns must call Recordable::Materialize on them first.
    * @param spans a span of unique pointers to span recordables
    */
   virtual ExportResult Export(
       const nostd::span<std::unique_ptr<opentelemetry::sdk::trace::Recordable>>
           &spans) noexcept = 0;
 
+  /**
+   * @return true if Export may be called concurrently for the same exporter
+   * instance
+   */
+  virtual bool SupportsConcurrentExport() const noexcept { return false; }
+
   /**
    * Shut down the exporter.
    * @param timeout an optional timeout, the default timeout of 0 means that no
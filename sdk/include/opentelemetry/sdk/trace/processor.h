@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <memory>
+#include "opentelemetry/nostd/span.h"
 #include "opentelemetry/sdk/trace/recordable.h"
 
 OPENTELEMETRY_BEGIN_NAMESPACE
@@ -34,11 +35,26 @@ class SpanProcessor
   virtual void OnStart(Recordable &span) noexcept = 0;
 
   /**
-   * OnEnd is called when a span is ended.
+   * OnEnd is called when a span is ended. Processors that keep the recordable
+   * after OnEnd returns must call Recordable::Materialize on it first.
    * @param span a recordable for a span that was ended
    */
   virtual void OnEnd(std::unique_ptr<Recordable> &&span) noexcept = 0;
 
+  /**
+   * OnEndBatch is called when several spans are ended together. By default,
+   * OnEnd is called for each of them.
+   * @param spans recordables for spans that were ended; the processor takes
+   * ownership of them
+   */
+  virtual void OnEndBatch(const nostd::span<std::unique_ptr<Recordable>> &spans) noexcept
+  {
+    for (auto &span : spans)
+    {
+      OnEnd(std::move(span));
+    }
+  }
+
   /**
    * Export all ended spans that have not yet been exported.
    * @param timeout an optional timeout, the default timeout of 0 means that no
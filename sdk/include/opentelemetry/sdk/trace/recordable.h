@@ -47,6 +47,27 @@ class Recordable
   virtual void SetAttribute(nostd::string_view key,
                             const opentelemetry::common::AttributeValue &value) noexcept = 0;
 
+  /**
+   * Set an attribute of a span without copying its key and value. The caller
+   * guarantees that both stay valid until the span has ended. Span processors
+   * and exporters that keep the recordable after that call Materialize first.
+   *
+   * Recordables that can't hold on to borrowed data copy the attribute, just
+   * like SetAttribute.
+   * @param name the name of the attribute
+   * @param value the attribute value
+   */
+  virtual void SetBorrowedAttribute(nostd::string_view key,
+                                    const opentelemetry::common::AttributeValue &value) noexcept
+  {
+    SetAttribute(key, value);
+  }
+
+  /**
+   * Replace all borrowed attributes with owned copies.
+   */
+  virtual void Materialize() noexcept {}
+
   /**
    * Add an event to a span.
    * @param name the name of the event
@@ -119,6 +140,21 @@ class Recordable
    * @param duration the duration to set
    */
   virtual void SetDuration(std::chrono::nanoseconds duration) noexcept = 0;
+
+  /**
+   * Processors use this to keep error spans when they have to drop spans.
+   * Recordables that don't keep the status return false.
+   * @return true if the status was set to a code other than OK
+   */
+  virtual bool HasErrorStatus() const noexcept { return false; }
+
+  /**
+   * Clear all data recorded so far, so that a processor can reuse this recordable for a new span.
+   * Implementations should keep already allocated storage around for the next span. Recordables
+   * that can't be reused return false.
+   * @return true if the recordable was cleared and may be reused
+   */
+  virtual bool Reset() noexcept { return false; }
 };
 }  // namespace trace
 }  // namespace sdk
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <chrono>
+
 #include "opentelemetry/sdk/trace/exporter.h"
 #include "opentelemetry/sdk/trace/processor.h"
+#include "opentelemetry/sdk/trace/span_processor_stats.h"
 
 OPENTELEMETRY_BEGIN_NAMESPACE
 namespace sdk
@@ -35,11 +38,12 @@ class SimpleSpanProcessor : public SpanProcessor
   void OnEnd(std::unique_ptr<Recordable> &&span) noexcept override
   {
     nostd::span<std::unique_ptr<Recordable>> batch(&span, 1);
-    if (exporter_->Export(batch) == ExportResult::kFailure)
-    {
-      /* Once it is defined how the SDK does logging, an error should be
-       * logged in this case. */
-    }
+    Export(batch);
+  }
+
+  void OnEndBatch(const nostd::span<std::unique_ptr<Recordable>> &spans) noexcept override
+  {
+    Export(spans);
   }
 
   void ForceFlush(
@@ -51,8 +55,30 @@ class SimpleSpanProcessor : public SpanProcessor
     exporter_->Shutdown(timeout);
   }
 
+  /**
+   * @return a snapshot of the processor's statistics. The processor has no
+   * queue, so no spans are ever dropped or queued.
+   */
+  SpanProcessorStats GetStats() const noexcept { return stats_.GetStats(); }
+
 private:
   std::unique_ptr<SpanExporter> exporter_;
+  SpanProcessorStatsRecorder stats_;
+
+  void Export(const nostd::span<std::unique_ptr<Recordable>> &spans) noexcept
+  {
+    stats_.RecordReceived(spans.size());
+    auto start  = std::chrono::steady_clock::now();
+    auto result = exporter_->Export(spans);
+    stats_.RecordExport(spans.size(), result,
+                        std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - start));
+    if (result == ExportResult::kFailure)
+    {
+      /* Once it is defined how the SDK does logging, an error should be
+       * logged in this case. */
+    }
+  }
 };
 }  // namespace trace
 }  // namespace sdk
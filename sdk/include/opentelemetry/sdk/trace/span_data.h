@@ -1,7 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 #include "opentelemetry/common/attribute_value.h"
 #include "opentelemetry/core/timestamp.h"
@@ -23,7 +24,7 @@ namespace trace
 class SpanDataEvent
 {
 public:
-  SpanDataEvent(std::string name,
+  SpanDataEvent(nostd::string_view name,
                 core::SystemTimestamp timestamp,
                 const trace_api::KeyValueIterable &attributes)
       : name_(name), timestamp_(timestamp), attribute_map_(attributes)
@@ -33,7 +34,7 @@ class SpanDataEvent
    * Get the name for this event
    * @return the name for this event
    */
-  std::string GetName() const noexcept { return name_; }
+  nostd::string_view GetName() const noexcept { return name_.view(); }
 
   /**
    * Get the timestamp for this event
@@ -45,13 +46,10 @@ class SpanDataEvent
    * Get the attributes for this event
    * @return the attributes for this event
    */
-  const std::unordered_map<std::string, SpanDataAttributeValue> &GetAttributes() const noexcept
-  {
-    return attribute_map_.GetAttributes();
-  }
+  const FlatAttributeMap &GetAttributes() const noexcept { return attribute_map_.GetAttributes(); }
 
 private:
-  std::string name_;
+  sdk::common::InternedString name_;
   core::SystemTimestamp timestamp_;
   AttributeMap attribute_map_;
 };
@@ -72,10 +70,7 @@ class SpanDataLink
    * Get the attributes for this link
    * @return the attributes for this link
    */
-  const std::unordered_map<std::string, SpanDataAttributeValue> &GetAttributes() const noexcept
-  {
-    return attribute_map_.GetAttributes();
-  }
+  const FlatAttributeMap &GetAttributes() const noexcept { return attribute_map_.GetAttributes(); }
 
 private:
   opentelemetry::trace::SpanContext span_context_;
@@ -110,7 +105,7 @@ class SpanData final : public Recordable
    * Get the name for this span
    * @return the name for this span
    */
-  opentelemetry::nostd::string_view GetName() const noexcept { return name_; }
+  opentelemetry::nostd::string_view GetName() const noexcept { return name_.view(); }
 
   /**
    * Get the status for this span
@@ -137,12 +132,17 @@ class SpanData final : public Recordable
   std::chrono::nanoseconds GetDuration() const noexcept { return duration_; }
 
   /**
-   * Get the attributes for this span
+   * Get the attributes for this span. Borrowed attributes that haven't been materialized are
+   * copied into the result, ahead of the other attributes.
    * @return the attributes for this span
    */
-  const std::unordered_map<std::string, SpanDataAttributeValue> &GetAttributes() const noexcept
+  const FlatAttributeMap GetAttributes() const noexcept
   {
-    return attribute_map_.GetAttributes();
+    if (borrowed_attributes_.empty())
+    {
+      return attributes_;
+    }
+    return MergeBorrowedAttributes();
   }
 
   /**
@@ -169,14 +169,47 @@ class SpanData final : public Recordable
   void SetAttribute(nostd::string_view key,
                     const opentelemetry::common::AttributeValue &value) noexcept override
   {
-    attribute_map_.SetAttribute(key, value);
+    // Replacing a borrowed attribute keeps its position among the attributes
+    if (FindBorrowedAttribute(key) != borrowed_attributes_.end())
+    {
+      Materialize();
+    }
+    attributes_[key] = nostd::visit(AttributeConverter(), value);
+  }
+
+  void SetBorrowedAttribute(nostd::string_view key,
+                            const opentelemetry::common::AttributeValue &value) noexcept override
+  {
+    // Borrowed attributes go ahead of the owned ones, so only borrow while there are none
+    if (!attributes_.empty())
+    {
+      SetAttribute(key, value);
+      return;
+    }
+    auto borrowed = FindBorrowedAttribute(key);
+    if (borrowed != borrowed_attributes_.end())
+    {
+      borrowed->second = value;
+      return;
+    }
+    borrowed_attributes_.emplace_back(key, value);
+  }
+
+  void Materialize() noexcept override
+  {
+    if (borrowed_attributes_.empty())
+    {
+      return;
+    }
+    attributes_ = MergeBorrowedAttributes();
+    borrowed_attributes_.clear();
   }
 
   void AddEvent(nostd::string_view name,
                 core::SystemTimestamp timestamp,
                 const trace_api::KeyValueIterable &attributes) noexcept override
   {
-    SpanDataEvent event(std::string(name), timestamp, attributes);
+    SpanDataEvent event(name, timestamp, attributes);
     events_.push_back(event);
   }
 
@@ -187,13 +220,18 @@ class SpanData final : public Recordable
     links_.push_back(link);
   }
 
+  bool HasErrorStatus() const noexcept override
+  {
+    return status_code_ != opentelemetry::trace::CanonicalCode::OK;
+  }
+
   void SetStatus(trace_api::CanonicalCode code, nostd::string_view description) noexcept override
   {
     status_code_ = code;
-    status_desc_ = std::string(description);
+    status_desc_.assign(description.data(), description.size());
   }
 
-  void SetName(nostd::string_view name) noexcept override { name_ = std::string(name); }
+  void SetName(nostd::string_view name) noexcept override { name_.Assign(name); }
 
   void SetStartTime(opentelemetry::core::SystemTimestamp start_time) noexcept override
   {
@@ -202,18 +240,61 @@ class SpanData final : public Recordable
 
   void SetDuration(std::chrono::nanoseconds duration) noexcept override { duration_ = duration; }
 
+  bool Reset() noexcept override
+  {
+    trace_id_       = opentelemetry::trace::TraceId();
+    span_id_        = opentelemetry::trace::SpanId();
+    parent_span_id_ = opentelemetry::trace::SpanId();
+    start_time_     = core::SystemTimestamp();
+    duration_       = std::chrono::nanoseconds(0);
+    status_code_    = opentelemetry::trace::CanonicalCode::OK;
+    // clear() keeps the capacity of the strings and vectors for the next span
+    name_.clear();
+    status_desc_.clear();
+    attributes_.clear();
+    borrowed_attributes_.clear();
+    events_.clear();
+    links_.clear();
+    return true;
+  }
+
 private:
   opentelemetry::trace::TraceId trace_id_;
   opentelemetry::trace::SpanId span_id_;
   opentelemetry::trace::SpanId parent_span_id_;
   core::SystemTimestamp start_time_;
   std::chrono::nanoseconds duration_{0};
-  std::string name_;
+  sdk::common::InternedString name_;
   opentelemetry::trace::CanonicalCode status_code_{opentelemetry::trace::CanonicalCode::OK};
   std::string status_desc_;
-  AttributeMap attribute_map_;
+  FlatAttributeMap attributes_;
+  // Attributes set ahead of attributes_ whose keys and values are still owned by the caller
+  using BorrowedAttribute = std::pair<nostd::string_view, opentelemetry::common::AttributeValue>;
+  std::vector<BorrowedAttribute> borrowed_attributes_;
   std::vector<SpanDataEvent> events_;
   std::vector<SpanDataLink> links_;
+
+  std::vector<BorrowedAttribute>::iterator FindBorrowedAttribute(nostd::string_view key) noexcept
+  {
+    return std::find_if(borrowed_attributes_.begin(), borrowed_attributes_.end(),
+                        [key](const BorrowedAttribute &kv) { return kv.first == key; });
+  }
+
+  // Copy the borrowed attributes, followed by the owned ones
+  FlatAttributeMap MergeBorrowedAttributes() const noexcept
+  {
+    FlatAttributeMap result;
+    result.reserve(borrowed_attributes_.size() + attributes_.size());
+    for (auto &kv : borrowed_attributes_)
+    {
+      result[kv.first] = nostd::visit(AttributeConverter(), kv.second);
+    }
+    for (auto &kv : attributes_)
+    {
+      result[kv.first] = kv.second;
+    }
+    return result;
+  }
 };
 }  // namespace trace
 }  // namespace sdk
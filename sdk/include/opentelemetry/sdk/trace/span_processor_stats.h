@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "opentelemetry/sdk/common/sharded_counter.h"
+#include "opentelemetry/sdk/common/sharded_histogram.h"
+#include "opentelemetry/sdk/trace/exporter.h"
+
+OPENTELEMETRY_BEGIN_NAMESPACE
+namespace sdk
+{
+namespace trace
+{
+/**
+ * A snapshot of a span processor's statistics.
+ */
+struct SpanProcessorStats
+{
+  /* The number of ended spans passed to the processor. */
+  uint64_t spans_received = 0;
+
+  /* The number of spans dropped because the queue was full. */
+  uint64_t spans_dropped = 0;
+
+  /* The number of spans the exporter exported successfully. */
+  uint64_t spans_exported = 0;
+
+  /* The number of spans in batches that the exporter failed to export. */
+  uint64_t spans_failed = 0;
+
+  /* The largest number of spans queued at once. */
+  uint64_t queue_high_water_mark = 0;
+
+  /* The number of spans in each exported batch. */
+  common::HistogramSnapshot batch_sizes;
+
+  /* The time each export took, in microseconds. */
+  common::HistogramSnapshot export_durations_us;
+};
+
+/**
+ * Records a span processor's statistics. Recording is lock-free, and the
+ * counters recorded from the threads that end spans are sharded by thread, so
+ * that recording costs a relaxed increment of a cache line the thread usually
+ * owns already.
+ */
+class SpanProcessorStatsRecorder
+{
+public:
+  void RecordReceived(uint64_t n) noexcept { spans_received_.Add(n); }
+
+  void RecordDropped(uint64_t n) noexcept { spans_dropped_.Add(n); }
+
+  /**
+   * Record the number of spans currently queued.
+   */
+  void RecordQueueSize(uint64_t size) noexcept
+  {
+    auto high_water_mark = queue_high_water_mark_.load(std::memory_order_relaxed);
+    while (size > high_water_mark &&
+           !queue_high_water_mark_.compare_exchange_weak(high_water_mark, size,
+                                                         std::memory_order_relaxed))
+    {
+    }
+  }
+
+  /**
+   * Record the outcome of passing a batch of spans to the exporter.
+   */
+  void RecordExport(size_t batch_size,
+                    ExportResult result,
+                    std::chrono::microseconds duration) noexcept
+  {
+    if (result == ExportResult::kSuccess)
+    {
+      spans_exported_.Add(batch_size);
+    }
+    else
+    {
+      spans_failed_.Add(batch_size);
+    }
+    batch_sizes_.Record(batch_size);
+    export_durations_us_.Record(static_cast<uint64_t>(duration.count()));
+  }
+
+  /**
+   * @return the number of spans dropped so far.
+   */
+  uint64_t GetDroppedCount() const noexcept { return spans_dropped_.Value(); }
+
+  /**
+   * @return a snapshot of the statistics recorded so far. Statistics recorded
+   * concurrently may be missing from it.
+   */
+  SpanProcessorStats GetStats() const noexcept
+  {
+    SpanProcessorStats stats;
+    stats.spans_received        = spans_received_.Value();
+    stats.spans_dropped         = spans_dropped_.Value();
+    stats.spans_exported        = spans_exported_.Value();
+    stats.spans_failed          = spans_failed_.Value();
+    stats.queue_high_water_mark = queue_high_water_mark_.load(std::memory_order_relaxed);
+    stats.batch_sizes           = batch_sizes_.GetSnapshot();
+    stats.export_durations_us   = export_durations_us_.GetSnapshot();
+    return stats;
+  }
+
+private:
+  common::ShardedCounter spans_received_;
+  common::ShardedCounter spans_dropped_;
+  common::ShardedCounter spans_exported_;
+  common::ShardedCounter spans_failed_;
+  std::atomic<uint64_t> queue_high_water_mark_{0};
+  common::ShardedHistogram batch_sizes_;
+  common::ShardedHistogram export_durations_us_;
+};
+}  // namespace trace
+}  // namespace sdk
+OPENTELEMETRY_END_NAMESPACE
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "opentelemetry/nostd/span.h"
 #include "opentelemetry/sdk/common/atomic_shared_ptr.h"
 #include "opentelemetry/sdk/trace/processor.h"
 #include "opentelemetry/sdk/trace/samplers/always_on.h"
@@ -49,13 +50,53 @@ class Tracer final : public trace_api::Tracer, public std::enable_shared_from_th
       const trace_api::KeyValueIterable &attributes,
       const trace_api::StartSpanOptions &options = {}) noexcept override;
 
+  /**
+   * Start a span without copying its initial attributes. The span's recordable refers to the
+   * keys and values in attributes, and only copies them if a span processor keeps it after the
+   * span has ended.
+   *
+   * The caller must keep everything attributes refers to valid until the span has ended.
+   */
+  nostd::shared_ptr<trace_api::Span> StartSpanBorrowingAttributes(
+      nostd::string_view name,
+      const trace_api::KeyValueIterable &attributes,
+      const trace_api::StartSpanOptions &options = {}) noexcept;
+
+  /**
+   * Start sibling spans with the same name, attributes and options, one for each element of
+   * spans. The spans are sampled together and share a single allocation. Unlike StartSpan, this
+   * doesn't make the spans active in the runtime context.
+   * @param spans receives the started spans
+   */
+  void StartSpans(nostd::string_view name,
+                  const trace_api::KeyValueIterable &attributes,
+                  const nostd::span<nostd::shared_ptr<trace_api::Span>> &spans,
+                  const trace_api::StartSpanOptions &options = {}) noexcept;
+
+  /**
+   * End spans with the same options, handing the recordables of spans started by this tracer to
+   * their span processor together. Other spans are ended one by one.
+   * @param spans the spans to end; null elements are skipped
+   */
+  void EndSpans(const nostd::span<nostd::shared_ptr<trace_api::Span>> &spans,
+                const trace_api::EndSpanOptions &options = {}) noexcept;
+
   void ForceFlushWithMicroseconds(uint64_t timeout) noexcept override;
 
   void CloseWithMicroseconds(uint64_t timeout) noexcept override;
 
 private:
+  nostd::shared_ptr<trace_api::Span> DoStartSpan(nostd::string_view name,
+                                                 const trace_api::KeyValueIterable &attributes,
+                                                 const trace_api::StartSpanOptions &options,
+                                                 bool borrow_attributes) noexcept;
+
   opentelemetry::sdk::AtomicSharedPtr<SpanProcessor> processor_;
   const std::shared_ptr<Sampler> sampler_;
+
+  // Returned for every span that isn't sampled. Handed out through shared pointers that share
+  // ownership of the tracer, so that dropping a span doesn't allocate.
+  const std::unique_ptr<trace_api::Span> non_recording_span_;
 };
 }  // namespace trace
 }  // namespace sdk
@@ -1,4 +1,7 @@
 #include "opentelemetry/sdk/metrics/meter.h"
+
+#include <iterator>
+
 OPENTELEMETRY_BEGIN_NAMESPACE
 namespace sdk
 {
@@ -18,8 +21,8 @@ nostd::shared_ptr<metrics_api::Counter<short>> Meter::NewShortCounter(
     std::terminate();
 #endif
   }
-  auto counter = new Counter<short>(name, description, unit, enabled);
-  auto ptr     = std::shared_ptr<metrics_api::Counter<short>>(counter);
+  auto counter = new Counter<short>(name, description, unit, enabled, IsStriped(name));
+  auto ptr     = std::shared_ptr<Counter<short>>(counter);
   metrics_lock_.lock();
   short_metrics_.insert(std::make_pair(std::string(name), ptr));
   metrics_lock_.unlock();
@@ -39,8 +42,8 @@ nostd::shared_ptr<metrics_api::Counter<int>> Meter::NewIntCounter(nostd::string_
     std::terminate();
 #endif
   }
-  auto counter = new Counter<int>(name, description, unit, enabled);
-  auto ptr     = std::shared_ptr<metrics_api::Counter<int>>(counter);
+  auto counter = new Counter<int>(name, description, unit, enabled, IsStriped(name));
+  auto ptr     = std::shared_ptr<Counter<int>>(counter);
   metrics_lock_.lock();
   int_metrics_.insert(std::make_pair(std::string(name), ptr));
   metrics_lock_.unlock();
@@ -61,8 +64,8 @@ nostd::shared_ptr<metrics_api::Counter<float>> Meter::NewFloatCounter(
     std::terminate();
 #endif
   }
-  auto counter = new Counter<float>(name, description, unit, enabled);
-  auto ptr     = std::shared_ptr<metrics_api::Counter<float>>(counter);
+  auto counter = new Counter<float>(name, description, unit, enabled, IsStriped(name));
+  auto ptr     = std::shared_ptr<Counter<float>>(counter);
   metrics_lock_.lock();
   float_metrics_.insert(std::make_pair(std::string(name), ptr));
   metrics_lock_.unlock();
@@ -83,8 +86,8 @@ nostd::shared_ptr<metrics_api::Counter<double>> Meter::NewDoubleCounter(
     std::terminate();
 #endif
   }
-  auto counter = new Counter<double>(name, description, unit, enabled);
-  auto ptr     = std::shared_ptr<metrics_api::Counter<double>>(counter);
+  auto counter = new Counter<double>(name, description, unit, enabled, IsStriped(name));
+  auto ptr     = std::shared_ptr<Counter<double>>(counter);
   metrics_lock_.lock();
   double_metrics_.insert(std::make_pair(std::string(name), ptr));
   metrics_lock_.unlock();
@@ -105,8 +108,8 @@ nostd::shared_ptr<metrics_api::UpDownCounter<short>> Meter::NewShortUpDownCounte
     std::terminate();
 #endif
   }
-  auto udcounter = new UpDownCounter<short>(name, description, unit, enabled);
-  auto ptr       = std::shared_ptr<metrics_api::UpDownCounter<short>>(udcounter);
+  auto udcounter = new UpDownCounter<short>(name, description, unit, enabled, IsStriped(name));
+  auto ptr       = std::shared_ptr<UpDownCounter<short>>(udcounter);
   metrics_lock_.lock();
   short_metrics_.insert(std::make_pair(std::string(name), ptr));
   metrics_lock_.unlock();
@@ -127,8 +130,8 @@ nostd::shared_ptr<metrics_api::UpDownCounter<int>> Meter::NewIntUpDownCounter(
     std::terminate();
 #endif
   }
-  auto udcounter = new UpDownCounter<int>(name, description, unit, enabled);
-  auto ptr       = std::shared_ptr<metrics_api::UpDownCounter<int>>(udcounter);
+  auto udcounter = new UpDownCounter<int>(name, description, unit, enabled, IsStriped(name));
+  auto ptr       = std::shared_ptr<UpDownCounter<int>>(udcounter);
   metrics_lock_.lock();
   int_metrics_.insert(std::make_pair(std::string(name), ptr));
   metrics_lock_.unlock();
@@ -149,8 +152,8 @@ nostd::shared_ptr<metrics_api::UpDownCounter<float>> Meter::NewFloatUpDownCounte
     std::terminate();
 #endif
   }
-  auto udcounter = new UpDownCounter<float>(name, description, unit, enabled);
-  auto ptr       = std::shared_ptr<metrics_api::UpDownCounter<float>>(udcounter);
+  auto udcounter = new UpDownCounter<float>(name, description, unit, enabled, IsStriped(name));
+  auto ptr       = std::shared_ptr<UpDownCounter<float>>(udcounter);
   metrics_lock_.lock();
   float_metrics_.insert(std::make_pair(std::string(name), ptr));
   metrics_lock_.unlock();
@@ -171,8 +174,8 @@ nostd::shared_ptr<metrics_api::UpDownCounter<double>> Meter::NewDoubleUpDownCoun
     std::terminate();
 #endif
   }
-  auto udcounter = new UpDownCounter<double>(name, description, unit, enabled);
-  auto ptr       = std::shared_ptr<metrics_api::UpDownCounter<double>>(udcounter);
+  auto udcounter = new UpDownCounter<double>(name, description, unit, enabled, IsStriped(name));
+  auto ptr       = std::shared_ptr<UpDownCounter<double>>(udcounter);
   metrics_lock_.lock();
   double_metrics_.insert(std::make_pair(std::string(name), ptr));
   metrics_lock_.unlock();
@@ -194,7 +197,7 @@ nostd::shared_ptr<metrics_api::ValueRecorder<short>> Meter::NewShortValueRecorde
 #endif
   }
   auto recorder = new ValueRecorder<short>(name, description, unit, enabled);
-  auto ptr      = std::shared_ptr<metrics_api::ValueRecorder<short>>(recorder);
+  auto ptr      = std::shared_ptr<ValueRecorder<short>>(recorder);
   metrics_lock_.lock();
   short_metrics_.insert(std::make_pair(std::string(name), ptr));
   metrics_lock_.unlock();
@@ -216,7 +219,7 @@ nostd::shared_ptr<metrics_api::ValueRecorder<int>> Meter::NewIntValueRecorder(
 #endif
   }
   auto recorder = new ValueRecorder<int>(name, description, unit, enabled);
-  auto ptr      = std::shared_ptr<metrics_api::ValueRecorder<int>>(recorder);
+  auto ptr      = std::shared_ptr<ValueRecorder<int>>(recorder);
   metrics_lock_.lock();
   int_metrics_.insert(std::make_pair(std::string(name), ptr));
   metrics_lock_.unlock();
@@ -238,7 +241,7 @@ nostd::shared_ptr<metrics_api::ValueRecorder<float>> Meter::NewFloatValueRecorde
 #endif
   }
   auto recorder = new ValueRecorder<float>(name, description, unit, enabled);
-  auto ptr      = std::shared_ptr<metrics_api::ValueRecorder<float>>(recorder);
+  auto ptr      = std::shared_ptr<ValueRecorder<float>>(recorder);
   metrics_lock_.lock();
   float_metrics_.insert(std::make_pair(std::string(name), ptr));
   metrics_lock_.unlock();
@@ -260,7 +263,7 @@ nostd::shared_ptr<metrics_api::ValueRecorder<double>> Meter::NewDoubleValueRecor
 #endif
   }
   auto recorder = new ValueRecorder<double>(name, description, unit, enabled);
-  auto ptr      = std::shared_ptr<metrics_api::ValueRecorder<double>>(recorder);
+  auto ptr      = std::shared_ptr<ValueRecorder<double>>(recorder);
   metrics_lock_.lock();
   double_metrics_.insert(std::make_pair(std::string(name), ptr));
   metrics_lock_.unlock();
@@ -283,7 +286,7 @@ nostd::shared_ptr<metrics_api::SumObserver<short>> Meter::NewShortSumObserver(
 #endif
   }
   auto sumobs = new SumObserver<short>(name, description, unit, enabled, callback);
-  auto ptr    = std::shared_ptr<metrics_api::SumObserver<short>>(sumobs);
+  auto ptr    = std::shared_ptr<SumObserver<short>>(sumobs);
   observers_lock_.lock();
   short_observers_.insert(std::make_pair(std::string(name), ptr));
   observers_lock_.unlock();
@@ -306,7 +309,7 @@ nostd::shared_ptr<metrics_api::SumObserver<int>> Meter::NewIntSumObserver(
 #endif
   }
   auto sumobs = new SumObserver<int>(name, description, unit, enabled, callback);
-  auto ptr    = std::shared_ptr<metrics_api::SumObserver<int>>(sumobs);
+  auto ptr    = std::shared_ptr<SumObserver<int>>(sumobs);
   observers_lock_.lock();
   int_observers_.insert(std::make_pair(std::string(name), ptr));
   observers_lock_.unlock();
@@ -329,7 +332,7 @@ nostd::shared_ptr<metrics_api::SumObserver<float>> Meter::NewFloatSumObserver(
 #endif
   }
   auto sumobs = new SumObserver<float>(name, description, unit, enabled, callback);
-  auto ptr    = std::shared_ptr<metrics_api::SumObserver<float>>(sumobs);
+  auto ptr    = std::shared_ptr<SumObserver<float>>(sumobs);
   observers_lock_.lock();
   float_observers_.insert(std::make_pair(std::string(name), ptr));
   observers_lock_.unlock();
@@ -352,7 +355,7 @@ nostd::shared_ptr<metrics_api::SumObserver<double>> Meter::NewDoubleSumObserver(
 #endif
   }
   auto sumobs = new SumObserver<double>(name, description, unit, enabled, callback);
-  auto ptr    = std::shared_ptr<metrics_api::SumObserver<double>>(sumobs);
+  auto ptr    = std::shared_ptr<SumObserver<double>>(sumobs);
   observers_lock_.lock();
   double_observers_.insert(std::make_pair(std::string(name), ptr));
   observers_lock_.unlock();
@@ -375,7 +378,7 @@ nostd::shared_ptr<metrics_api::UpDownSumObserver<short>> Meter::NewShortUpDownSu
 #endif
   }
   auto sumobs = new UpDownSumObserver<short>(name, description, unit, enabled, callback);
-  auto ptr    = std::shared_ptr<metrics_api::UpDownSumObserver<short>>(sumobs);
+  auto ptr    = std::shared_ptr<UpDownSumObserver<short>>(sumobs);
   observers_lock_.lock();
   short_observers_.insert(std::make_pair(std::string(name), ptr));
   observers_lock_.unlock();
@@ -398,7 +401,7 @@ nostd::shared_ptr<metrics_api::UpDownSumObserver<int>> Meter::NewIntUpDownSumObs
 #endif
   }
   auto sumobs = new UpDownSumObserver<int>(name, description, unit, enabled, callback);
-  auto ptr    = std::shared_ptr<metrics_api::UpDownSumObserver<int>>(sumobs);
+  auto ptr    = std::shared_ptr<UpDownSumObserver<int>>(sumobs);
   observers_lock_.lock();
   int_observers_.insert(std::make_pair(std::string(name), ptr));
   observers_lock_.unlock();
@@ -421,7 +424,7 @@ nostd::shared_ptr<metrics_api::UpDownSumObserver<float>> Meter::NewFloatUpDownSu
 #endif
   }
   auto sumobs = new UpDownSumObserver<float>(name, description, unit, enabled, callback);
-  auto ptr    = std::shared_ptr<metrics_api::UpDownSumObserver<float>>(sumobs);
+  auto ptr    = std::shared_ptr<UpDownSumObserver<float>>(sumobs);
   observers_lock_.lock();
   float_observers_.insert(std::make_pair(std::string(name), ptr));
   observers_lock_.unlock();
@@ -444,7 +447,7 @@ nostd::shared_ptr<metrics_api::UpDownSumObserver<double>> Meter::NewDoubleUpDown
 #endif
   }
   auto sumobs = new UpDownSumObserver<double>(name, description, unit, enabled, callback);
-  auto ptr    = std::shared_ptr<metrics_api::UpDownSumObserver<double>>(sumobs);
+  auto ptr    = std::shared_ptr<UpDownSumObserver<double>>(sumobs);
   observers_lock_.lock();
   double_observers_.insert(std::make_pair(std::string(name), ptr));
   observers_lock_.unlock();
@@ -467,7 +470,7 @@ nostd::shared_ptr<metrics_api::ValueObserver<short>> Meter::NewShortValueObserve
 #endif
   }
   auto sumobs = new ValueObserver<short>(name, description, unit, enabled, callback);
-  auto ptr    = std::shared_ptr<metrics_api::ValueObserver<short>>(sumobs);
+  auto ptr    = std::shared_ptr<ValueObserver<short>>(sumobs);
   observers_lock_.lock();
   short_observers_.insert(std::make_pair(std::string(name), ptr));
   observers_lock_.unlock();
@@ -490,7 +493,7 @@ nostd::shared_ptr<metrics_api::ValueObserver<int>> Meter::NewIntValueObserver(
 #endif
   }
   auto sumobs = new ValueObserver<int>(name, description, unit, enabled, callback);
-  auto ptr    = std::shared_ptr<metrics_api::ValueObserver<int>>(sumobs);
+  auto ptr    = std::shared_ptr<ValueObserver<int>>(sumobs);
   observers_lock_.lock();
   int_observers_.insert(std::make_pair(std::string(name), ptr));
   observers_lock_.unlock();
@@ -513,7 +516,7 @@ nostd::shared_ptr<metrics_api::ValueObserver<float>> Meter::NewFloatValueObserve
 #endif
   }
   auto sumobs = new ValueObserver<float>(name, description, unit, enabled, callback);
-  auto ptr    = std::shared_ptr<metrics_api::ValueObserver<float>>(sumobs);
+  auto ptr    = std::shared_ptr<ValueObserver<float>>(sumobs);
   observers_lock_.lock();
   float_observers_.insert(std::make_pair(std::string(name), ptr));
   observers_lock_.unlock();
@@ -536,7 +539,7 @@ nostd::shared_ptr<metrics_api::ValueObserver<double>> Meter::NewDoubleValueObser
 #endif
   }
   auto sumobs = new ValueObserver<double>(name, description, unit, enabled, callback);
-  auto ptr    = std::shared_ptr<metrics_api::ValueObserver<double>>(sumobs);
+  auto ptr    = std::shared_ptr<ValueObserver<double>>(sumobs);
   observers_lock_.lock();
   double_observers_.insert(std::make_pair(std::string(name), ptr));
   observers_lock_.unlock();
@@ -591,7 +594,6 @@ std::vector<Record> Meter::Collect() noexcept
   return records;
 }
 
-// Must cast to sdk::SynchronousInstrument to have access to GetRecords() function
 void Meter::CollectMetrics(std::vector<Record> &records)
 {
   metrics_lock_.lock();
@@ -648,8 +650,7 @@ void Meter::CollectMetrics(std::vector<Record> &records)
 
 template <typename T>
 void Meter::CollectSingleSyncInstrument(
-    typename std::map<std::string, std::shared_ptr<metrics_api::SynchronousInstrument<T>>>::iterator
-        i,
+    typename std::map<std::string, std::shared_ptr<SynchronousInstrument<T>>>::iterator i,
     std::vector<Record> &records)
 {
   if (!i->second->IsEnabled())
@@ -657,9 +658,9 @@ void Meter::CollectSingleSyncInstrument(
     i++;
     return;
   }
-  auto cast_ptr                   = std::dynamic_pointer_cast<SynchronousInstrument<T>>(i->second);
-  std::vector<Record> new_records = cast_ptr->GetRecords();
-  records.insert(records.begin(), new_records.begin(), new_records.end());
+  std::vector<Record> new_records = i->second->GetRecords();
+  records.insert(records.begin(), std::make_move_iterator(new_records.begin()),
+                 std::make_move_iterator(new_records.end()));
 }
 
 void Meter::CollectObservers(std::vector<Record> &records)
@@ -718,8 +719,7 @@ void Meter::CollectObservers(std::vector<Record> &records)
 
 template <typename T>
 void Meter::CollectSingleAsyncInstrument(
-    typename std::map<std::string,
-                      std::shared_ptr<metrics_api::AsynchronousInstrument<T>>>::iterator i,
+    typename std::map<std::string, std::shared_ptr<AsynchronousInstrument<T>>>::iterator i,
     std::vector<Record> &records)
 {
   if (!i->second->IsEnabled())
@@ -727,9 +727,9 @@ void Meter::CollectSingleAsyncInstrument(
     i++;
     return;
   }
-  auto cast_ptr                   = std::dynamic_pointer_cast<AsynchronousInstrument<T>>(i->second);
-  std::vector<Record> new_records = cast_ptr->GetRecords();
-  records.insert(records.begin(), new_records.begin(), new_records.end());
+  std::vector<Record> new_records = i->second->GetRecords();
+  records.insert(records.begin(), std::make_move_iterator(new_records.begin()),
+                 std::make_move_iterator(new_records.end()));
 }
 
 bool Meter::IsValidName(nostd::string_view name)
@@ -747,6 +747,18 @@ bool Meter::IsValidName(nostd::string_view name)
   return true;
 }
 
+void Meter::EnableStripedAggregation(nostd::string_view name)
+{
+  std::lock_guard<std::mutex> lg_metrics(metrics_lock_);
+  striped_names_.insert(std::string(name));
+}
+
+bool Meter::IsStriped(nostd::string_view name)
+{
+  std::lock_guard<std::mutex> lg_metrics(metrics_lock_);
+  return striped_names_.find(std::string(name)) != striped_names_.end();
+}
+
 bool Meter::NameAlreadyUsed(nostd::string_view name)
 {
   std::lock_guard<std::mutex> lg_metrics(metrics_lock_);
@@ -25,7 +25,7 @@ std::vector<sdkmetrics::Record> UngroupedMetricsProcessor::CheckpointSelf() noex
   {
     // Create a record from the held KeyStruct values and add to the Checkpoint
     KeyStruct key = iter.first;
-    sdkmetrics::Record r{key.name, key.description, key.labels, iter.second};
+    sdkmetrics::Record r{key.name, key.description, key.labels, key.label_set, iter.second};
 
     metric_records.push_back(r);
   }
@@ -52,7 +52,8 @@ void UngroupedMetricsProcessor::process(sdkmetrics::Record record) noexcept
   std::string name        = record.GetName();
   std::string description = record.GetDescription();
 
-  KeyStruct batch_key = KeyStruct(name, description, label, get_instrument(aggregator));
+  KeyStruct batch_key =
+      KeyStruct(name, description, label, get_instrument(aggregator), record.GetLabelSet());
 
   /**
    * If we have already seen this aggregator then we will merge it with the copy that exists in the
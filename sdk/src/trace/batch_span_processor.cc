@@ -1,29 +1,93 @@
 #include "opentelemetry/sdk/trace/batch_span_processor.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <vector>
 using opentelemetry::sdk::common::AtomicUniquePtr;
 using opentelemetry::sdk::common::CircularBuffer;
 using opentelemetry::sdk::common::CircularBufferRange;
+using opentelemetry::sdk::common::ObjectPool;
 
 OPENTELEMETRY_BEGIN_NAMESPACE
 namespace sdk
 {
 namespace trace
 {
+namespace
+{
+BatchSpanProcessorOptions MakeOptions(const size_t max_queue_size,
+                                      const std::chrono::milliseconds schedule_delay_millis,
+                                      const size_t max_export_batch_size)
+{
+  BatchSpanProcessorOptions options;
+  options.max_queue_size        = max_queue_size;
+  options.schedule_delay_millis = schedule_delay_millis;
+  options.max_export_batch_size = max_export_batch_size;
+  return options;
+}
+}  // namespace
+
 BatchSpanProcessor::BatchSpanProcessor(std::unique_ptr<SpanExporter> &&exporter,
                                        const size_t max_queue_size,
                                        const std::chrono::milliseconds schedule_delay_millis,
                                        const size_t max_export_batch_size)
-    : exporter_(std::move(exporter)),
-      max_queue_size_(max_queue_size),
-      schedule_delay_millis_(schedule_delay_millis),
-      max_export_batch_size_(max_export_batch_size),
-      buffer_(max_queue_size_),
-      worker_thread_(&BatchSpanProcessor::DoBackgroundWork, this)
+    : BatchSpanProcessor(std::move(exporter),
+                         MakeOptions(max_queue_size, schedule_delay_millis, max_export_batch_size))
 {}
 
+BatchSpanProcessor::BatchSpanProcessor(std::unique_ptr<SpanExporter> &&exporter,
+                                       const BatchSpanProcessorOptions &options)
+    : exporter_(std::move(exporter)),
+      max_queue_size_(options.max_queue_size),
+      schedule_delay_millis_(options.schedule_delay_millis),
+      max_export_batch_size_(options.max_export_batch_size),
+      adaptive_scheduling_(options.adaptive_scheduling),
+      min_export_batch_size_(std::min(options.min_export_batch_size, max_export_batch_size_)),
+      min_schedule_delay_millis_(
+          std::min(options.min_schedule_delay_millis, schedule_delay_millis_)),
+      target_drop_ratio_(options.target_drop_ratio),
+      export_batch_size_(max_export_batch_size_),
+      schedule_delay_millis_count_(schedule_delay_millis_.count()),
+      last_update_time_(std::chrono::steady_clock::now()),
+      overflow_policy_(options.overflow_policy),
+      buffer_(max_queue_size_, options.num_queue_shards),
+      max_in_flight_batches_(options.max_in_flight_batches > 0 ? options.max_in_flight_batches
+                                                                 : 1)
+{
+  wake_threshold_ = buffer_.GetShard(0).max_size() / 2;
+  if (options.priority_queue_size > 0)
+  {
+    priority_buffer_.reset(new CircularBuffer<Recordable>{options.priority_queue_size});
+  }
+  if (options.recordable_pool_size > 0)
+  {
+    recordable_pool_.reset(new ObjectPool<Recordable>{options.recordable_pool_size});
+  }
+
+  // Start the export threads first, so that the worker thread sees all of them.
+  size_t num_export_threads = options.num_export_threads;
+  if (num_export_threads > 1 && exporter_->SupportsConcurrentExport() == false)
+  {
+    num_export_threads = 1;
+  }
+  for (size_t i = 0; i < num_export_threads; ++i)
+  {
+    export_threads_.emplace_back(&BatchSpanProcessor::DoExportWork, this);
+  }
+  worker_thread_ = std::thread(&BatchSpanProcessor::DoBackgroundWork, this);
+}
+
 std::unique_ptr<Recordable> BatchSpanProcessor::MakeRecordable() noexcept
 {
+  if (recordable_pool_ != nullptr)
+  {
+    auto recordable = recordable_pool_->Get();
+    if (recordable != nullptr)
+    {
+      return recordable;
+    }
+  }
   return exporter_->MakeRecordable();
 }
 
@@ -38,56 +102,183 @@ void BatchSpanProcessor::OnEnd(std::unique_ptr<Recordable> &&span) noexcept
   {
     return;
   }
+  stats_.RecordReceived(1);
+
+  // The span is exported after the caller's borrowed attributes may be gone.
+  span->Materialize();
 
-  if (buffer_.Add(span) == false)
+  // Only look at the shard this thread produces into, so that checking the
+  // fill level doesn't touch the other producers' cache lines.
+  auto &shard = buffer_.GetShard();
+  if (Enqueue(span, shard) == false)
   {
     return;
   }
 
-  // If the queue gets at least half full a preemptive notification is
-  // sent to the worker thread to start a new export cycle.
-  if (buffer_.size() >= max_queue_size_ / 2)
+  // If the queue fills up to the wake threshold (half full, unless adaptive
+  // scheduling picked a smaller batch) a preemptive notification is sent to
+  // the worker thread to start a new export cycle.
+  if (ShouldWakeWorker(shard))
   {
     // signal the worker thread
     cv_.notify_one();
   }
 }
 
-void BatchSpanProcessor::ForceFlush(std::chrono::microseconds timeout) noexcept
+void BatchSpanProcessor::OnEndBatch(const nostd::span<std::unique_ptr<Recordable>> &spans) noexcept
 {
   if (is_shutdown_.load() == true)
   {
     return;
   }
+  stats_.RecordReceived(spans.size());
+  for (auto &span : spans)
+  {
+    span->Materialize();
+  }
 
-  is_force_flush_ = true;
+  auto &shard = buffer_.GetShard();
+  if (overflow_policy_ == OverflowPolicy::kDropNewest && priority_buffer_ == nullptr)
+  {
+    auto num_added = shard.AddBatch(spans);
+    if (num_added < spans.size())
+    {
+      stats_.RecordDropped(spans.size() - num_added);
+      stats_.RecordQueueSize(QueueSize());
+    }
+  }
+  else
+  {
+    // Each span may go to a different queue or displace a queued one.
+    for (auto &span : spans)
+    {
+      Enqueue(span, shard);
+    }
+  }
 
-  // Keep attempting to wake up the worker thread
-  while (is_force_flush_.load() == true)
+  if (ShouldWakeWorker(shard))
   {
     cv_.notify_one();
   }
+}
 
-  // Now wait for the worker thread to signal back from the Export method
-  std::unique_lock<std::mutex> lk(force_flush_cv_m_);
-  while (is_force_flush_notified_.load() == false)
+bool BatchSpanProcessor::Enqueue(std::unique_ptr<Recordable> &span,
+                                 CircularBuffer<Recordable> &shard) noexcept
+{
+  if (priority_buffer_ != nullptr && span->HasErrorStatus() && priority_buffer_->Add(span))
   {
-    force_flush_cv_.wait(lk);
+    return true;
+  }
+  if (overflow_policy_ == OverflowPolicy::kDropNewest)
+  {
+    if (shard.Add(span) == false)
+    {
+      stats_.RecordDropped(1);
+      stats_.RecordQueueSize(QueueSize());
+      return false;
+    }
+    return true;
   }
 
-  // Notify the worker thread
-  is_force_flush_notified_ = false;
+  // Make room by replacing the oldest span. Replacing fails if the worker
+  // thread drained the shard meanwhile, in which case there's room again.
+  while (shard.Add(span) == false)
+  {
+    if (shard.ReplaceOldest(span))
+    {
+      span.reset();
+      stats_.RecordDropped(1);
+      stats_.RecordQueueSize(QueueSize());
+      return true;
+    }
+  }
+  return true;
+}
+
+bool BatchSpanProcessor::ShouldWakeWorker(const CircularBuffer<Recordable> &shard) const noexcept
+{
+  if (shard.size() >= wake_threshold_.load(std::memory_order_relaxed))
+  {
+    return true;
+  }
+  return priority_buffer_ != nullptr && priority_buffer_->empty() == false &&
+         priority_buffer_->size() >= priority_buffer_->max_size() / 2;
+}
+
+bool BatchSpanProcessor::IsBatchQueued() noexcept
+{
+  if (QueueSize() >= export_batch_size_.load(std::memory_order_relaxed))
+  {
+    return true;
+  }
+  for (size_t i = 0; i < buffer_.num_shards(); ++i)
+  {
+    if (ShouldWakeWorker(buffer_.GetShard(i)))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t BatchSpanProcessor::QueueSize() const noexcept
+{
+  size_t result = buffer_.size();
+  if (priority_buffer_ != nullptr)
+  {
+    result += priority_buffer_->size();
+  }
+  return result;
+}
+
+void BatchSpanProcessor::ForceFlush(std::chrono::microseconds timeout) noexcept
+{
+  if (is_shutdown_.load() == true)
+  {
+    return;
+  }
+
+  // Every call made before the worker thread picks up the request is served
+  // by the same export cycle.
+  uint64_t flush_seq;
+  {
+    std::lock_guard<std::mutex> lk(cv_m_);
+    flush_seq = ++flush_requested_seq_;
+  }
+  cv_.notify_one();
+
+  std::unique_lock<std::mutex> lk(force_flush_cv_m_);
+  auto is_flushed = [this, flush_seq] { return flush_completed_seq_ >= flush_seq; };
+  if (timeout <= std::chrono::microseconds::zero())
+  {
+    force_flush_cv_.wait(lk, is_flushed);
+  }
+  else
+  {
+    force_flush_cv_.wait_for(lk, timeout, is_flushed);
+  }
 }
 
 void BatchSpanProcessor::DoBackgroundWork()
 {
-  auto timeout = schedule_delay_millis_;
+  auto timeout         = std::chrono::milliseconds(schedule_delay_millis_count_.load());
+  uint64_t flushed_seq = 0;
 
   while (true)
   {
-    // Wait for `timeout` milliseconds
-    std::unique_lock<std::mutex> lk(cv_m_);
-    cv_.wait_for(lk, timeout);
+    uint64_t flush_seq;
+    {
+      // Wait for `timeout` milliseconds, unless enough spans are queued to
+      // wake the worker thread. Checking the same condition as the producers
+      // means a notification sent while the worker thread was exporting isn't
+      // lost. Shutdown and ForceFlush update their state under the lock, so
+      // their requests can't be missed here.
+      std::unique_lock<std::mutex> lk(cv_m_);
+      cv_.wait_for(lk, timeout, [this, flushed_seq] {
+        return is_shutdown_.load() || flush_requested_seq_ != flushed_seq || IsBatchQueued();
+      });
+      flush_seq = flush_requested_seq_;
+    }
 
     if (is_shutdown_.load() == true)
     {
@@ -95,23 +286,21 @@ void BatchSpanProcessor::DoBackgroundWork()
       return;
     }
 
-    bool was_force_flush_called = is_force_flush_.load();
+    UpdateSchedule(std::chrono::steady_clock::now());
+    const auto schedule_delay =
+        std::chrono::milliseconds(schedule_delay_millis_count_.load(std::memory_order_relaxed));
 
     // Check if this export was the result of a force flush.
-    if (was_force_flush_called == true)
-    {
-      // Since this export was the result of a force flush, signal the
-      // main thread that the worker thread has been notified
-      is_force_flush_ = false;
-    }
-    else
+    bool was_force_flush_called = flush_seq != flushed_seq;
+    if (was_force_flush_called == false)
     {
       // If the buffer was empty during the entire `timeout` time interval,
       // go back to waiting. If this was a spurious wake-up, we export only if
-      // `buffer_` is not empty. This is acceptable because batching is a best
+      // the queue is not empty. This is acceptable because batching is a best
       // mechanism effort here.
-      if (buffer_.empty() == true)
+      if (QueueSize() == 0)
       {
+        timeout = schedule_delay;
         continue;
       }
     }
@@ -121,8 +310,19 @@ void BatchSpanProcessor::DoBackgroundWork()
     auto end      = std::chrono::steady_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
 
+    // Wake up the ForceFlush calls this export was for.
+    if (was_force_flush_called == true)
+    {
+      {
+        std::lock_guard<std::mutex> lk(force_flush_cv_m_);
+        flush_completed_seq_ = flush_seq;
+      }
+      force_flush_cv_.notify_all();
+      flushed_seq = flush_seq;
+    }
+
     // Subtract the duration of this export call from the next `timeout`.
-    timeout = schedule_delay_millis_ - duration;
+    timeout = schedule_delay - duration;
   }
 }
 
@@ -130,44 +330,230 @@ void BatchSpanProcessor::Export(const bool was_force_flush_called)
 {
   std::vector<std::unique_ptr<Recordable>> spans_arr;
 
+  const size_t queue_size = QueueSize();
+  stats_.RecordQueueSize(queue_size);
   size_t num_spans_to_export;
 
   if (was_force_flush_called == true)
   {
-    num_spans_to_export = buffer_.size();
+    num_spans_to_export = queue_size;
   }
   else
   {
-    num_spans_to_export =
-        buffer_.size() >= max_export_batch_size_ ? max_export_batch_size_ : buffer_.size();
+    const size_t export_batch_size = export_batch_size_.load(std::memory_order_relaxed);
+    num_spans_to_export = queue_size >= export_batch_size ? export_batch_size : queue_size;
   }
+  spans_arr.reserve(num_spans_to_export);
 
-  buffer_.Consume(
-      num_spans_to_export, [&](CircularBufferRange<AtomicUniquePtr<Recordable>> range) noexcept {
-        range.ForEach([&](AtomicUniquePtr<Recordable> &ptr) {
-          std::unique_ptr<Recordable> swap_ptr = std::unique_ptr<Recordable>(nullptr);
-          ptr.Swap(swap_ptr);
-          spans_arr.push_back(std::unique_ptr<Recordable>(swap_ptr.release()));
-          return true;
-        });
-      });
+  auto take_spans = [&](CircularBufferRange<AtomicUniquePtr<Recordable>> range) noexcept {
+    range.ForEach([&](AtomicUniquePtr<Recordable> &ptr) {
+      std::unique_ptr<Recordable> swap_ptr = std::unique_ptr<Recordable>(nullptr);
+      ptr.Swap(swap_ptr);
+      spans_arr.push_back(std::unique_ptr<Recordable>(swap_ptr.release()));
+      return true;
+    });
+  };
 
-  exporter_->Export(nostd::span<std::unique_ptr<Recordable>>(spans_arr.data(), spans_arr.size()));
+  // Error spans go first, so that a backed-up main queue doesn't hold them back.
+  size_t num_priority_spans = 0;
+  if (priority_buffer_ != nullptr)
+  {
+    num_priority_spans = std::min(priority_buffer_->size(), num_spans_to_export);
+    priority_buffer_->Consume(num_priority_spans, take_spans);
+  }
+  buffer_.Consume(num_spans_to_export - num_priority_spans, take_spans);
 
-  // Notify the main thread in case this export was the result of a force flush.
-  if (was_force_flush_called == true)
+  if (export_threads_.empty())
+  {
+    ExportBatch(spans_arr);
+  }
+  else
+  {
+    if (spans_arr.empty() == false)
+    {
+      ScheduleBatch(std::move(spans_arr));
+    }
+    if (was_force_flush_called == true)
+    {
+      WaitForExports();
+    }
+  }
+}
+
+void BatchSpanProcessor::ExportBatch(std::vector<std::unique_ptr<Recordable>> &spans)
+{
+  nostd::span<std::unique_ptr<Recordable>> batch(spans.data(), spans.size());
+  auto start   = std::chrono::steady_clock::now();
+  auto result  = exporter_->Export(batch);
+  auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  stats_.RecordExport(spans.size(), result, latency);
+
+  // The recordables the exporter didn't take would be destroyed along with the batch; reuse them.
+  if (recordable_pool_ != nullptr)
+  {
+    for (auto &span : spans)
+    {
+      if (span != nullptr && span->Reset())
+      {
+        recordable_pool_->Put(span);
+      }
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lk(schedule_m_);
+    export_latency_ = export_latency_ == std::chrono::microseconds::zero()
+                          ? latency
+                          : (export_latency_ * 3 + latency) / 4;
+  }
+}
+
+void BatchSpanProcessor::DoExportWork()
+{
+  std::unique_lock<std::mutex> lk(export_m_);
+  while (true)
   {
-    is_force_flush_notified_ = true;
-    while (is_force_flush_notified_.load() == true)
+    export_cv_.wait(lk, [this] { return !pending_batches_.empty() || is_export_shutdown_; });
+
+    // Only stop once every pending batch has been exported.
+    if (pending_batches_.empty())
     {
-      force_flush_cv_.notify_one();
+      return;
     }
+    auto spans = std::move(pending_batches_.front());
+    pending_batches_.pop_front();
+
+    lk.unlock();
+    ExportBatch(spans);
+    spans.clear();
+    lk.lock();
+
+    --num_in_flight_batches_;
+    export_done_cv_.notify_all();
+  }
+}
+
+void BatchSpanProcessor::ScheduleBatch(std::vector<std::unique_ptr<Recordable>> &&spans)
+{
+  std::unique_lock<std::mutex> lk(export_m_);
+  export_done_cv_.wait(lk, [this] { return num_in_flight_batches_ < max_in_flight_batches_; });
+  pending_batches_.push_back(std::move(spans));
+  ++num_in_flight_batches_;
+  export_cv_.notify_one();
+}
+
+void BatchSpanProcessor::WaitForExports()
+{
+  std::unique_lock<std::mutex> lk(export_m_);
+  export_done_cv_.wait(lk, [this] { return num_in_flight_batches_ == 0; });
+}
+
+void BatchSpanProcessor::UpdateSchedule(std::chrono::steady_clock::time_point now)
+{
+  // The weight of the latest sample in the smoothed arrival rate.
+  const double kSmoothing = 0.25;
+
+  std::lock_guard<std::mutex> lk(schedule_m_);
+  auto elapsed =
+      std::chrono::duration_cast<std::chrono::duration<double>>(now - last_update_time_).count();
+  if (elapsed < 0.001)
+  {
+    // Too short an interval to measure a rate over.
+    return;
+  }
+
+  uint64_t production_count = buffer_.production_count();
+  if (priority_buffer_ != nullptr)
+  {
+    production_count += priority_buffer_->production_count();
+  }
+  const uint64_t num_dropped = stats_.GetDroppedCount();
+  const uint64_t num_added   = production_count - last_production_count_;
+  const uint64_t num_lost    = num_dropped - last_num_dropped_;
+  const uint64_t num_arrived = num_added + num_lost;
+  last_update_time_          = now;
+  last_production_count_     = production_count;
+  last_num_dropped_          = num_dropped;
+
+  const double rate = static_cast<double>(num_arrived) / elapsed;
+  if (arrival_rate_ == 0)
+  {
+    arrival_rate_ = rate;
+  }
+  else
+  {
+    arrival_rate_ = kSmoothing * rate + (1 - kSmoothing) * arrival_rate_;
+  }
+  drop_ratio_ =
+      num_arrived == 0 ? 0 : static_cast<double>(num_lost) / static_cast<double>(num_arrived);
+
+  if (!adaptive_scheduling_)
+  {
+    return;
+  }
+
+  // Collect about as many spans per batch as arrive within the longest delay.
+  const double max_delay = std::chrono::duration<double>(schedule_delay_millis_).count();
+  double batch_size      = arrival_rate_ * max_delay;
+
+  // Stay within the configured batch sizes.
+  batch_size = std::max(static_cast<double>(min_export_batch_size_),
+                        std::min(static_cast<double>(max_export_batch_size_), batch_size));
+
+  // Wait about as long as a batch takes to arrive, less the time the exporter
+  // needs to ship it.
+  double delay = max_delay;
+  if (arrival_rate_ > 0)
+  {
+    delay = batch_size / arrival_rate_ - std::chrono::duration<double>(export_latency_).count();
   }
+
+  // The queue overflowed; export the largest batches as often as allowed.
+  if (drop_ratio_ > target_drop_ratio_)
+  {
+    batch_size    = static_cast<double>(max_export_batch_size_);
+    auto previous = static_cast<double>(schedule_delay_millis_count_.load()) / 1000;
+    delay         = std::min(delay, previous / 2);
+  }
+
+  const double min_delay = std::chrono::duration<double>(min_schedule_delay_millis_).count();
+  delay                  = std::max(min_delay, std::min(max_delay, delay));
+
+  // A batch takes at least one span, so that draining the queue makes progress.
+  const auto export_batch_size = std::max<size_t>(1, static_cast<size_t>(batch_size));
+  export_batch_size_.store(export_batch_size, std::memory_order_relaxed);
+  schedule_delay_millis_count_.store(std::llround(delay * 1000), std::memory_order_relaxed);
+
+  // Wake the worker thread once a batch's worth of spans is queued, counting
+  // each shard's share.
+  const auto &shard     = buffer_.GetShard(0);
+  size_t wake_threshold = export_batch_size / buffer_.num_shards();
+  wake_threshold        = std::max<size_t>(1, std::min(shard.max_size() / 2, wake_threshold));
+  wake_threshold_.store(wake_threshold, std::memory_order_relaxed);
+}
+
+SpanProcessorStats BatchSpanProcessor::GetStats() const noexcept
+{
+  return stats_.GetStats();
+}
+
+BatchSpanProcessorScheduleStats BatchSpanProcessor::GetScheduleStats() const noexcept
+{
+  BatchSpanProcessorScheduleStats stats;
+  stats.export_batch_size = export_batch_size_.load(std::memory_order_relaxed);
+  stats.schedule_delay    = std::chrono::milliseconds(schedule_delay_millis_count_.load());
+  stats.wake_threshold    = wake_threshold_.load(std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lk(schedule_m_);
+  stats.arrival_rate   = arrival_rate_;
+  stats.export_latency = export_latency_;
+  stats.drop_ratio     = drop_ratio_;
+  return stats;
 }
 
 void BatchSpanProcessor::DrainQueue()
 {
-  while (buffer_.empty() == false)
+  while (QueueSize() > 0)
   {
     Export(false);
   }
@@ -175,11 +561,33 @@ void BatchSpanProcessor::DrainQueue()
 
 void BatchSpanProcessor::Shutdown(std::chrono::microseconds timeout) noexcept
 {
-  is_shutdown_ = true;
+  {
+    std::lock_guard<std::mutex> lk(cv_m_);
+    is_shutdown_ = true;
+  }
 
   cv_.notify_one();
   worker_thread_.join();
 
+  // The worker thread has handed over every batch; let the export threads
+  // finish them.
+  {
+    std::lock_guard<std::mutex> lk(export_m_);
+    is_export_shutdown_ = true;
+  }
+  export_cv_.notify_all();
+  for (auto &export_thread : export_threads_)
+  {
+    export_thread.join();
+  }
+
+  // Everything has been exported, so release any ForceFlush still waiting.
+  {
+    std::lock_guard<std::mutex> lk(force_flush_cv_m_);
+    flush_completed_seq_ = std::numeric_limits<uint64_t>::max();
+  }
+  force_flush_cv_.notify_all();
+
   exporter_->Shutdown();
 }
 
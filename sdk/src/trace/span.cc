@@ -2,6 +2,7 @@
 
 #include "opentelemetry/context/runtime_context.h"
 #include "opentelemetry/version.h"
+#include "src/trace/timestamp_utils.h"
 
 OPENTELEMETRY_BEGIN_NAMESPACE
 namespace sdk
@@ -9,46 +10,18 @@ namespace sdk
 namespace trace
 {
 
-using opentelemetry::core::SteadyTimestamp;
-using opentelemetry::core::SystemTimestamp;
-
-namespace
-{
-SystemTimestamp NowOr(const SystemTimestamp &system)
-{
-  if (system == SystemTimestamp())
-  {
-    return SystemTimestamp(std::chrono::system_clock::now());
-  }
-  else
-  {
-    return system;
-  }
-}
-
-SteadyTimestamp NowOr(const SteadyTimestamp &steady)
-{
-  if (steady == SteadyTimestamp())
-  {
-    return SteadyTimestamp(std::chrono::steady_clock::now());
-  }
-  else
-  {
-    return steady;
-  }
-}
-}  // namespace
-
 Span::Span(std::shared_ptr<Tracer> &&tracer,
            std::shared_ptr<SpanProcessor> processor,
            nostd::string_view name,
            const trace_api::KeyValueIterable &attributes,
-           const trace_api::StartSpanOptions &options) noexcept
+           const trace_api::StartSpanOptions &options,
+           bool borrow_attributes) noexcept
     : tracer_{std::move(tracer)},
       processor_{processor},
       recordable_{processor_->MakeRecordable()},
       start_steady_time{options.start_steady_time},
       has_ended_{false},
+      is_recording_{recordable_ != nullptr},
       token_{nullptr}
 
 {
@@ -60,7 +33,14 @@ Span::Span(std::shared_ptr<Tracer> &&tracer,
   recordable_->SetName(name);
 
   attributes.ForEachKeyValue([&](nostd::string_view key, common::AttributeValue value) noexcept {
-    recordable_->SetAttribute(key, value);
+    if (borrow_attributes)
+    {
+      recordable_->SetBorrowedAttribute(key, value);
+    }
+    else
+    {
+      recordable_->SetAttribute(key, value);
+    }
     return true;
   });
 
@@ -77,7 +57,10 @@ Span::~Span()
 void Span::SetAttribute(nostd::string_view key, const common::AttributeValue &value) noexcept
 {
   std::lock_guard<std::mutex> lock_guard{mu_};
-
+  if (recordable_ == nullptr)
+  {
+    return;
+  }
   recordable_->SetAttribute(key, value);
 }
 
@@ -123,13 +106,22 @@ void Span::UpdateName(nostd::string_view name) noexcept
 
 void Span::End(const trace_api::EndSpanOptions &options) noexcept
 {
-  std::lock_guard<std::mutex> lock_guard{mu_};
+  auto recordable = EndAndRelease(options);
+  if (recordable != nullptr)
+  {
+    processor_->OnEnd(std::move(recordable));
+  }
+}
 
-  if (has_ended_ == true)
+std::unique_ptr<Recordable> Span::EndAndRelease(const trace_api::EndSpanOptions &options) noexcept
+{
+  if (has_ended_.exchange(true) == true)
   {
-    return;
+    return nullptr;
   }
-  has_ended_ = true;
+  is_recording_.store(false, std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lock_guard{mu_};
 
   if (token_ != nullptr)
   {
@@ -139,21 +131,19 @@ void Span::End(const trace_api::EndSpanOptions &options) noexcept
 
   if (recordable_ == nullptr)
   {
-    return;
+    return nullptr;
   }
 
   auto end_steady_time = NowOr(options.end_steady_time);
   recordable_->SetDuration(std::chrono::steady_clock::time_point(end_steady_time) -
                            std::chrono::steady_clock::time_point(start_steady_time));
 
-  processor_->OnEnd(std::move(recordable_));
-  recordable_.reset();
+  return std::move(recordable_);
 }
 
 bool Span::IsRecording() const noexcept
 {
-  std::lock_guard<std::mutex> lock_guard{mu_};
-  return recordable_ != nullptr;
+  return is_recording_.load(std::memory_order_relaxed);
 }
 
 void Span::SetToken(nostd::unique_ptr<context::Token> &&token) noexcept
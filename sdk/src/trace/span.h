@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <mutex>
 
 #include "opentelemetry/sdk/trace/tracer.h"
@@ -19,7 +20,8 @@ class Span final : public trace_api::Span
                 std::shared_ptr<SpanProcessor> processor,
                 nostd::string_view name,
                 const trace_api::KeyValueIterable &attributes,
-                const trace_api::StartSpanOptions &options) noexcept;
+                const trace_api::StartSpanOptions &options,
+                bool borrow_attributes = false) noexcept;
 
   ~Span() override;
 
@@ -46,13 +48,27 @@ class Span final : public trace_api::Span
 
   void SetToken(nostd::unique_ptr<context::Token> &&token) noexcept override;
 
+  /**
+   * End the span like End does, but return its recordable instead of passing it to the span
+   * processor.
+   * @return the span's recordable, or nullptr if the span had ended already or records nothing
+   */
+  std::unique_ptr<Recordable> EndAndRelease(const trace_api::EndSpanOptions &options) noexcept;
+
+  /**
+   * @return the span processor the span is passed to when it ends
+   */
+  const std::shared_ptr<SpanProcessor> &processor() const noexcept { return processor_; }
+
 private:
   std::shared_ptr<trace_api::Tracer> tracer_;
   std::shared_ptr<SpanProcessor> processor_;
   mutable std::mutex mu_;
   std::unique_ptr<Recordable> recordable_;
   opentelemetry::core::SteadyTimestamp start_steady_time;
-  bool has_ended_;
+  // Set once by End, so that IsRecording and repeated End calls don't take mu_
+  std::atomic<bool> has_ended_;
+  std::atomic<bool> is_recording_;
   nostd::unique_ptr<context::Token> token_;
 };
 }  // namespace trace
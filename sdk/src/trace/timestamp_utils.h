@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+
+#include "opentelemetry/core/timestamp.h"
+#include "opentelemetry/version.h"
+
+OPENTELEMETRY_BEGIN_NAMESPACE
+namespace sdk
+{
+namespace trace
+{
+/**
+ * @return system, or the current time if system is unset
+ */
+inline core::SystemTimestamp NowOr(const core::SystemTimestamp &system) noexcept
+{
+  if (system == core::SystemTimestamp())
+  {
+    return core::SystemTimestamp(std::chrono::system_clock::now());
+  }
+  else
+  {
+    return system;
+  }
+}
+
+/**
+ * @return steady, or the current time if steady is unset
+ */
+inline core::SteadyTimestamp NowOr(const core::SteadyTimestamp &steady) noexcept
+{
+  if (steady == core::SteadyTimestamp())
+  {
+    return core::SteadyTimestamp(std::chrono::steady_clock::now());
+  }
+  else
+  {
+    return steady;
+  }
+}
+}  // namespace trace
+}  // namespace sdk
+OPENTELEMETRY_END_NAMESPACE
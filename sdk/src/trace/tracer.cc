@@ -5,14 +5,155 @@
 #include "opentelemetry/sdk/common/atomic_shared_ptr.h"
 #include "opentelemetry/version.h"
 #include "src/trace/span.h"
+#include "src/trace/timestamp_utils.h"
+
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 OPENTELEMETRY_BEGIN_NAMESPACE
 namespace sdk
 {
 namespace trace
 {
+namespace
+{
+/**
+ * A span that records nothing and refers back to the tracer that owns it.
+ */
+class NonRecordingSpan final : public trace_api::Span
+{
+public:
+  explicit NonRecordingSpan(trace_api::Tracer &tracer) noexcept : tracer_(tracer) {}
+
+  void SetAttribute(nostd::string_view /*key*/,
+                    const common::AttributeValue & /*value*/) noexcept override
+  {}
+
+  void AddEvent(nostd::string_view /*name*/) noexcept override {}
+
+  void AddEvent(nostd::string_view /*name*/, core::SystemTimestamp /*timestamp*/) noexcept override
+  {}
+
+  void AddEvent(nostd::string_view /*name*/,
+                core::SystemTimestamp /*timestamp*/,
+                const trace_api::KeyValueIterable & /*attributes*/) noexcept override
+  {}
+
+  void SetStatus(trace_api::CanonicalCode /*code*/,
+                 nostd::string_view /*description*/) noexcept override
+  {}
+
+  void UpdateName(nostd::string_view /*name*/) noexcept override {}
+
+  void End(const trace_api::EndSpanOptions & /*options*/) noexcept override {}
+
+  bool IsRecording() const noexcept override { return false; }
+
+  trace_api::Tracer &tracer() const noexcept override { return tracer_; }
+
+  void SetToken(nostd::unique_ptr<context::Token> && /* token */) noexcept override {}
+
+private:
+  trace_api::Tracer &tracer_;
+};
+
+/**
+ * Storage for the spans started together by Tracer::StartSpans. The block, its spans and the
+ * control block of the shared_ptr that owns them take a single allocation. The spans are
+ * destroyed once the last of them is released.
+ */
+class alignas(Span) SpanBlock
+{
+public:
+  /**
+   * @return a block with room for capacity spans, or nullptr if it can't be allocated
+   */
+  static std::shared_ptr<SpanBlock> Create(size_t capacity) noexcept
+  {
+    void *memory = ::operator new(sizeof(SpanBlock) + capacity * sizeof(Storage), std::nothrow);
+    if (memory == nullptr)
+    {
+      return nullptr;
+    }
+    auto block = new (memory) SpanBlock;
+    return std::shared_ptr<SpanBlock>{block, Deleter{}, Allocator<SpanBlock>{block}};
+  }
+
+  template <class... Args>
+  Span *Emplace(Args &&... args) noexcept
+  {
+    auto span = new (&spans()[size_]) Span{std::forward<Args>(args)...};
+    ++size_;
+    return span;
+  }
+
+private:
+  using Storage             = std::aligned_storage<sizeof(Span), alignof(Span)>::type;
+  using ControlBlockStorage = std::aligned_storage<64>::type;
+
+  ControlBlockStorage control_block_;
+  size_t size_ = 0;
+
+  SpanBlock() = default;
+
+  // The spans follow the block in the same allocation
+  Storage *spans() noexcept { return reinterpret_cast<Storage *>(this + 1); }
+
+  struct Deleter
+  {
+    void operator()(SpanBlock *block) const noexcept
+    {
+      for (size_t i = 0; i < block->size_; ++i)
+      {
+        reinterpret_cast<Span *>(&block->spans()[i])->~Span();
+      }
+    }
+  };
+
+  // Places the shared_ptr's control block inside the block, and frees the allocation when the
+  // control block goes away.
+  template <class T>
+  struct Allocator
+  {
+    using value_type = T;
+
+    explicit Allocator(SpanBlock *block) noexcept : block{block} {}
+
+    template <class U>
+    Allocator(const Allocator<U> &other) noexcept : block{other.block}
+    {}
+
+    T *allocate(size_t /*n*/) noexcept
+    {
+      static_assert(sizeof(T) <= sizeof(ControlBlockStorage) &&
+                        alignof(T) <= alignof(ControlBlockStorage),
+                    "the control block doesn't fit into the span block");
+      return reinterpret_cast<T *>(&block->control_block_);
+    }
+
+    void deallocate(T * /*p*/, size_t /*n*/) noexcept { ::operator delete(block); }
+
+    template <class U>
+    bool operator==(const Allocator<U> &other) const noexcept
+    {
+      return block == other.block;
+    }
+
+    template <class U>
+    bool operator!=(const Allocator<U> &other) const noexcept
+    {
+      return block != other.block;
+    }
+
+    SpanBlock *block;
+  };
+};
+}  // namespace
+
 Tracer::Tracer(std::shared_ptr<SpanProcessor> processor, std::shared_ptr<Sampler> sampler) noexcept
-    : processor_{processor}, sampler_{sampler}
+    : processor_{processor}, sampler_{sampler}, non_recording_span_{new NonRecordingSpan{*this}}
 {}
 
 void Tracer::SetProcessor(std::shared_ptr<SpanProcessor> processor) noexcept
@@ -34,21 +175,38 @@ nostd::shared_ptr<trace_api::Span> Tracer::StartSpan(
     nostd::string_view name,
     const trace_api::KeyValueIterable &attributes,
     const trace_api::StartSpanOptions &options) noexcept
+{
+  return DoStartSpan(name, attributes, options, false);
+}
+
+nostd::shared_ptr<trace_api::Span> Tracer::StartSpanBorrowingAttributes(
+    nostd::string_view name,
+    const trace_api::KeyValueIterable &attributes,
+    const trace_api::StartSpanOptions &options) noexcept
+{
+  return DoStartSpan(name, attributes, options, true);
+}
+
+nostd::shared_ptr<trace_api::Span> Tracer::DoStartSpan(
+    nostd::string_view name,
+    const trace_api::KeyValueIterable &attributes,
+    const trace_api::StartSpanOptions &options,
+    bool borrow_attributes) noexcept
 {
   // TODO: replace nullptr with parent context in span context
   auto sampling_result =
       sampler_->ShouldSample(nullptr, trace_api::TraceId(), name, options.kind, attributes);
   if (sampling_result.decision == Decision::NOT_RECORD)
   {
-    auto span = nostd::shared_ptr<trace_api::Span>{
-        new (std::nothrow) trace_api::NoopSpan{this->shared_from_this()}};
-
-    return span;
+    // Share ownership of the tracer instead of allocating a span
+    return nostd::shared_ptr<trace_api::Span>{
+        std::shared_ptr<trace_api::Span>{this->shared_from_this(), non_recording_span_.get()}};
   }
   else
   {
-    auto span = nostd::shared_ptr<trace_api::Span>{new (std::nothrow) Span{
-        this->shared_from_this(), processor_.load(), name, attributes, options}};
+    auto span = nostd::shared_ptr<trace_api::Span>{
+        new (std::nothrow) Span{this->shared_from_this(), processor_.load(), name, attributes,
+                                options, borrow_attributes}};
 
     span->SetToken(
         nostd::unique_ptr<context::Token>(new context::Token(context::RuntimeContext::Attach(
@@ -67,6 +225,115 @@ nostd::shared_ptr<trace_api::Span> Tracer::StartSpan(
   }
 }
 
+void Tracer::StartSpans(nostd::string_view name,
+                        const trace_api::KeyValueIterable &attributes,
+                        const nostd::span<nostd::shared_ptr<trace_api::Span>> &spans,
+                        const trace_api::StartSpanOptions &options) noexcept
+{
+  if (spans.empty())
+  {
+    return;
+  }
+
+  // Sibling spans belong to the same trace, so they share a sampling decision.
+  auto sampling_result =
+      sampler_->ShouldSample(nullptr, trace_api::TraceId(), name, options.kind, attributes);
+  if (sampling_result.decision == Decision::NOT_RECORD)
+  {
+    nostd::shared_ptr<trace_api::Span> span{
+        std::shared_ptr<trace_api::Span>{this->shared_from_this(), non_recording_span_.get()}};
+    for (auto &element : spans)
+    {
+      element = span;
+    }
+    return;
+  }
+
+  // Read the clocks once for all spans
+  trace_api::StartSpanOptions span_options = options;
+  span_options.start_system_time           = NowOr(options.start_system_time);
+  span_options.start_steady_time           = NowOr(options.start_steady_time);
+
+  auto processor = processor_.load();
+  auto block     = SpanBlock::Create(spans.size());
+  for (auto &element : spans)
+  {
+    Span *span;
+    if (block != nullptr)
+    {
+      span    = block->Emplace(this->shared_from_this(), processor, name, attributes, span_options);
+      element = nostd::shared_ptr<trace_api::Span>{std::shared_ptr<trace_api::Span>{block, span}};
+    }
+    else
+    {
+      // Fall back to allocating the spans one by one
+      span = new (std::nothrow)
+          Span{this->shared_from_this(), processor, name, attributes, span_options};
+      if (span == nullptr)
+      {
+        element = nostd::shared_ptr<trace_api::Span>{
+            std::shared_ptr<trace_api::Span>{this->shared_from_this(), non_recording_span_.get()}};
+        continue;
+      }
+      element = nostd::shared_ptr<trace_api::Span>{span};
+    }
+    if (sampling_result.attributes)
+    {
+      for (auto &kv : *sampling_result.attributes)
+      {
+        span->SetAttribute(kv.first, kv.second);
+      }
+    }
+  }
+}
+
+void Tracer::EndSpans(const nostd::span<nostd::shared_ptr<trace_api::Span>> &spans,
+                      const trace_api::EndSpanOptions &options) noexcept
+{
+  trace_api::EndSpanOptions span_options = options;
+  span_options.end_steady_time           = NowOr(options.end_steady_time);
+
+  // Hand consecutive spans with the same processor over together
+  std::vector<std::unique_ptr<Recordable>> recordables;
+  recordables.reserve(spans.size());
+  SpanProcessor *processor = nullptr;
+  auto flush               = [&] {
+    if (!recordables.empty())
+    {
+      processor->OnEndBatch(
+          nostd::span<std::unique_ptr<Recordable>>{recordables.data(), recordables.size()});
+      recordables.clear();
+    }
+  };
+
+  for (auto &element : spans)
+  {
+    if (element == nullptr)
+    {
+      continue;
+    }
+    // Recording spans of this tracer are always sdk spans
+    if (&element->tracer() != this || !element->IsRecording())
+    {
+      element->End(span_options);
+      continue;
+    }
+    auto span       = static_cast<Span *>(element.get());
+    auto recordable = span->EndAndRelease(span_options);
+    if (recordable == nullptr)
+    {
+      continue;
+    }
+    if (span->processor().get() != processor)
+    {
+      flush();
+      processor = span->processor().get();
+    }
+    recordables.push_back(std::move(recordable));
+  }
+  flush();
+}
+
 void Tracer::ForceFlushWithMicroseconds(uint64_t timeout) noexcept
 {
   (void)timeout;
@@ -24,6 +24,20 @@ TEST(AtomicUniquePtrTest, SwapIfNullWithNonNull)
   EXPECT_EQ(*ptr, 11);
 }
 
+TEST(AtomicUniquePtrTest, SwapIfNotNull)
+{
+  AtomicUniquePtr<int> ptr;
+  std::unique_ptr<int> x{new int{33}};
+  EXPECT_FALSE(ptr.SwapIfNotNull(x));
+  EXPECT_TRUE(ptr.IsNull());
+  EXPECT_EQ(*x, 33);
+
+  ptr.Reset(new int{11});
+  EXPECT_TRUE(ptr.SwapIfNotNull(x));
+  EXPECT_EQ(*x, 11);
+  EXPECT_EQ(*ptr, 33);
+}
+
 TEST(AtomicUniquePtrTest, Swap)
 {
   AtomicUniquePtr<int> ptr;
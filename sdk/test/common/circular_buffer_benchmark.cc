@@ -56,6 +56,32 @@ static void GenerateNumbersForThread(Buffer &buffer, int n, std::atomic<uint64_t
   }
 }
 
+static void GenerateNumberBatchesForThread(CircularBuffer<uint64_t> &buffer,
+                                          int n,
+                                          int batch_size,
+                                          std::atomic<uint64_t> &sum) noexcept
+{
+  thread_local std::mt19937_64 random_number_generator{std::random_device{}()};
+  std::vector<std::unique_ptr<uint64_t>> batch;
+  std::vector<uint64_t> values;
+  for (int i = 0; i < n; i += batch_size)
+  {
+    batch.clear();
+    values.clear();
+    for (int j = 0; j < batch_size; ++j)
+    {
+      auto x = random_number_generator();
+      batch.emplace_back(new uint64_t{x});
+      values.push_back(x);
+    }
+    auto num_added = buffer.AddBatch(batch);
+    for (size_t j = 0; j < num_added; ++j)
+    {
+      sum += values[j];
+    }
+  }
+}
+
 template <class Buffer>
 static uint64_t GenerateNumbers(Buffer &buffer, int num_threads, int n) noexcept
 {
@@ -82,6 +108,25 @@ static void ConsumeNumbers(Buffer &buffer, uint64_t &sum, std::atomic<bool> &fin
   sum += ConsumeBufferNumbers(buffer);
 }
 
+static uint64_t GenerateNumberBatches(CircularBuffer<uint64_t> &buffer,
+                                      int num_threads,
+                                      int n,
+                                      int batch_size) noexcept
+{
+  std::atomic<uint64_t> sum{0};
+  std::vector<std::thread> threads(num_threads);
+  for (auto &thread : threads)
+  {
+    thread = std::thread{GenerateNumberBatchesForThread, std::ref(buffer), n, batch_size,
+                         std::ref(sum)};
+  }
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+  return sum;
+}
+
 template <class Buffer>
 static void RunSimulation(Buffer &buffer, int num_threads, int n) noexcept
 {
@@ -99,6 +144,25 @@ static void RunSimulation(Buffer &buffer, int num_threads, int n) noexcept
   }
 }
 
+static void RunBatchedSimulation(CircularBuffer<uint64_t> &buffer,
+                                 int num_threads,
+                                 int n,
+                                 int batch_size) noexcept
+{
+  std::atomic<bool> finished{false};
+  uint64_t consumer_sum{0};
+  std::thread consumer_thread{ConsumeNumbers<CircularBuffer<uint64_t>>, std::ref(buffer),
+                              std::ref(consumer_sum), std::ref(finished)};
+  uint64_t producer_sum = GenerateNumberBatches(buffer, num_threads, n, batch_size);
+  finished              = true;
+  consumer_thread.join();
+  if (consumer_sum != producer_sum)
+  {
+    std::cerr << "Sumulation failed: consumer_sum != producer_sum\n";
+    std::terminate();
+  }
+}
+
 static void BM_BaselineBuffer(benchmark::State &state)
 {
   const size_t max_elements = 500;
@@ -127,4 +191,20 @@ static void BM_LockFreeBuffer(benchmark::State &state)
 
 BENCHMARK(BM_LockFreeBuffer)->Arg(1)->Arg(2)->Arg(4);
 
+// Producers add elements in batches of 16, claiming each batch's slots at once
+static void BM_LockFreeBufferBatched(benchmark::State &state)
+{
+  const size_t max_elements = 500;
+  const int batch_size      = 16;
+  auto num_threads          = state.range(0);
+  const int n               = N / num_threads;
+  CircularBuffer<uint64_t> buffer{max_elements};
+  for (auto _ : state)
+  {
+    RunBatchedSimulation(buffer, num_threads, n, batch_size);
+  }
+}
+
+BENCHMARK(BM_LockFreeBufferBatched)->Arg(1)->Arg(2)->Arg(4);
+
 BENCHMARK_MAIN();
@@ -1,5 +1,6 @@
 #include "opentelemetry/sdk/common/circular_buffer.h"
 
+#include <algorithm>
 #include <cassert>
 #include <random>
 #include <thread>
@@ -26,17 +27,41 @@ static void GenerateRandomNumbers(CircularBuffer<uint32_t> &buffer,
   }
 }
 
+static void GenerateRandomNumberBatches(CircularBuffer<uint32_t> &buffer,
+                                        std::vector<uint32_t> &numbers,
+                                        int n)
+{
+  std::vector<std::unique_ptr<uint32_t>> batch;
+  std::vector<uint32_t> values;
+  for (int i = 0; i < n;)
+  {
+    auto batch_size = std::uniform_int_distribution<int>{1, 8}(RandomNumberGenerator);
+    batch.clear();
+    values.clear();
+    for (int j = 0; j < batch_size && i < n; ++j, ++i)
+    {
+      auto value = static_cast<uint32_t>(RandomNumberGenerator());
+      batch.emplace_back(new uint32_t{value});
+      values.push_back(value);
+    }
+    auto num_added = buffer.AddBatch(batch);
+    numbers.insert(numbers.end(), values.begin(), values.begin() + num_added);
+  }
+}
+
 static void RunNumberProducers(CircularBuffer<uint32_t> &buffer,
                                std::vector<uint32_t> &numbers,
                                int num_threads,
-                               int n)
+                               int n,
+                               bool batched)
 {
   std::vector<std::vector<uint32_t>> thread_numbers(num_threads);
   std::vector<std::thread> threads(num_threads);
   for (int thread_index = 0; thread_index < num_threads; ++thread_index)
   {
-    threads[thread_index] = std::thread{GenerateRandomNumbers, std::ref(buffer),
-                                        std::ref(thread_numbers[thread_index]), n};
+    threads[thread_index] =
+        std::thread{batched ? GenerateRandomNumberBatches : GenerateRandomNumbers,
+                    std::ref(buffer), std::ref(thread_numbers[thread_index]), n};
   }
   for (auto &thread : threads)
   {
@@ -55,8 +80,11 @@ void RunNumberConsumer(CircularBuffer<uint32_t> &buffer,
 {
   while (true)
   {
+    // Read the exit flag before peeking so that elements added right before
+    // the producers finish aren't missed.
+    bool was_exit  = exit;
     auto allotment = buffer.Peek();
-    if (exit && allotment.empty())
+    if (was_exit && allotment.empty())
     {
       return;
     }
@@ -114,6 +142,74 @@ TEST(CircularBufferTest, AddOnFull)
   EXPECT_EQ(*x, 33);
 }
 
+TEST(CircularBufferTest, ReplaceOldest)
+{
+  CircularBuffer<int> buffer{4};
+  std::unique_ptr<int> x{new int{33}};
+  EXPECT_FALSE(buffer.ReplaceOldest(x));
+  EXPECT_EQ(*x, 33);
+
+  for (int i = 0; i < 4; ++i)
+  {
+    std::unique_ptr<int> y{new int{i}};
+    EXPECT_TRUE(buffer.Add(y));
+  }
+  EXPECT_TRUE(buffer.ReplaceOldest(x));
+  EXPECT_EQ(*x, 0);
+  x.reset(new int{34});
+  EXPECT_TRUE(buffer.ReplaceOldest(x));
+  EXPECT_EQ(*x, 1);
+  EXPECT_EQ(buffer.size(), 4);
+
+  // The replacements are consumed first, in the replaced elements' places.
+  std::vector<int> values;
+  buffer.Consume(buffer.size(), [&](CircularBufferRange<AtomicUniquePtr<int>> range) noexcept {
+    range.ForEach([&](AtomicUniquePtr<int> &ptr) noexcept {
+      values.push_back(*ptr);
+      ptr.Reset();
+      return true;
+    });
+  });
+  EXPECT_EQ(values, (std::vector<int>{33, 34, 2, 3}));
+}
+
+TEST(CircularBufferTest, WrapAround)
+{
+  // Sizes both below and at a power of two, so that the buffer has spare
+  // slots in the first case and none in the second.
+  for (size_t max_size : {3, 4, 5, 8})
+  {
+    CircularBuffer<int> buffer{max_size};
+    EXPECT_EQ(buffer.max_size(), max_size);
+    int next_added    = 0;
+    int next_consumed = 0;
+    for (int round = 0; round < 20; ++round)
+    {
+      while (true)
+      {
+        std::unique_ptr<int> x{new int{next_added}};
+        if (!buffer.Add(x))
+        {
+          break;
+        }
+        ++next_added;
+      }
+      EXPECT_EQ(buffer.size(), max_size);
+      auto n = static_cast<size_t>(round) % max_size + 1;
+      buffer.Consume(
+          n, [&](CircularBufferRange<AtomicUniquePtr<int>> range) noexcept {
+            EXPECT_EQ(range.size(), n);
+            range.ForEach([&](AtomicUniquePtr<int> &ptr) {
+              EXPECT_EQ(*ptr, next_consumed++);
+              ptr.Reset();
+              return true;
+            });
+          });
+    }
+    EXPECT_EQ(buffer.Peek().size(), max_size - (19 % max_size + 1));
+  }
+}
+
 TEST(CircularBufferTest, Consume)
 {
   CircularBuffer<int> buffer{10};
@@ -144,7 +240,111 @@ TEST(CircularBufferTest, Simulation)
     std::vector<uint32_t> producer_numbers;
     std::vector<uint32_t> consumer_numbers;
     auto producers = std::thread{RunNumberProducers, std::ref(buffer), std::ref(producer_numbers),
-                                 num_producer_threads, n};
+                                 num_producer_threads, n, false};
+    std::atomic<bool> exit{false};
+    auto consumer = std::thread{RunNumberConsumer, std::ref(buffer), std::ref(exit),
+                                std::ref(consumer_numbers)};
+    producers.join();
+    exit = true;
+    consumer.join();
+    std::sort(producer_numbers.begin(), producer_numbers.end());
+    std::sort(consumer_numbers.begin(), consumer_numbers.end());
+    EXPECT_EQ(producer_numbers, consumer_numbers);
+  }
+}
+
+TEST(CircularBufferTest, AddBatch)
+{
+  CircularBuffer<int> buffer{10};
+  std::vector<std::unique_ptr<int>> batch;
+  for (int i = 0; i < 4; ++i)
+  {
+    batch.emplace_back(new int{i});
+  }
+  EXPECT_EQ(buffer.AddBatch(batch), 4);
+  for (auto &ptr : batch)
+  {
+    EXPECT_EQ(ptr, nullptr);
+  }
+  EXPECT_EQ(buffer.size(), 4);
+
+  int count = 0;
+  buffer.Peek().ForEach([&](const AtomicUniquePtr<int> &ptr) {
+    EXPECT_EQ(*ptr, count++);
+    return true;
+  });
+  EXPECT_EQ(count, 4);
+
+  std::vector<std::unique_ptr<int>> empty_batch;
+  EXPECT_EQ(buffer.AddBatch(empty_batch), 0);
+  EXPECT_EQ(buffer.size(), 4);
+}
+
+TEST(CircularBufferTest, AddBatchOnFull)
+{
+  CircularBuffer<int> buffer{10};
+  std::vector<std::unique_ptr<int>> batch;
+  for (int i = 0; i < 8; ++i)
+  {
+    batch.emplace_back(new int{i});
+  }
+  EXPECT_EQ(buffer.AddBatch(batch), 8);
+
+  // Only the leading elements that fit are added.
+  for (int i = 0; i < 8; ++i)
+  {
+    batch[i].reset(new int{8 + i});
+  }
+  EXPECT_EQ(buffer.AddBatch(batch), 2);
+  EXPECT_EQ(batch[0], nullptr);
+  EXPECT_EQ(batch[1], nullptr);
+  for (int i = 2; i < 8; ++i)
+  {
+    ASSERT_NE(batch[i], nullptr);
+    EXPECT_EQ(*batch[i], 8 + i);
+  }
+  EXPECT_EQ(buffer.size(), buffer.max_size());
+  EXPECT_EQ(buffer.AddBatch(batch), 0);
+
+  // Batches wrap around the end of the buffer in order.
+  int count = 0;
+  buffer.Consume(
+      7, [&](CircularBufferRange<AtomicUniquePtr<int>> range) noexcept {
+        range.ForEach([&](AtomicUniquePtr<int> &ptr) {
+          EXPECT_EQ(*ptr, count++);
+          ptr.Reset();
+          return true;
+        });
+      });
+  std::vector<std::unique_ptr<int>> rest;
+  for (int i = 2; i < 8; ++i)
+  {
+    rest.push_back(std::move(batch[i]));
+  }
+  EXPECT_EQ(buffer.AddBatch(rest), 6);
+  std::vector<int> numbers;
+  buffer.Consume(
+      buffer.size(), [&](CircularBufferRange<AtomicUniquePtr<int>> range) noexcept {
+        range.ForEach([&](AtomicUniquePtr<int> &ptr) {
+          numbers.push_back(*ptr);
+          ptr.Reset();
+          return true;
+        });
+      });
+  EXPECT_EQ(numbers, (std::vector<int>{7, 8, 9, 10, 11, 12, 13, 14, 15}));
+}
+
+TEST(CircularBufferTest, SimulationWithBatches)
+{
+  const int num_producer_threads = 4;
+  const int n                    = 25000;
+  for (size_t max_size : {1, 2, 10, 50, 100, 1000})
+  {
+    CircularBuffer<uint32_t> buffer{max_size};
+    std::vector<uint32_t> producer_numbers;
+    std::vector<uint32_t> consumer_numbers;
+    auto producers = std::thread{RunNumberProducers, std::ref(buffer), std::ref(producer_numbers),
+                                 num_producer_threads, n, true};
     std::atomic<bool> exit{false};
     auto consumer = std::thread{RunNumberConsumer, std::ref(buffer), std::ref(exit),
                                 std::ref(consumer_numbers)};
@@ -0,0 +1,105 @@
+#include "opentelemetry/sdk/common/object_pool.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+using opentelemetry::sdk::common::ObjectPool;
+
+TEST(ObjectPoolTest, GetFromEmpty)
+{
+  ObjectPool<int> pool{4};
+  EXPECT_EQ(pool.Get(), nullptr);
+  EXPECT_EQ(pool.size(), 0);
+}
+
+TEST(ObjectPoolTest, PutAndGet)
+{
+  ObjectPool<int> pool{4};
+  std::unique_ptr<int> x{new int{11}};
+  auto raw = x.get();
+  EXPECT_TRUE(pool.Put(x));
+  EXPECT_EQ(x, nullptr);
+  EXPECT_EQ(pool.size(), 1);
+
+  auto y = pool.Get();
+  EXPECT_EQ(y.get(), raw);
+  EXPECT_EQ(*y, 11);
+  EXPECT_EQ(pool.size(), 0);
+  EXPECT_EQ(pool.Get(), nullptr);
+}
+
+TEST(ObjectPoolTest, PutOnFull)
+{
+  ObjectPool<int> pool{2};
+  for (int i = 0; i < 2; ++i)
+  {
+    std::unique_ptr<int> x{new int{i}};
+    EXPECT_TRUE(pool.Put(x));
+  }
+  std::unique_ptr<int> x{new int{33}};
+  EXPECT_FALSE(pool.Put(x));
+  EXPECT_NE(x, nullptr);
+  EXPECT_EQ(*x, 33);
+  EXPECT_EQ(pool.size(), 2);
+}
+
+TEST(ObjectPoolTest, ZeroSize)
+{
+  ObjectPool<int> pool{0};
+  std::unique_ptr<int> x{new int{33}};
+  EXPECT_FALSE(pool.Put(x));
+  EXPECT_NE(x, nullptr);
+  EXPECT_EQ(pool.Get(), nullptr);
+}
+
+TEST(ObjectPoolTest, Simulation)
+{
+  const int num_threads = 4;
+  const int n           = 10000;
+  ObjectPool<int> pool{16};
+  std::vector<std::vector<int>> thread_numbers(num_threads);
+  std::vector<std::thread> threads;
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index)
+  {
+    threads.emplace_back([&, thread_index] {
+      for (int i = 0; i < n; ++i)
+      {
+        auto value = thread_index * n + i;
+        std::unique_ptr<int> x{new int{value}};
+        if (!pool.Put(x))
+        {
+          thread_numbers[thread_index].push_back(value);
+        }
+        auto y = pool.Get();
+        if (y != nullptr)
+        {
+          thread_numbers[thread_index].push_back(*y);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+
+  // Every number is either still in the pool or was seen by exactly one thread.
+  std::vector<int> numbers;
+  for (auto &values : thread_numbers)
+  {
+    numbers.insert(numbers.end(), values.begin(), values.end());
+  }
+  while (auto x = pool.Get())
+  {
+    numbers.push_back(*x);
+  }
+  EXPECT_EQ(pool.size(), 0);
+  std::sort(numbers.begin(), numbers.end());
+  ASSERT_EQ(numbers.size(), static_cast<size_t>(num_threads * n));
+  for (int i = 0; i < num_threads * n; ++i)
+  {
+    EXPECT_EQ(numbers[i], i);
+  }
+}
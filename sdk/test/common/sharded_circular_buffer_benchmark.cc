@@ -0,0 +1,91 @@
+#include "benchmark/benchmark.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "opentelemetry/sdk/common/circular_buffer.h"
+#include "opentelemetry/sdk/common/sharded_circular_buffer.h"
+using opentelemetry::sdk::common::AtomicUniquePtr;
+using opentelemetry::sdk::common::CircularBuffer;
+using opentelemetry::sdk::common::CircularBufferRange;
+using opentelemetry::sdk::common::ShardedCircularBuffer;
+
+// Measures how producer throughput scales with the number of producer threads
+// when they all add into one CircularBuffer versus one shard per producer.
+
+const int N                 = 100000;
+const size_t kMaxQueueSize  = 2048;
+const int kMaxProducerCount = 16;
+
+template <class Buffer>
+static void ConsumeAll(Buffer &buffer, size_t n) noexcept
+{
+  buffer.Consume(
+      n, [](CircularBufferRange<AtomicUniquePtr<uint64_t>> & range) noexcept {
+        range.ForEach([](AtomicUniquePtr<uint64_t> & ptr) noexcept {
+          ptr.Reset();
+          return true;
+        });
+      });
+}
+
+template <class Buffer>
+static void RunContention(benchmark::State &state, Buffer &buffer) noexcept
+{
+  const int num_threads = static_cast<int>(state.range(0));
+  const int n           = N / num_threads;
+  for (auto _ : state)
+  {
+    std::atomic<bool> finished{false};
+    std::thread consumer{[&] {
+      while (!finished)
+      {
+        ConsumeAll(buffer, buffer.size());
+      }
+      ConsumeAll(buffer, buffer.size());
+    }};
+    std::vector<std::thread> producers(num_threads);
+    for (auto &producer : producers)
+    {
+      producer = std::thread{[&] {
+        for (int i = 0; i < n; ++i)
+        {
+          std::unique_ptr<uint64_t> element{new uint64_t{static_cast<uint64_t>(i)}};
+          // Retry until the element fits so that every thread does the same work.
+          while (!buffer.Add(element))
+          {
+            std::this_thread::yield();
+          }
+        }
+      }};
+    }
+    for (auto &producer : producers)
+    {
+      producer.join();
+    }
+    finished = true;
+    consumer.join();
+  }
+  state.SetItemsProcessed(state.iterations() * n * num_threads);
+}
+
+static void BM_SingleBufferContention(benchmark::State &state)
+{
+  CircularBuffer<uint64_t> buffer{kMaxQueueSize};
+  RunContention(state, buffer);
+}
+
+BENCHMARK(BM_SingleBufferContention)->RangeMultiplier(2)->Range(1, kMaxProducerCount)->UseRealTime();
+
+static void BM_ShardedBufferContention(benchmark::State &state)
+{
+  ShardedCircularBuffer<uint64_t> buffer{kMaxQueueSize, static_cast<size_t>(state.range(0))};
+  RunContention(state, buffer);
+}
+
+BENCHMARK(BM_ShardedBufferContention)->RangeMultiplier(2)->Range(1, kMaxProducerCount)->UseRealTime();
+
+BENCHMARK_MAIN();
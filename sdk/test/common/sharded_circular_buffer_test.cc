@@ -0,0 +1,148 @@
+#include "opentelemetry/sdk/common/sharded_circular_buffer.h"
+
+#include <algorithm>
+#include <random>
+#include <thread>
+
+#include <gtest/gtest.h>
+using opentelemetry::sdk::common::AtomicUniquePtr;
+using opentelemetry::sdk::common::CircularBufferRange;
+using opentelemetry::sdk::common::ShardedCircularBuffer;
+
+static size_t ConsumeNumbers(ShardedCircularBuffer<uint32_t> &buffer,
+                             size_t n,
+                             std::vector<uint32_t> &numbers)
+{
+  return buffer.Consume(
+      n, [&](CircularBufferRange<AtomicUniquePtr<uint32_t>> range) noexcept {
+        range.ForEach([&](AtomicUniquePtr<uint32_t> & ptr) noexcept {
+          numbers.push_back(*ptr);
+          ptr.Reset();
+          return true;
+        });
+      });
+}
+
+TEST(ShardedCircularBufferTest, SingleShard)
+{
+  ShardedCircularBuffer<uint32_t> buffer{10, 1};
+  EXPECT_EQ(buffer.num_shards(), 1);
+  EXPECT_EQ(buffer.max_size(), 10);
+  for (uint32_t i = 0; i < 10; ++i)
+  {
+    std::unique_ptr<uint32_t> x{new uint32_t{i}};
+    EXPECT_TRUE(buffer.Add(x));
+  }
+  std::unique_ptr<uint32_t> x{new uint32_t{33}};
+  EXPECT_FALSE(buffer.Add(x));
+  EXPECT_NE(x, nullptr);
+
+  std::vector<uint32_t> numbers;
+  ConsumeNumbers(buffer, buffer.size(), numbers);
+  EXPECT_EQ(numbers, (std::vector<uint32_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+  EXPECT_TRUE(buffer.empty());
+}
+
+TEST(ShardedCircularBufferTest, ZeroShards)
+{
+  ShardedCircularBuffer<uint32_t> buffer{10, 0};
+  EXPECT_EQ(buffer.num_shards(), 1);
+}
+
+TEST(ShardedCircularBufferTest, ThreadsArePinnedToShards)
+{
+  ShardedCircularBuffer<uint32_t> buffer{100, 4};
+  EXPECT_EQ(buffer.max_size(), 100);
+
+  auto &shard = buffer.GetShard();
+  EXPECT_EQ(&shard, &buffer.GetShard());
+  for (uint32_t i = 0; i < 5; ++i)
+  {
+    std::unique_ptr<uint32_t> x{new uint32_t{i}};
+    EXPECT_TRUE(buffer.Add(x));
+  }
+  EXPECT_EQ(shard.size(), 5);
+  EXPECT_EQ(buffer.size(), 5);
+  buffer.Clear();
+  EXPECT_TRUE(buffer.empty());
+}
+
+TEST(ShardedCircularBufferTest, ConsumeRoundRobin)
+{
+  ShardedCircularBuffer<uint32_t> buffer{40, 4};
+  for (uint32_t shard_index = 0; shard_index < 4; ++shard_index)
+  {
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+      std::unique_ptr<uint32_t> x{new uint32_t{shard_index}};
+      EXPECT_TRUE(buffer.GetShard(shard_index).Add(x));
+    }
+  }
+  EXPECT_EQ(buffer.size(), 20);
+
+  // Every shard gets an equal share of a partial drain.
+  std::vector<uint32_t> numbers;
+  ConsumeNumbers(buffer, 8, numbers);
+  std::sort(numbers.begin(), numbers.end());
+  EXPECT_EQ(numbers, (std::vector<uint32_t>{0, 0, 1, 1, 2, 2, 3, 3}));
+
+  // Asking for more than is stored drains everything and stops.
+  numbers.clear();
+  EXPECT_EQ(ConsumeNumbers(buffer, 100, numbers), 12);
+  EXPECT_EQ(numbers.size(), 12);
+  EXPECT_TRUE(buffer.empty());
+}
+
+TEST(ShardedCircularBufferTest, Simulation)
+{
+  const int num_producer_threads = 4;
+  const int n                    = 25000;
+  for (size_t num_shards : {1, 2, 4, 8})
+  {
+    ShardedCircularBuffer<uint32_t> buffer{100, num_shards};
+    std::vector<std::vector<uint32_t>> thread_numbers(num_producer_threads);
+    std::vector<uint32_t> producer_numbers;
+    std::vector<uint32_t> consumer_numbers;
+    std::atomic<bool> exit{false};
+    std::thread consumer{[&] {
+      while (true)
+      {
+        bool was_exit = exit;
+        ConsumeNumbers(buffer, buffer.size(), consumer_numbers);
+        if (was_exit && buffer.empty())
+        {
+          return;
+        }
+      }
+    }};
+    std::vector<std::thread> producers;
+    for (int thread_index = 0; thread_index < num_producer_threads; ++thread_index)
+    {
+      producers.emplace_back([&, thread_index] {
+        std::mt19937 random_number_generator{static_cast<uint32_t>(thread_index)};
+        for (int i = 0; i < n; ++i)
+        {
+          auto value = static_cast<uint32_t>(random_number_generator());
+          std::unique_ptr<uint32_t> x{new uint32_t{value}};
+          if (buffer.Add(x))
+          {
+            thread_numbers[thread_index].push_back(value);
+          }
+        }
+      });
+    }
+    for (auto &producer : producers)
+    {
+      producer.join();
+    }
+    exit = true;
+    consumer.join();
+    for (auto &numbers : thread_numbers)
+    {
+      producer_numbers.insert(producer_numbers.end(), numbers.begin(), numbers.end());
+    }
+    std::sort(producer_numbers.begin(), producer_numbers.end());
+    std::sort(consumer_numbers.begin(), consumer_numbers.end());
+    EXPECT_EQ(producer_numbers, consumer_numbers);
+  }
+}
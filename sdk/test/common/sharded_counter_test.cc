@@ -0,0 +1,38 @@
+#include "opentelemetry/sdk/common/sharded_counter.h"
+
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+using opentelemetry::sdk::common::ShardedCounter;
+
+TEST(ShardedCounterTest, Add)
+{
+  ShardedCounter counter;
+  EXPECT_EQ(counter.Value(), 0);
+  counter.Add();
+  counter.Add(41);
+  EXPECT_EQ(counter.Value(), 42);
+}
+
+TEST(ShardedCounterTest, ManyThreads)
+{
+  const int num_threads   = 32;
+  const int num_additions = 10000;
+  ShardedCounter counter;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i)
+  {
+    threads.emplace_back([&] {
+      for (int j = 0; j < num_additions; ++j)
+      {
+        counter.Add();
+      }
+    });
+  }
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_EQ(counter.Value(), num_threads * num_additions);
+}
@@ -0,0 +1,61 @@
+#include "opentelemetry/sdk/common/sharded_histogram.h"
+
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+using opentelemetry::sdk::common::HistogramSnapshot;
+using opentelemetry::sdk::common::ShardedHistogram;
+
+TEST(ShardedHistogramTest, BucketIndex)
+{
+  EXPECT_EQ(ShardedHistogram::BucketIndex(0), 0);
+  EXPECT_EQ(ShardedHistogram::BucketIndex(1), 1);
+  EXPECT_EQ(ShardedHistogram::BucketIndex(2), 2);
+  EXPECT_EQ(ShardedHistogram::BucketIndex(3), 2);
+  EXPECT_EQ(ShardedHistogram::BucketIndex(4), 3);
+  EXPECT_EQ(ShardedHistogram::BucketIndex(1023), 10);
+  EXPECT_EQ(ShardedHistogram::BucketIndex(1024), 11);
+  EXPECT_EQ(ShardedHistogram::BucketIndex(~uint64_t{0}), HistogramSnapshot::kNumBuckets - 1);
+
+  for (size_t i = 0; i < HistogramSnapshot::kNumBuckets; ++i)
+  {
+    EXPECT_EQ(ShardedHistogram::BucketIndex(HistogramSnapshot::BucketLowerBound(i)), i);
+  }
+}
+
+TEST(ShardedHistogramTest, Record)
+{
+  ShardedHistogram histogram;
+  histogram.Record(0);
+  histogram.Record(5);
+  histogram.Record(6);
+  auto snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(snapshot.counts[0], 1);
+  EXPECT_EQ(snapshot.counts[3], 2);
+  EXPECT_EQ(snapshot.TotalCount(), 3);
+}
+
+TEST(ShardedHistogramTest, ManyThreads)
+{
+  const int num_threads = 32;
+  const int num_records = 1000;
+  ShardedHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i)
+  {
+    threads.emplace_back([&, i] {
+      for (int j = 0; j < num_records; ++j)
+      {
+        histogram.Record(static_cast<uint64_t>(i));
+      }
+    });
+  }
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+  auto snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(snapshot.TotalCount(), num_threads * num_records);
+  EXPECT_EQ(snapshot.counts[ShardedHistogram::BucketIndex(31)], 16 * num_records);
+}
@@ -0,0 +1,121 @@
+#include "opentelemetry/sdk/common/string_intern_table.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+using opentelemetry::sdk::common::InternedString;
+using opentelemetry::sdk::common::StringInternTable;
+
+TEST(StringInternTableTest, InternReturnsSharedCopy)
+{
+  StringInternTable table{10};
+  std::string str = "abc";
+  auto interned   = table.Intern(str);
+  ASSERT_NE(interned, nullptr);
+  EXPECT_EQ(*interned, "abc");
+  EXPECT_NE(interned->data(), str.data());
+  EXPECT_EQ(table.Intern("abc"), interned);
+  EXPECT_EQ(table.Find("abc"), interned);
+  EXPECT_NE(table.Intern("abd"), interned);
+  EXPECT_EQ(table.size(), 2);
+}
+
+TEST(StringInternTableTest, FindDoesNotIntern)
+{
+  StringInternTable table{10};
+  EXPECT_EQ(table.Find("abc"), nullptr);
+  EXPECT_EQ(table.size(), 0);
+}
+
+TEST(StringInternTableTest, Full)
+{
+  StringInternTable table{4};
+  for (int i = 0; i < 4; ++i)
+  {
+    EXPECT_NE(table.Intern(std::to_string(i)), nullptr);
+  }
+  EXPECT_EQ(table.Intern("4"), nullptr);
+  EXPECT_EQ(table.size(), 4);
+
+  // Strings interned before the table filled up are still found
+  EXPECT_NE(table.Intern("3"), nullptr);
+}
+
+TEST(StringInternTableTest, Simulation)
+{
+  const int num_threads = 4;
+  const int n           = 1000;
+  StringInternTable table{n};
+  std::vector<std::vector<const std::string *>> thread_results(num_threads);
+  std::vector<std::thread> threads;
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index)
+  {
+    threads.emplace_back([&, thread_index] {
+      for (int i = 0; i < n; ++i)
+      {
+        thread_results[thread_index].push_back(table.Intern("key" + std::to_string(i)));
+      }
+    });
+  }
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_EQ(table.size(), n);
+  for (int i = 0; i < n; ++i)
+  {
+    ASSERT_NE(thread_results[0][i], nullptr);
+    EXPECT_EQ(*thread_results[0][i], "key" + std::to_string(i));
+    for (int thread_index = 1; thread_index < num_threads; ++thread_index)
+    {
+      EXPECT_EQ(thread_results[thread_index][i], thread_results[0][i]);
+    }
+  }
+}
+
+TEST(InternedStringTest, Compare)
+{
+  InternedString empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(empty, "");
+
+  InternedString s1{"span name"};
+  InternedString s2{std::string{"span name"}};
+  EXPECT_TRUE(s1.is_interned());
+  EXPECT_EQ(s1.data(), s2.data());
+  EXPECT_EQ(s1, s2);
+  EXPECT_EQ(s1.hash(), s2.hash());
+  EXPECT_EQ(s1, "span name");
+  EXPECT_NE(s1, InternedString{"other name"});
+
+  s2.clear();
+  EXPECT_EQ(s2, "");
+  s2.Assign("span name");
+  EXPECT_EQ(s1, s2);
+}
+
+TEST(InternedStringTest, Lookup)
+{
+  auto missing = InternedString::Lookup("a key that is never interned");
+  EXPECT_FALSE(missing.is_interned());
+  EXPECT_EQ(missing, "a key that is never interned");
+  EXPECT_EQ(StringInternTable::GetGlobal().Find("a key that is never interned"), nullptr);
+
+  InternedString interned{"a key that is interned"};
+  EXPECT_EQ(InternedString::Lookup("a key that is interned"), interned);
+  EXPECT_TRUE(InternedString::Lookup("a key that is interned").is_interned());
+}
+
+TEST(InternedStringTest, HashIsContentHash)
+{
+  // A key that missed the table hashes like the same key once it's interned
+  auto owned = InternedString::Lookup("a key that is interned later");
+  InternedString interned{"a key that is interned later"};
+  EXPECT_FALSE(owned.is_interned());
+  EXPECT_TRUE(interned.is_interned());
+  EXPECT_EQ(owned, interned);
+  EXPECT_EQ(owned.hash(), interned.hash());
+  EXPECT_EQ(interned.hash(), StringInternTable::Hash("a key that is interned later"));
+}
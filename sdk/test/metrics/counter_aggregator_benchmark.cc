@@ -0,0 +1,37 @@
+#include "opentelemetry/sdk/metrics/sync_instruments.h"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+using opentelemetry::sdk::metrics::BoundCounter;
+
+// Measures how the throughput of a bound counter, with a single sum or with per-thread cells,
+// scales with the number of threads adding to it.
+
+template <class T>
+void BM_BoundCounterAdd(benchmark::State &state)
+{
+  static BoundCounter<T> counter("counter", "", "", true);
+  for (auto _ : state)
+  {
+    counter.add(1);
+  }
+}
+BENCHMARK_TEMPLATE(BM_BoundCounterAdd, int)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BoundCounterAdd, double)->ThreadRange(1, 64)->UseRealTime();
+
+template <class T>
+void BM_StripedBoundCounterAdd(benchmark::State &state)
+{
+  static BoundCounter<T> counter("counter", "", "", true, true);
+  for (auto _ : state)
+  {
+    counter.add(1);
+  }
+}
+BENCHMARK_TEMPLATE(BM_StripedBoundCounterAdd, int)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_StripedBoundCounterAdd, double)->ThreadRange(1, 64)->UseRealTime();
+}  // namespace
+
+BENCHMARK_MAIN();
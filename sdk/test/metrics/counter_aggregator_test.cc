@@ -3,6 +3,7 @@
 #include <gtest/gtest.h>
 #include <numeric>
 #include <thread>
+#include <vector>
 
 namespace metrics_api = opentelemetry::metrics;
 
@@ -82,6 +83,76 @@ TEST(CounterAggregator, Concurrency)
   EXPECT_EQ(alpha.get_checkpoint()[0], 2 * 2000000);
 }
 
+TEST(CounterAggregator, ConcurrencyDouble)
+{
+  CounterAggregator<double> alpha(metrics_api::InstrumentKind::Counter);
+
+  auto callback = [&alpha] {
+    for (int i = 0; i < 1000000; i++)
+    {
+      alpha.update(0.5);
+    }
+  };
+  std::thread first(callback);
+  std::thread second(callback);
+
+  first.join();
+  second.join();
+
+  alpha.checkpoint();
+
+  // halves are exact, so lost updates would show as a smaller sum
+  EXPECT_EQ(alpha.get_checkpoint()[0], 1000000);
+  EXPECT_EQ(alpha.get_values()[0], 0);
+}
+
+TEST(CounterAggregator, StripedConcurrency)
+{
+  CounterAggregator<int> alpha(metrics_api::InstrumentKind::Counter, true);
+  EXPECT_TRUE(alpha.is_striped());
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; i++)
+  {
+    threads.emplace_back([&alpha] {
+      for (int j = 0; j < 100000; j++)
+      {
+        alpha.update(1);
+      }
+    });
+  }
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_EQ(alpha.get_values()[0], 8 * 100000);
+
+  alpha.checkpoint();
+  EXPECT_EQ(alpha.get_checkpoint()[0], 8 * 100000);
+  EXPECT_EQ(alpha.get_values()[0], 0);  // the cells are reset
+
+  alpha.update(3);
+  alpha.checkpoint();
+  EXPECT_EQ(alpha.get_checkpoint()[0], 3);
+}
+
+TEST(CounterAggregator, MergeStriped)
+{
+  CounterAggregator<double> alpha(metrics_api::InstrumentKind::Counter);
+  CounterAggregator<double> beta(metrics_api::InstrumentKind::Counter, true);
+
+  alpha.update(1.5);
+  std::thread([&beta] { beta.update(2); }).join();
+  beta.update(0.25);
+
+  alpha.merge(beta);
+  EXPECT_FALSE(alpha.is_striped());
+  EXPECT_EQ(alpha.get_values()[0], 3.75);
+
+  beta.merge(alpha);
+  EXPECT_EQ(beta.get_values()[0], 6);
+}
+
 TEST(CounterAggregator, Merge)
 {
   CounterAggregator<int> alpha(metrics_api::InstrumentKind::Counter);
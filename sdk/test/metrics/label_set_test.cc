@@ -0,0 +1,78 @@
+#include "opentelemetry/sdk/metrics/label_set.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "opentelemetry/trace/key_value_iterable_view.h"
+
+using opentelemetry::sdk::metrics::LabelSet;
+namespace trace = opentelemetry::trace;
+
+namespace
+{
+template <class T>
+LabelSet MakeLabelSet(const T &labels)
+{
+  return LabelSet(trace::KeyValueIterableView<T>{labels});
+}
+}  // namespace
+
+TEST(LabelSet, SortsLabels)
+{
+  std::vector<std::pair<std::string, std::string>> labels = {{"b", "2"}, {"a", "1"}, {"c", ""}};
+  auto label_set = MakeLabelSet(labels);
+  EXPECT_EQ(label_set.size(), 3);
+  EXPECT_EQ(label_set.ToString(), "{\"a\":\"1\",\"b\":\"2\",\"c\":\"\"}");
+
+  std::vector<std::string> keys;
+  label_set.ForEachLabel([&keys](opentelemetry::nostd::string_view key,
+                                 opentelemetry::nostd::string_view) { keys.emplace_back(key); });
+  EXPECT_EQ(keys, (std::vector<std::string>{"a", "b", "c"}));
+}
+
+TEST(LabelSet, EqualityIgnoresOrder)
+{
+  std::vector<std::pair<std::string, std::string>> labels = {{"b", "2"}, {"a", "1"}};
+  std::map<std::string, std::string> sorted_labels        = {{"a", "1"}, {"b", "2"}};
+  std::map<std::string, std::string> other_labels         = {{"a", "1"}, {"b", "3"}};
+  EXPECT_EQ(MakeLabelSet(labels), MakeLabelSet(sorted_labels));
+  EXPECT_EQ(MakeLabelSet(labels).hash(), MakeLabelSet(sorted_labels).hash());
+  EXPECT_NE(MakeLabelSet(labels), MakeLabelSet(other_labels));
+}
+
+// Keys and values are length-prefixed, so moving characters between them changes the label set
+TEST(LabelSet, EncodingIsUnambiguous)
+{
+  std::map<std::string, std::string> labels       = {{"ab", "c"}};
+  std::map<std::string, std::string> other_labels = {{"a", "bc"}};
+  EXPECT_NE(MakeLabelSet(labels), MakeLabelSet(other_labels));
+}
+
+TEST(LabelSet, Empty)
+{
+  std::map<std::string, std::string> labels;
+  EXPECT_EQ(MakeLabelSet(labels), LabelSet());
+  EXPECT_EQ(LabelSet().size(), 0);
+  EXPECT_EQ(LabelSet().ToString(), "{}");
+}
+
+TEST(LabelSet, Assign)
+{
+  std::map<std::string, std::string> labels       = {{"key", "a long value that needs the heap"}};
+  std::map<std::string, std::string> other_labels = {{"key", "value"}};
+  LabelSet label_set;
+  label_set.Assign(trace::KeyValueIterableView<decltype(labels)>{labels});
+  label_set.Assign(trace::KeyValueIterableView<decltype(other_labels)>{other_labels});
+  EXPECT_EQ(label_set, MakeLabelSet(other_labels));
+  EXPECT_EQ(label_set.ToString(), "{\"key\":\"value\"}");
+}
+
+#if __EXCEPTIONS
+TEST(LabelSet, NonStringLabels)
+{
+  std::map<std::string, int> labels = {{"key", 1}};
+  EXPECT_THROW(MakeLabelSet(labels), std::invalid_argument);
+}
+#endif
@@ -0,0 +1,75 @@
+#include "opentelemetry/sdk/metrics/meter.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+using opentelemetry::nostd::shared_ptr;
+using opentelemetry::sdk::metrics::Meter;
+using opentelemetry::trace::KeyValueIterableView;
+namespace metrics_api = opentelemetry::metrics;
+
+using Labels = std::map<std::string, std::string>;
+
+// Measures recording to an instrument without binding it first, which looks up the bound
+// instrument of the labels on every call.
+void BM_CounterAdd(benchmark::State &state)
+{
+  Meter meter("benchmark");
+  auto counter = meter.NewIntCounter("counter", "", "", true);
+  Labels labels{{"http.method", "GET"}, {"http.status_code", "200"}, {"service", "frontend"}};
+  KeyValueIterableView<Labels> labels_view{labels};
+  for (auto _ : state)
+  {
+    counter->add(1, labels_view);
+  }
+}
+BENCHMARK(BM_CounterAdd);
+
+void BM_ValueRecorderRecord(benchmark::State &state)
+{
+  Meter meter("benchmark");
+  auto recorder = meter.NewDoubleValueRecorder("recorder", "", "", true);
+  Labels labels{{"http.method", "GET"}, {"http.status_code", "200"}, {"service", "frontend"}};
+  KeyValueIterableView<Labels> labels_view{labels};
+  for (auto _ : state)
+  {
+    recorder->record(1.5, labels_view);
+  }
+}
+BENCHMARK(BM_ValueRecorderRecord);
+
+// Measures collecting a counter with state.range(0) label sets, all kept bound, of which the
+// first state.range(1) are added to before each collection.
+void BM_MeterCollect(benchmark::State &state)
+{
+  Meter meter("benchmark");
+  auto counter = meter.NewIntCounter("counter", "", "", true);
+  std::vector<shared_ptr<metrics_api::BoundCounter<int>>> bound_counters;
+  for (int i = 0; i < state.range(0); ++i)
+  {
+    Labels labels{{"id", std::to_string(i)}, {"service", "frontend"}};
+    bound_counters.push_back(counter->bindCounter(KeyValueIterableView<Labels>{labels}));
+    bound_counters.back()->add(1);
+  }
+  for (auto _ : state)
+  {
+    for (int i = 0; i < state.range(1); ++i)
+    {
+      bound_counters[i]->add(1);
+    }
+    benchmark::DoNotOptimize(meter.Collect());
+  }
+}
+BENCHMARK(BM_MeterCollect)
+    ->Args({100, 100})
+    ->Args({10000, 0})
+    ->Args({10000, 100})
+    ->Args({10000, 10000});
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -1,6 +1,7 @@
 #include "opentelemetry/sdk/metrics/meter.h"
 #include <gtest/gtest.h>
 #include <future>
+#include <thread>
 
 using namespace opentelemetry::sdk::metrics;
 namespace metrics_api = opentelemetry::metrics;
@@ -91,6 +92,47 @@ TEST(Meter, CollectSyncInstruments)
   ASSERT_EQ(agg->get_checkpoint()[0], 10);
 }
 
+TEST(Meter, CollectStripedSync)
+{
+  // Verify that striped counters are collected like other counters, and that only the instruments
+  // named in EnableStripedAggregation are striped.
+  Meter m("Test");
+  m.EnableStripedAggregation("striped-counter");
+
+  auto striped = m.NewIntCounter("striped-counter", "For testing", "Unitless", true);
+  auto plain   = m.NewIntUpDownCounter("plain-counter", "For testing", "Unitless", true);
+
+  std::map<std::string, std::string> labels = {{"Key", "Value"}};
+  auto labelkv = opentelemetry::trace::KeyValueIterableView<decltype(labels)>{labels};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++)
+  {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 1000; j++)
+      {
+        striped->add(1, labelkv);
+        plain->add(1, labelkv);
+      }
+    });
+  }
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+
+  std::vector<Record> res = m.Collect();
+  ASSERT_EQ(res.size(), 2);
+  for (auto &record : res)
+  {
+    auto agg = std::dynamic_pointer_cast<CounterAggregator<int>>(
+        opentelemetry::nostd::get<1>(record.GetAggregator()));
+    ASSERT_NE(agg, nullptr);
+    EXPECT_EQ(agg->is_striped(), record.GetName() == "striped-counter");
+    EXPECT_EQ(agg->get_checkpoint()[0], 4000);
+  }
+}
+
 TEST(Meter, CollectDeletedSync)
 {
   // Verify that calling Collect() after creating a synchronous instrument and destroying
@@ -34,8 +34,9 @@ TEST(ApiSdkConversion, async)
   auto labelkv                              = trace::KeyValueIterableView<decltype(labels)>{labels};
 
   alpha->observe(123456, labelkv);
-  EXPECT_EQ(dynamic_cast<AsynchronousInstrument<int> *>(alpha.get())->GetRecords()[0].GetLabels(),
-            "{\"key587\":\"value264\"}");
+  auto records = dynamic_cast<AsynchronousInstrument<int> *>(alpha.get())->GetRecords();
+  EXPECT_EQ(records[0].GetLabels(), "{\"key587\":\"value264\"}");
+  EXPECT_EQ(records[0].GetLabelSet(), LabelSet(labelkv));
 
   alpha->observe(123456, labelkv);
   AggregatorVariant canCollect =
@@ -236,7 +237,7 @@ TEST(Counter, Binding)
   gamma->unbind();
   epsilon->unbind();
 
-  EXPECT_EQ(alpha.boundInstruments_[KvToString(labelkv1)]->get_ref(), 0);
+  EXPECT_EQ(alpha.boundInstruments_[LabelSet(labelkv1)]->get_ref(), 0);
   EXPECT_EQ(alpha.boundInstruments_.size(), 3);
 }
 
@@ -250,7 +251,7 @@ TEST(Counter, getAggsandnewupdate)
   auto beta    = alpha.bindCounter(labelkv);
   beta->unbind();
 
-  EXPECT_EQ(alpha.boundInstruments_[KvToString(labelkv)]->get_ref(), 0);
+  EXPECT_EQ(alpha.boundInstruments_[LabelSet(labelkv)]->get_ref(), 0);
   EXPECT_EQ(alpha.boundInstruments_.size(), 1);
 
   auto theta = alpha.GetRecords();
@@ -260,6 +261,88 @@ TEST(Counter, getAggsandnewupdate)
   EXPECT_EQ(theta[0].GetLabels(), "{\"key2\":\"value2\",\"key3\":\"value3\"}");
 }
 
+TEST(Counter, GetRecordsOfChanged)
+{
+  Counter<int> alpha("test", "none", "unitless", true);
+
+  std::map<std::string, std::string> labels  = {{"key", "value"}};
+  std::map<std::string, std::string> labels1 = {{"key1", "value1"}};
+
+  auto labelkv  = trace::KeyValueIterableView<decltype(labels)>{labels};
+  auto labelkv1 = trace::KeyValueIterableView<decltype(labels1)>{labels1};
+
+  auto beta = alpha.bindCounter(labelkv);
+  beta->add(2);
+  alpha.add(3, labelkv1);
+
+  // The series that was added to without binding it is removed once collected
+  auto records = alpha.GetRecords();
+  EXPECT_EQ(records.size(), 2);
+  EXPECT_EQ(alpha.boundInstruments_.size(), 1);
+
+  // Nothing changed, so nothing is collected
+  EXPECT_EQ(alpha.GetRecords().size(), 0);
+
+  beta->add(5);
+  records = alpha.GetRecords();
+  ASSERT_EQ(records.size(), 1);
+  EXPECT_EQ(records[0].GetLabels(), "{\"key\":\"value\"}");
+  EXPECT_EQ(records[0].GetLabelSet(), LabelSet(labelkv));
+  auto values = nostd::get<std::shared_ptr<Aggregator<int>>>(records[0].GetAggregator())
+                    ->get_checkpoint();
+  EXPECT_EQ(values[0], 5);
+
+  // Unbinding the last reference reports the series once more, then removes it
+  beta->unbind();
+  records = alpha.GetRecords();
+  ASSERT_EQ(records.size(), 1);
+  EXPECT_EQ(alpha.boundInstruments_.size(), 0);
+}
+
+TEST(Counter, GetRecordsWhileAdding)
+{
+  Counter<int> alpha("test", "none", "unitless", true);
+
+  std::map<std::string, std::string> labels  = {{"key", "value"}};
+  std::map<std::string, std::string> labels1 = {{"key1", "value1"}};
+
+  auto labelkv  = trace::KeyValueIterableView<decltype(labels)>{labels};
+  auto labelkv1 = trace::KeyValueIterableView<decltype(labels1)>{labels1};
+
+  auto beta = alpha.bindCounter(labelkv);
+  std::thread first([&beta] {
+    for (int i = 0; i < 100000; i++)
+    {
+      beta->add(1);
+    }
+  });
+  std::thread second([&alpha, &labelkv1] {
+    for (int i = 0; i < 100000; i++)
+    {
+      alpha.add(1, labelkv1);
+    }
+  });
+
+  // Every add must be collected exactly once, whichever collection it lands in
+  int sum = 0;
+  auto collect = [&alpha, &sum] {
+    for (auto &record : alpha.GetRecords())
+    {
+      sum += nostd::get<std::shared_ptr<Aggregator<int>>>(record.GetAggregator())
+                 ->get_checkpoint()[0];
+    }
+  };
+  for (int i = 0; i < 1000; i++)
+  {
+    collect();
+  }
+  first.join();
+  second.join();
+  collect();
+
+  EXPECT_EQ(sum, 2 * 100000);
+}
+
 void CounterCallback(std::shared_ptr<Counter<int>> in,
                      int freq,
                      const trace::KeyValueIterable &labels)
@@ -288,14 +371,8 @@ TEST(Counter, StressAdd)
   second.join();
   third.join();
 
-  EXPECT_EQ(dynamic_cast<BoundCounter<int> *>(alpha->boundInstruments_[KvToString(labelkv)].get())
-                ->GetAggregator()
-                ->get_values()[0],
-            2000);
-  EXPECT_EQ(dynamic_cast<BoundCounter<int> *>(alpha->boundInstruments_[KvToString(labelkv1)].get())
-                ->GetAggregator()
-                ->get_values()[0],
-            3000);
+  EXPECT_EQ(alpha->boundInstruments_[LabelSet(labelkv)]->GetAggregator()->get_values()[0], 2000);
+  EXPECT_EQ(alpha->boundInstruments_[LabelSet(labelkv1)]->GetAggregator()->get_values()[0], 3000);
 }
 
 void UpDownCounterCallback(std::shared_ptr<UpDownCounter<int>> in,
@@ -339,16 +416,10 @@ TEST(IntUpDownCounter, StressAdd)
   third.join();
   fourth.join();
 
-  EXPECT_EQ(
-      dynamic_cast<BoundUpDownCounter<int> *>(alpha->boundInstruments_[KvToString(labelkv)].get())
-          ->GetAggregator()
-          ->get_values()[0],
-      12340 * 2);
-  EXPECT_EQ(
-      dynamic_cast<BoundUpDownCounter<int> *>(alpha->boundInstruments_[KvToString(labelkv1)].get())
-          ->GetAggregator()
-          ->get_values()[0],
-      56780 - 12340);
+  auto values = alpha->boundInstruments_[LabelSet(labelkv)]->GetAggregator()->get_values();
+  EXPECT_EQ(values[0], 12340 * 2);
+  values = alpha->boundInstruments_[LabelSet(labelkv1)]->GetAggregator()->get_values();
+  EXPECT_EQ(values[0], 56780 - 12340);
 }
 
 void RecorderCallback(std::shared_ptr<ValueRecorder<int>> in,
@@ -392,47 +463,17 @@ TEST(IntValueRecorder, StressRecord)
   third.join();
   fourth.join();
 
-  EXPECT_EQ(
-      dynamic_cast<BoundValueRecorder<int> *>(alpha->boundInstruments_[KvToString(labelkv)].get())
-          ->GetAggregator()
-          ->get_values()[0],
-      0);  // min
-  EXPECT_EQ(
-      dynamic_cast<BoundValueRecorder<int> *>(alpha->boundInstruments_[KvToString(labelkv)].get())
-          ->GetAggregator()
-          ->get_values()[1],
-      49);  // max
-  EXPECT_EQ(
-      dynamic_cast<BoundValueRecorder<int> *>(alpha->boundInstruments_[KvToString(labelkv)].get())
-          ->GetAggregator()
-          ->get_values()[2],
-      1525);  // sum
-  EXPECT_EQ(
-      dynamic_cast<BoundValueRecorder<int> *>(alpha->boundInstruments_[KvToString(labelkv)].get())
-          ->GetAggregator()
-          ->get_values()[3],
-      75);  // count
-
-  EXPECT_EQ(
-      dynamic_cast<BoundValueRecorder<int> *>(alpha->boundInstruments_[KvToString(labelkv1)].get())
-          ->GetAggregator()
-          ->get_values()[0],
-      -99);  // min
-  EXPECT_EQ(
-      dynamic_cast<BoundValueRecorder<int> *>(alpha->boundInstruments_[KvToString(labelkv1)].get())
-          ->GetAggregator()
-          ->get_values()[1],
-      24);  // max
-  EXPECT_EQ(
-      dynamic_cast<BoundValueRecorder<int> *>(alpha->boundInstruments_[KvToString(labelkv1)].get())
-          ->GetAggregator()
-          ->get_values()[2],
-      -4650);  // sum
-  EXPECT_EQ(
-      dynamic_cast<BoundValueRecorder<int> *>(alpha->boundInstruments_[KvToString(labelkv1)].get())
-          ->GetAggregator()
-          ->get_values()[3],
-      125);  // count
+  auto values = alpha->boundInstruments_[LabelSet(labelkv)]->GetAggregator()->get_values();
+  EXPECT_EQ(values[0], 0);     // min
+  EXPECT_EQ(values[1], 49);    // max
+  EXPECT_EQ(values[2], 1525);  // sum
+  EXPECT_EQ(values[3], 75);    // count
+
+  values = alpha->boundInstruments_[LabelSet(labelkv1)]->GetAggregator()->get_values();
+  EXPECT_EQ(values[0], -99);    // min
+  EXPECT_EQ(values[1], 24);     // max
+  EXPECT_EQ(values[2], -4650);  // sum
+  EXPECT_EQ(values[3], 125);    // count
 }
 
 }  // namespace metrics
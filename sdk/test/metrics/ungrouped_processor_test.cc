@@ -1,9 +1,12 @@
 #include "opentelemetry/sdk/metrics/ungrouped_processor.h"
 #include "opentelemetry/nostd/shared_ptr.h"
 #include "opentelemetry/sdk/metrics/aggregator/counter_aggregator.h"
+#include "opentelemetry/trace/key_value_iterable_view.h"
 
 #include <gtest/gtest.h>
 
+#include <map>
+
 namespace sdkmetrics  = opentelemetry::sdk::metrics;
 namespace metrics_api = opentelemetry::metrics;
 namespace nostd       = opentelemetry::nostd;
@@ -620,3 +623,29 @@ TEST(UngroupedMetricsProcessor, UngroupedProcessorKeepsRecordInformationStateful
                 ->get_checkpoint(),
             test_aggregator->get_checkpoint());
 }
+
+// Test that the label set of a record is kept in the checkpoint
+TEST(UngroupedMetricsProcessor, UngroupedProcessorKeepsLabelSet)
+{
+  auto processor = std::unique_ptr<sdkmetrics::MetricsProcessor>(
+      new opentelemetry::sdk::metrics::UngroupedMetricsProcessor(true));
+
+  auto aggregator = std::shared_ptr<opentelemetry::sdk::metrics::Aggregator<int>>(
+      new opentelemetry::sdk::metrics::CounterAggregator<int>(
+          metrics_api::InstrumentKind::Counter));
+
+  aggregator->update(4);
+  aggregator->checkpoint();
+
+  std::map<std::string, std::string> labels = {{"key", "value"}};
+  sdkmetrics::LabelSet label_set{
+      opentelemetry::trace::KeyValueIterableView<decltype(labels)>{labels}};
+  sdkmetrics::Record r("name", "description", label_set.ToString(), label_set, aggregator);
+
+  processor->process(r);
+  processor->process(r);
+  std::vector<sdkmetrics::Record> checkpoint = processor->CheckpointSelf();
+  ASSERT_EQ(checkpoint.size(), 1);
+  EXPECT_EQ(checkpoint[0].GetLabels(), "{\"key\":\"value\"}");
+  EXPECT_EQ(checkpoint[0].GetLabelSet(), label_set);
+}
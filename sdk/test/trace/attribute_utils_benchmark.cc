@@ -0,0 +1,65 @@
+#include "opentelemetry/sdk/trace/attribute_utils.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+using opentelemetry::sdk::trace::AttributeConverter;
+using opentelemetry::sdk::trace::FlatAttributeMap;
+using opentelemetry::sdk::trace::SpanDataAttributeValue;
+namespace nostd  = opentelemetry::nostd;
+namespace common = opentelemetry::common;
+
+namespace
+{
+std::vector<std::string> MakeKeys(int num_attributes)
+{
+  std::vector<std::string> keys;
+  for (int i = 0; i < num_attributes; ++i)
+  {
+    keys.push_back("attribute.key." + std::to_string(i));
+  }
+  return keys;
+}
+
+// The unordered_map that AttributeMap used to store attributes in, used as a baseline
+void BM_UnorderedMapSetAttributes(benchmark::State &state)
+{
+  auto keys = MakeKeys(static_cast<int>(state.range(0)));
+  AttributeConverter converter;
+  for (auto _ : state)
+  {
+    std::unordered_map<std::string, SpanDataAttributeValue> attributes;
+    for (auto &key : keys)
+    {
+      common::AttributeValue value = static_cast<int64_t>(42);
+      attributes[std::string(nostd::string_view(key))] = nostd::visit(converter, value);
+    }
+    benchmark::DoNotOptimize(attributes);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(BM_UnorderedMapSetAttributes)->Arg(1)->Arg(8)->Arg(32)->Arg(128);
+
+void BM_FlatAttributeMapSetAttributes(benchmark::State &state)
+{
+  auto keys = MakeKeys(static_cast<int>(state.range(0)));
+  AttributeConverter converter;
+  for (auto _ : state)
+  {
+    FlatAttributeMap attributes;
+    for (auto &key : keys)
+    {
+      common::AttributeValue value = static_cast<int64_t>(42);
+      attributes[nostd::string_view(key)] = nostd::visit(converter, value);
+    }
+    benchmark::DoNotOptimize(attributes);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(BM_FlatAttributeMapSetAttributes)->Arg(1)->Arg(8)->Arg(32)->Arg(128);
+}  // namespace
+
+BENCHMARK_MAIN();
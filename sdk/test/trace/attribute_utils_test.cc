@@ -25,3 +25,88 @@ TEST(AttributeMapTest, AttributesConstruction)
     EXPECT_EQ(opentelemetry::nostd::get<int>(map.GetAttributes().at(keys[i])), values[i]);
   }
 }
+
+TEST(AttributeMapTest, Overwrite)
+{
+  opentelemetry::sdk::trace::AttributeMap map;
+  map.SetAttribute("attr1", 1);
+  map.SetAttribute("attr2", 2);
+  map.SetAttribute("attr1", "one");
+
+  EXPECT_EQ(map.GetAttributes().size(), 2);
+  EXPECT_EQ(opentelemetry::nostd::get<std::string>(map.GetAttributes().at("attr1")), "one");
+  EXPECT_EQ(opentelemetry::nostd::get<int>(map.GetAttributes().at("attr2")), 2);
+}
+
+TEST(FlatAttributeMapTest, Clear)
+{
+  opentelemetry::sdk::trace::FlatAttributeMap map;
+  map["attr1"] = 1;
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.count("attr1"), 0);
+
+  map["attr2"] = 2;
+  EXPECT_EQ(map.size(), 1);
+  EXPECT_EQ(opentelemetry::nostd::get<int>(map.at("attr2")), 2);
+
+  // Attributes added after clearing start out with a default value
+  map.clear();
+  EXPECT_EQ(map["attr2"], opentelemetry::sdk::trace::SpanDataAttributeValue{});
+}
+
+TEST(FlatAttributeMapTest, OwnedAndInternedKeys)
+{
+  using opentelemetry::sdk::common::InternedString;
+  opentelemetry::sdk::trace::FlatAttributeMap map;
+  for (int i = 0; i < 16; i++)
+  {
+    map["attr" + std::to_string(i)] = static_cast<int64_t>(i);
+  }
+
+  // A key that couldn't be interned finds the entry of the same key that could
+  const std::string key = "an attribute key that isn't interned yet";
+  map[InternedString::Lookup(key)] = static_cast<int64_t>(1);
+  map[InternedString{key}]         = static_cast<int64_t>(2);
+  EXPECT_EQ(map.size(), 17);
+  EXPECT_EQ(opentelemetry::nostd::get<int64_t>(map.at(key)), 2);
+}
+
+TEST(FlatAttributeMapTest, IndexedPastLinearScanLimit)
+{
+  const int kNumAttributes =
+      static_cast<int>(opentelemetry::sdk::trace::FlatAttributeMap::kLinearScanLimit) * 3;
+  opentelemetry::sdk::trace::FlatAttributeMap map;
+  for (int round = 0; round < 2; ++round)
+  {
+    for (int i = 0; i < kNumAttributes; i++)
+    {
+      map["attr" + std::to_string(i)] = static_cast<int64_t>(i);
+    }
+    // Overwriting doesn't add entries
+    for (int i = 0; i < kNumAttributes; i++)
+    {
+      map["attr" + std::to_string(i)] = static_cast<int64_t>(i * 2);
+    }
+    EXPECT_EQ(map.size(), kNumAttributes);
+
+    // Iteration is in insertion order
+    int i = 0;
+    for (auto &kv : map)
+    {
+      EXPECT_EQ(kv.first, "attr" + std::to_string(i));
+      EXPECT_EQ(opentelemetry::nostd::get<int64_t>(kv.second), i * 2);
+      ++i;
+    }
+    EXPECT_EQ(i, kNumAttributes);
+    EXPECT_EQ(opentelemetry::nostd::get<int64_t>(map.at("attr20")), 40);
+    EXPECT_EQ(map.find("attr3")->first, "attr3");
+    EXPECT_EQ(map.count("attr23"), 1);
+    EXPECT_EQ(map.find("missing"), map.end());
+    EXPECT_THROW(map.at("missing"), std::out_of_range);
+
+    map.clear();
+    EXPECT_EQ(map.size(), 0);
+    EXPECT_EQ(map.begin(), map.end());
+  }
+}
@@ -0,0 +1,114 @@
+#include "opentelemetry/sdk/trace/batch_span_processor.h"
+#include "opentelemetry/sdk/trace/span_data.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+using namespace opentelemetry::sdk::trace;
+namespace nostd = opentelemetry::nostd;
+
+namespace
+{
+const int kNumSpans = 64;
+
+/**
+ * An exporter that takes a fixed time to export each batch, as a remote backend would.
+ */
+class DelayedSpanExporter final : public SpanExporter
+{
+public:
+  explicit DelayedSpanExporter(std::chrono::microseconds export_delay,
+                               std::atomic<uint64_t> &num_exports) noexcept
+      : export_delay_(export_delay), num_exports_(num_exports)
+  {}
+
+  std::unique_ptr<Recordable> MakeRecordable() noexcept override
+  {
+    return std::unique_ptr<Recordable>(new SpanData);
+  }
+
+  ExportResult Export(const nostd::span<std::unique_ptr<Recordable>> &) noexcept override
+  {
+    ++num_exports_;
+    std::this_thread::sleep_for(export_delay_);
+    return ExportResult::kSuccess;
+  }
+
+  void Shutdown(std::chrono::microseconds timeout = std::chrono::microseconds(0)) noexcept override
+  {}
+
+private:
+  const std::chrono::microseconds export_delay_;
+  std::atomic<uint64_t> &num_exports_;
+};
+
+void EndSpans(BatchSpanProcessor &processor)
+{
+  for (int i = 0; i < kNumSpans; ++i)
+  {
+    processor.OnEnd(processor.MakeRecordable());
+  }
+}
+
+// CPU time used by the whole process while ForceFlush waits for an export that takes N
+// milliseconds. Compare the CPU time to the wall time to see how much of the wait is spent
+// spinning.
+void BM_BatchSpanProcessorForceFlush(benchmark::State &state)
+{
+  std::atomic<uint64_t> num_exports{0};
+  BatchSpanProcessor processor{
+      std::unique_ptr<SpanExporter>(
+          new DelayedSpanExporter(std::chrono::milliseconds(state.range(0)), num_exports)),
+      BatchSpanProcessorOptions{}};
+
+  for (auto _ : state)
+  {
+    EndSpans(processor);
+    processor.ForceFlush();
+  }
+}
+BENCHMARK(BM_BatchSpanProcessorForceFlush)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(10)
+    ->MeasureProcessCPUTime()
+    ->UseRealTime();
+
+// N threads call ForceFlush at the same time while a 1 millisecond export is in progress; reports
+// how many exports each round of flushes took.
+void BM_BatchSpanProcessorConcurrentForceFlush(benchmark::State &state)
+{
+  std::atomic<uint64_t> num_exports{0};
+  BatchSpanProcessor processor{std::unique_ptr<SpanExporter>(new DelayedSpanExporter(
+                                   std::chrono::milliseconds(1), num_exports)),
+                               BatchSpanProcessorOptions{}};
+
+  const int num_callers = static_cast<int>(state.range(0));
+  std::vector<std::thread> callers(num_callers);
+  for (auto _ : state)
+  {
+    EndSpans(processor);
+    for (auto &caller : callers)
+    {
+      caller = std::thread{[&] { processor.ForceFlush(); }};
+    }
+    for (auto &caller : callers)
+    {
+      caller.join();
+    }
+  }
+  state.counters["exports_per_round"] =
+      benchmark::Counter(static_cast<double>(num_exports.load()), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_BatchSpanProcessorConcurrentForceFlush)
+    ->Arg(1)
+    ->Arg(4)
+    ->MeasureProcessCPUTime()
+    ->UseRealTime();
+}  // namespace
+
+BENCHMARK_MAIN();
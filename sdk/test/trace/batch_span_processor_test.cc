@@ -4,7 +4,10 @@
 #include "opentelemetry/sdk/trace/tracer.h"
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 
 OPENTELEMETRY_BEGIN_NAMESPACE
@@ -68,6 +71,81 @@ private:
   const std::chrono::milliseconds export_delay_;
 };
 
+/**
+ * A mock span exporter whose exports block until they're released, for simulating a slow backend
+ */
+class MockBlockingSpanExporter final : public sdk::trace::SpanExporter
+{
+public:
+  struct State
+  {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool is_released           = false;
+    int num_exports_started    = 0;
+    int num_exports_running    = 0;
+    int max_exports_running    = 0;
+    size_t num_spans_received  = 0;
+    int num_recordables_made   = 0;
+    std::vector<std::string> span_names_received;
+
+    void Release()
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      is_released = true;
+      cv.notify_all();
+    }
+
+    bool WaitForExportsStarted(int n)
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      return cv.wait_for(lock, std::chrono::seconds(5),
+                         [&] { return num_exports_started >= n; });
+    }
+  };
+
+  explicit MockBlockingSpanExporter(std::shared_ptr<State> state,
+                                    bool supports_concurrent_export = true) noexcept
+      : state_(state), supports_concurrent_export_(supports_concurrent_export)
+  {}
+
+  std::unique_ptr<sdk::trace::Recordable> MakeRecordable() noexcept override
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    ++state_->num_recordables_made;
+    return std::unique_ptr<sdk::trace::Recordable>(new sdk::trace::SpanData);
+  }
+
+  sdk::trace::ExportResult Export(
+      const nostd::span<std::unique_ptr<sdk::trace::Recordable>> &recordables) noexcept override
+  {
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    ++state_->num_exports_started;
+    ++state_->num_exports_running;
+    state_->max_exports_running =
+        std::max(state_->max_exports_running, state_->num_exports_running);
+    state_->cv.notify_all();
+    state_->cv.wait(lock, [&] { return state_->is_released; });
+    state_->num_spans_received += recordables.size();
+    for (auto &recordable : recordables)
+    {
+      auto span = static_cast<sdk::trace::SpanData *>(recordable.get());
+      state_->span_names_received.push_back(std::string(span->GetName()));
+    }
+    --state_->num_exports_running;
+    return sdk::trace::ExportResult::kSuccess;
+  }
+
+  bool SupportsConcurrentExport() const noexcept override { return supports_concurrent_export_; }
+
+  void Shutdown(std::chrono::microseconds timeout = std::chrono::microseconds(0)) noexcept override
+  {}
+
+private:
+  std::shared_ptr<State> state_;
+  bool supports_concurrent_export_;
+};
+
 /**
  * Fixture Class
  */
@@ -89,6 +167,13 @@ public:
         max_queue_size, schedule_delay_millis, max_export_batch_size));
   }
 
+  void EndTestSpans(std::shared_ptr<sdk::trace::SpanProcessor> processor, const int num_spans)
+  {
+    auto test_spans = GetTestSpans(processor, num_spans);
+    processor->OnEndBatch(nostd::span<std::unique_ptr<sdk::trace::Recordable>>(
+        test_spans->data(), test_spans->size()));
+  }
+
   std::unique_ptr<std::vector<std::unique_ptr<sdk::trace::Recordable>>> GetTestSpans(
       std::shared_ptr<sdk::trace::SpanProcessor> processor,
       const int num_spans)
@@ -106,6 +191,49 @@ public:
     return test_spans;
   }
 
+  /**
+   * Waits until the worker thread has taken every queued span.
+   * @return false if it didn't within 5 seconds
+   */
+  bool WaitForEmptyQueue(std::shared_ptr<sdk::trace::SpanProcessor> processor)
+  {
+    auto &batch_processor = static_cast<sdk::trace::BatchSpanProcessor &>(*processor);
+    auto deadline         = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (batch_processor.QueueSize() > 0)
+    {
+      if (std::chrono::steady_clock::now() > deadline)
+      {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    return true;
+  }
+
+  /**
+   * Stops the processor's schedule clock, so that only UpdateSchedule below advances it. The
+   * worker thread's own updates appear to go back in time, and are ignored.
+   */
+  void StopScheduleClock(sdk::trace::BatchSpanProcessor &processor)
+  {
+    std::lock_guard<std::mutex> lock(processor.schedule_m_);
+    processor.last_update_time_ = std::chrono::steady_clock::now() + std::chrono::hours(1);
+  }
+
+  /**
+   * Updates the processor's schedule as if elapsed had passed since the last update.
+   */
+  void UpdateSchedule(sdk::trace::BatchSpanProcessor &processor,
+                      std::chrono::milliseconds elapsed)
+  {
+    std::chrono::steady_clock::time_point now;
+    {
+      std::lock_guard<std::mutex> lock(processor.schedule_m_);
+      now = processor.last_update_time_ + elapsed;
+    }
+    processor.UpdateSchedule(now);
+  }
+
 private:
   std::unique_ptr<sdk::trace::SpanExporter> GetMockExporter(
       std::shared_ptr<std::vector<std::unique_ptr<sdk::trace::SpanData>>> spans_received,
@@ -194,6 +322,62 @@ TEST_F(BatchSpanProcessorTestPeer, TestForceFlush)
   }
 }
 
+TEST_F(BatchSpanProcessorTestPeer, TestForceFlushTimeout)
+{
+  /* Test that ForceFlush gives up waiting once the timeout expires */
+
+  auto state = std::make_shared<MockBlockingSpanExporter::State>();
+  std::shared_ptr<sdk::trace::SpanProcessor> batch_processor(new sdk::trace::BatchSpanProcessor(
+      std::unique_ptr<sdk::trace::SpanExporter>(new MockBlockingSpanExporter(state)),
+      sdk::trace::BatchSpanProcessorOptions{}));
+  const int num_spans = 10;
+
+  EndTestSpans(batch_processor, num_spans);
+
+  auto start = std::chrono::steady_clock::now();
+  batch_processor->ForceFlush(std::chrono::milliseconds(100));
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_GE(elapsed, std::chrono::milliseconds(100));
+  EXPECT_LT(elapsed, std::chrono::seconds(5));
+  EXPECT_TRUE(state->WaitForExportsStarted(1));
+
+  state->Release();
+  batch_processor->ForceFlush();
+
+  std::lock_guard<std::mutex> lock(state->mutex);
+  EXPECT_EQ(num_spans, state->num_spans_received);
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestConcurrentForceFlush)
+{
+  /* Test that concurrent ForceFlush calls all return once their spans are exported */
+
+  std::shared_ptr<std::atomic<bool>> is_shutdown(new std::atomic<bool>(false));
+  std::shared_ptr<std::atomic<bool>> is_export_completed(new std::atomic<bool>(false));
+  std::shared_ptr<std::vector<std::unique_ptr<sdk::trace::SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<sdk::trace::SpanData>>);
+
+  auto batch_processor = GetMockProcessor(spans_received, is_shutdown, is_export_completed,
+                                          std::chrono::milliseconds(20));
+  const int num_threads         = 4;
+  const int num_spans_per_flush = 10;
+
+  std::vector<std::thread> flushers;
+  for (int i = 0; i < num_threads; ++i)
+  {
+    flushers.emplace_back([&] {
+      EndTestSpans(batch_processor, num_spans_per_flush);
+      batch_processor->ForceFlush();
+    });
+  }
+  for (auto &flusher : flushers)
+  {
+    flusher.join();
+  }
+
+  EXPECT_EQ(num_threads * num_spans_per_flush, spans_received->size());
+}
+
 TEST_F(BatchSpanProcessorTestPeer, TestManySpansLoss)
 {
   /* Test that when exporting more than max_queue_size spans, some are most likely lost*/
@@ -292,4 +476,578 @@ TEST_F(BatchSpanProcessorTestPeer, TestScheduleDelayMillis)
   }
 }
 
+TEST_F(BatchSpanProcessorTestPeer, TestShardedQueueManyProducers)
+{
+  /* Test that no spans are lost when several threads end spans into a sharded queue */
+
+  std::shared_ptr<std::atomic<bool>> is_shutdown(new std::atomic<bool>(false));
+  std::shared_ptr<std::atomic<bool>> is_export_completed(new std::atomic<bool>(false));
+  std::shared_ptr<std::vector<std::unique_ptr<sdk::trace::SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<sdk::trace::SpanData>>);
+
+  const int num_threads          = 4;
+  const int num_spans_per_thread = 256;
+
+  sdk::trace::BatchSpanProcessorOptions options;
+  options.num_queue_shards = num_threads;
+  std::shared_ptr<sdk::trace::SpanProcessor> batch_processor(new sdk::trace::BatchSpanProcessor(
+      std::unique_ptr<sdk::trace::SpanExporter>(
+          new MockSpanExporter(spans_received, is_shutdown, is_export_completed)),
+      options));
+
+  std::vector<std::unique_ptr<std::vector<std::unique_ptr<sdk::trace::Recordable>>>> test_spans;
+  for (int i = 0; i < num_threads; ++i)
+  {
+    test_spans.push_back(GetTestSpans(batch_processor, num_spans_per_thread));
+  }
+
+  std::vector<std::thread> producers;
+  for (int i = 0; i < num_threads; ++i)
+  {
+    producers.emplace_back([&, i] {
+      for (auto &span : *test_spans[i])
+      {
+        batch_processor->OnEnd(std::move(span));
+      }
+    });
+  }
+  for (auto &producer : producers)
+  {
+    producer.join();
+  }
+
+  batch_processor->ForceFlush();
+
+  EXPECT_EQ(num_threads * num_spans_per_thread, spans_received->size());
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestOnEndBatch)
+{
+  std::shared_ptr<std::atomic<bool>> is_shutdown(new std::atomic<bool>(false));
+  std::shared_ptr<std::vector<std::unique_ptr<sdk::trace::SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<sdk::trace::SpanData>>);
+
+  const int num_spans  = 100;
+  const int queue_size = 64;
+  auto batch_processor =
+      GetMockProcessor(spans_received, is_shutdown, std::make_shared<std::atomic<bool>>(false),
+                       std::chrono::milliseconds(0), std::chrono::milliseconds(5000), queue_size);
+
+  // Spans that don't fit into the queue are dropped
+  auto test_spans = GetTestSpans(batch_processor, num_spans);
+  batch_processor->OnEndBatch(nostd::span<std::unique_ptr<sdk::trace::Recordable>>(
+      test_spans->data(), test_spans->size()));
+  batch_processor->ForceFlush();
+
+  ASSERT_EQ(queue_size, spans_received->size());
+  for (int i = 0; i < queue_size; ++i)
+  {
+    EXPECT_EQ("Span " + std::to_string(i), spans_received->at(i)->GetName());
+  }
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestBorrowedAttributesMaterialized)
+{
+  /* Test that spans are exported with copies of their borrowed attributes */
+
+  std::shared_ptr<std::atomic<bool>> is_shutdown(new std::atomic<bool>(false));
+  std::shared_ptr<std::vector<std::unique_ptr<sdk::trace::SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<sdk::trace::SpanData>>);
+
+  auto batch_processor = GetMockProcessor(spans_received, is_shutdown);
+
+  std::string value = "borrowed";
+  auto test_spans   = GetTestSpans(batch_processor, 2);
+  for (auto &span : *test_spans)
+  {
+    span->SetBorrowedAttribute("attr", nostd::string_view{value});
+  }
+  batch_processor->OnEnd(std::move(test_spans->at(0)));
+  batch_processor->OnEndBatch(
+      nostd::span<std::unique_ptr<sdk::trace::Recordable>>(&test_spans->at(1), 1));
+  value = "changed";
+  batch_processor->ForceFlush();
+
+  ASSERT_EQ(2, spans_received->size());
+  for (auto &span : *spans_received)
+  {
+    EXPECT_EQ("borrowed", nostd::get<std::string>(span->GetAttributes().at("attr")));
+  }
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestPipelinedExportSlowExporter)
+{
+  /* Test that the queue keeps being drained while an export is in progress, until
+     max_in_flight_batches batches are waiting to be exported */
+
+  auto state      = std::make_shared<MockBlockingSpanExporter::State>();
+  const int batch = 16;
+
+  sdk::trace::BatchSpanProcessorOptions options;
+  options.max_queue_size        = batch;
+  options.max_export_batch_size = batch;
+  options.num_export_threads    = 1;
+  options.max_in_flight_batches = 2;
+  std::shared_ptr<sdk::trace::SpanProcessor> batch_processor(new sdk::trace::BatchSpanProcessor(
+      std::unique_ptr<sdk::trace::SpanExporter>(new MockBlockingSpanExporter(state)), options));
+
+  // The first batch is being exported, and the second one is waiting for it.
+  EndTestSpans(batch_processor, batch);
+  ASSERT_TRUE(state->WaitForExportsStarted(1));
+  EndTestSpans(batch_processor, batch);
+  ASSERT_TRUE(WaitForEmptyQueue(batch_processor));
+
+  // The third batch is drained, but the worker thread can't hand it over.
+  EndTestSpans(batch_processor, batch);
+  ASSERT_TRUE(WaitForEmptyQueue(batch_processor));
+
+  // The fourth batch fills the queue, and the fifth is dropped.
+  EndTestSpans(batch_processor, batch);
+  EndTestSpans(batch_processor, batch);
+
+  state->Release();
+  batch_processor->ForceFlush();
+
+  std::lock_guard<std::mutex> lock(state->mutex);
+  EXPECT_EQ(4 * batch, state->num_spans_received);
+  EXPECT_EQ(1, state->max_exports_running);
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestConcurrentExports)
+{
+  /* Test that up to num_export_threads batches are exported at the same time */
+
+  auto state      = std::make_shared<MockBlockingSpanExporter::State>();
+  const int batch = 16;
+
+  sdk::trace::BatchSpanProcessorOptions options;
+  options.max_queue_size        = 4 * batch;
+  options.max_export_batch_size = batch;
+  options.num_export_threads    = 2;
+  options.max_in_flight_batches = 4;
+  std::shared_ptr<sdk::trace::SpanProcessor> batch_processor(new sdk::trace::BatchSpanProcessor(
+      std::unique_ptr<sdk::trace::SpanExporter>(new MockBlockingSpanExporter(state)), options));
+
+  EndTestSpans(batch_processor, 4 * batch);
+  ASSERT_TRUE(state->WaitForExportsStarted(2));
+
+  state->Release();
+  batch_processor->Shutdown();
+
+  std::lock_guard<std::mutex> lock(state->mutex);
+  EXPECT_EQ(4 * batch, state->num_spans_received);
+  EXPECT_EQ(2, state->max_exports_running);
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestConcurrentExportsUnsupported)
+{
+  /* Test that an exporter that doesn't support concurrent exports gets a single export thread */
+
+  auto state      = std::make_shared<MockBlockingSpanExporter::State>();
+  const int batch = 16;
+
+  sdk::trace::BatchSpanProcessorOptions options;
+  options.max_queue_size        = 4 * batch;
+  options.max_export_batch_size = batch;
+  options.num_export_threads    = 2;
+  options.max_in_flight_batches = 4;
+  std::shared_ptr<sdk::trace::SpanProcessor> batch_processor(new sdk::trace::BatchSpanProcessor(
+      std::unique_ptr<sdk::trace::SpanExporter>(new MockBlockingSpanExporter(state, false)),
+      options));
+
+  EndTestSpans(batch_processor, 4 * batch);
+  ASSERT_TRUE(state->WaitForExportsStarted(1));
+
+  state->Release();
+  batch_processor->Shutdown();
+
+  std::lock_guard<std::mutex> lock(state->mutex);
+  EXPECT_EQ(4 * batch, state->num_spans_received);
+  EXPECT_EQ(1, state->max_exports_running);
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestPipelinedExportShutdown)
+{
+  /* Test that shutting down exports every span in order when export is pipelined */
+
+  std::shared_ptr<std::atomic<bool>> is_shutdown(new std::atomic<bool>(false));
+  std::shared_ptr<std::atomic<bool>> is_export_completed(new std::atomic<bool>(false));
+  std::shared_ptr<std::vector<std::unique_ptr<sdk::trace::SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<sdk::trace::SpanData>>);
+
+  const int num_spans = 200;
+
+  sdk::trace::BatchSpanProcessorOptions options;
+  options.max_export_batch_size = 16;
+  options.num_export_threads    = 1;
+  std::shared_ptr<sdk::trace::SpanProcessor> batch_processor(new sdk::trace::BatchSpanProcessor(
+      std::unique_ptr<sdk::trace::SpanExporter>(new MockSpanExporter(
+          spans_received, is_shutdown, is_export_completed, std::chrono::milliseconds(10))),
+      options));
+
+  auto test_spans = GetTestSpans(batch_processor, num_spans);
+  for (int i = 0; i < num_spans; ++i)
+  {
+    batch_processor->OnEnd(std::move(test_spans->at(i)));
+  }
+
+  batch_processor->Shutdown();
+
+  EXPECT_TRUE(is_shutdown->load());
+  ASSERT_EQ(num_spans, spans_received->size());
+  for (int i = 0; i < num_spans; ++i)
+  {
+    EXPECT_EQ("Span " + std::to_string(i), spans_received->at(i)->GetName());
+  }
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestScheduleStatsWithoutAdaptiveScheduling)
+{
+  /* Test that the configured batch size and delay are kept, while the arrival rate is measured */
+
+  std::shared_ptr<std::atomic<bool>> is_shutdown(new std::atomic<bool>(false));
+  std::shared_ptr<std::vector<std::unique_ptr<sdk::trace::SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<sdk::trace::SpanData>>);
+
+  sdk::trace::BatchSpanProcessorOptions options;
+  options.max_queue_size        = 64;
+  options.max_export_batch_size = 16;
+  auto batch_processor          = std::make_shared<sdk::trace::BatchSpanProcessor>(
+      std::unique_ptr<sdk::trace::SpanExporter>(new MockSpanExporter(
+          spans_received, is_shutdown, std::make_shared<std::atomic<bool>>(false))),
+      options);
+
+  StopScheduleClock(*batch_processor);
+  EndTestSpans(batch_processor, 10);
+  UpdateSchedule(*batch_processor, std::chrono::milliseconds(10));
+
+  auto stats = batch_processor->GetScheduleStats();
+  EXPECT_EQ(16, stats.export_batch_size);
+  EXPECT_EQ(options.schedule_delay_millis, stats.schedule_delay);
+  EXPECT_EQ(32, stats.wake_threshold);
+  EXPECT_DOUBLE_EQ(1000, stats.arrival_rate);
+  EXPECT_EQ(0, stats.drop_ratio);
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestAdaptiveSchedulingLowRate)
+{
+  /* Test that a trickle of spans is collected into small batches at the longest delay */
+
+  std::shared_ptr<std::atomic<bool>> is_shutdown(new std::atomic<bool>(false));
+  std::shared_ptr<std::vector<std::unique_ptr<sdk::trace::SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<sdk::trace::SpanData>>);
+
+  sdk::trace::BatchSpanProcessorOptions options;
+  options.adaptive_scheduling       = true;
+  options.max_export_batch_size     = 512;
+  options.min_export_batch_size     = 8;
+  options.schedule_delay_millis     = std::chrono::milliseconds(1000);
+  options.min_schedule_delay_millis = std::chrono::milliseconds(10);
+  auto batch_processor              = std::make_shared<sdk::trace::BatchSpanProcessor>(
+      std::unique_ptr<sdk::trace::SpanExporter>(new MockSpanExporter(
+          spans_received, is_shutdown, std::make_shared<std::atomic<bool>>(false))),
+      options);
+
+  // 100 spans per second
+  StopScheduleClock(*batch_processor);
+  for (int i = 0; i < 10; ++i)
+  {
+    EndTestSpans(batch_processor, 5);
+    UpdateSchedule(*batch_processor, std::chrono::milliseconds(50));
+  }
+
+  // A batch holds the spans that arrive within the longest delay
+  auto stats = batch_processor->GetScheduleStats();
+  EXPECT_DOUBLE_EQ(100, stats.arrival_rate);
+  EXPECT_EQ(100, stats.export_batch_size);
+  EXPECT_EQ(std::chrono::milliseconds(1000), stats.schedule_delay);
+  EXPECT_EQ(100, stats.wake_threshold);
+  EXPECT_EQ(0, stats.drop_ratio);
+
+  batch_processor->ForceFlush();
+  EXPECT_EQ(50, spans_received->size());
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestAdaptiveSchedulingHighRate)
+{
+  /* Test that a flood of spans that overflows the queue is exported in the largest batches as
+     often as allowed */
+
+  std::shared_ptr<std::atomic<bool>> is_shutdown(new std::atomic<bool>(false));
+  std::shared_ptr<std::vector<std::unique_ptr<sdk::trace::SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<sdk::trace::SpanData>>);
+
+  sdk::trace::BatchSpanProcessorOptions options;
+  options.adaptive_scheduling       = true;
+  options.max_queue_size            = 256;
+  options.max_export_batch_size     = 128;
+  options.min_export_batch_size     = 8;
+  options.schedule_delay_millis     = std::chrono::milliseconds(1000);
+  options.min_schedule_delay_millis = std::chrono::milliseconds(10);
+  auto batch_processor              = std::make_shared<sdk::trace::BatchSpanProcessor>(
+      std::unique_ptr<sdk::trace::SpanExporter>(new MockSpanExporter(
+          spans_received, is_shutdown, std::make_shared<std::atomic<bool>>(false))),
+      options);
+
+  // 100000 spans per second, of which all but the 256 that fit into the queue are dropped
+  StopScheduleClock(*batch_processor);
+  EndTestSpans(batch_processor, 10000);
+  UpdateSchedule(*batch_processor, std::chrono::milliseconds(100));
+
+  auto stats = batch_processor->GetScheduleStats();
+  EXPECT_DOUBLE_EQ(100000, stats.arrival_rate);
+  EXPECT_DOUBLE_EQ(0.9744, stats.drop_ratio);
+  EXPECT_EQ(128, stats.export_batch_size);
+  EXPECT_EQ(options.min_schedule_delay_millis, stats.schedule_delay);
+  EXPECT_EQ(128, stats.wake_threshold);
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestAdaptiveSchedulingMinBatchSizeZero)
+{
+  /* Test that batches hold at least one span when spans arrive more slowly than one per delay,
+     so that shutting down still drains the queue */
+
+  std::shared_ptr<std::atomic<bool>> is_shutdown(new std::atomic<bool>(false));
+  std::shared_ptr<std::vector<std::unique_ptr<sdk::trace::SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<sdk::trace::SpanData>>);
+
+  sdk::trace::BatchSpanProcessorOptions options;
+  options.adaptive_scheduling   = true;
+  options.min_export_batch_size = 0;
+  options.schedule_delay_millis = std::chrono::milliseconds(1000);
+  auto batch_processor          = std::make_shared<sdk::trace::BatchSpanProcessor>(
+      std::unique_ptr<sdk::trace::SpanExporter>(new MockSpanExporter(
+          spans_received, is_shutdown, std::make_shared<std::atomic<bool>>(false))),
+      options);
+
+  // One span in ten seconds
+  StopScheduleClock(*batch_processor);
+  EndTestSpans(batch_processor, 1);
+  UpdateSchedule(*batch_processor, std::chrono::seconds(10));
+
+  auto stats = batch_processor->GetScheduleStats();
+  EXPECT_DOUBLE_EQ(0.1, stats.arrival_rate);
+  EXPECT_EQ(1, stats.export_batch_size);
+
+  batch_processor->Shutdown();
+  EXPECT_EQ(1, spans_received->size());
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestStats)
+{
+  /* Test that received, dropped and exported spans are counted */
+
+  std::shared_ptr<std::atomic<bool>> is_shutdown(new std::atomic<bool>(false));
+  std::shared_ptr<std::vector<std::unique_ptr<sdk::trace::SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<sdk::trace::SpanData>>);
+
+  sdk::trace::BatchSpanProcessorOptions options;
+  options.max_queue_size        = 64;
+  options.max_export_batch_size = 32;
+  auto batch_processor          = std::make_shared<sdk::trace::BatchSpanProcessor>(
+      std::unique_ptr<sdk::trace::SpanExporter>(new MockSpanExporter(
+          spans_received, is_shutdown, std::make_shared<std::atomic<bool>>(false))),
+      options);
+
+  EndTestSpans(batch_processor, 100);
+  batch_processor->ForceFlush();
+
+  auto stats = batch_processor->GetStats();
+  EXPECT_EQ(100, stats.spans_received);
+  EXPECT_EQ(36, stats.spans_dropped);
+  EXPECT_EQ(64, stats.spans_exported);
+  EXPECT_EQ(0, stats.spans_failed);
+  EXPECT_EQ(64, stats.queue_high_water_mark);
+  EXPECT_GE(stats.batch_sizes.TotalCount(), 1);
+  EXPECT_EQ(stats.batch_sizes.TotalCount(), stats.export_durations_us.TotalCount());
+  EXPECT_EQ(64, spans_received->size());
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestStatsHighWaterMarkSharded)
+{
+  /* Test that the queue's high-water mark is the number of spans queued when one is dropped, not
+     the capacity of the queue */
+
+  auto state = std::make_shared<MockBlockingSpanExporter::State>();
+
+  sdk::trace::BatchSpanProcessorOptions options;
+  options.max_queue_size        = 16;
+  options.max_export_batch_size = 16;
+  options.num_queue_shards      = 2;
+  options.schedule_delay_millis = std::chrono::milliseconds(10);
+  std::shared_ptr<sdk::trace::SpanProcessor> batch_processor(new sdk::trace::BatchSpanProcessor(
+      std::unique_ptr<sdk::trace::SpanExporter>(new MockBlockingSpanExporter(state)), options));
+
+  // Filling this thread's shard halfway wakes the worker thread, which exports the first spans
+  // and blocks while the shard fills up. The short delay wakes it in any case.
+  auto test_spans = GetTestSpans(batch_processor, 40);
+  for (auto &span : *test_spans)
+  {
+    batch_processor->OnEnd(std::move(span));
+  }
+  ASSERT_TRUE(state->WaitForExportsStarted(1));
+
+  auto stats = static_cast<sdk::trace::BatchSpanProcessor &>(*batch_processor).GetStats();
+  EXPECT_GT(stats.spans_dropped, 0);
+  EXPECT_EQ(8, stats.queue_high_water_mark);
+
+  state->Release();
+  batch_processor->Shutdown();
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestDropOldest)
+{
+  /* Test that a full queue keeps the newest spans with the drop-oldest policy */
+
+  auto state           = std::make_shared<MockBlockingSpanExporter::State>();
+  const int queue_size = 8;
+
+  sdk::trace::BatchSpanProcessorOptions options;
+  options.max_queue_size        = queue_size;
+  options.max_export_batch_size = queue_size;
+  options.overflow_policy       = sdk::trace::OverflowPolicy::kDropOldest;
+  auto batch_processor          = std::make_shared<sdk::trace::BatchSpanProcessor>(
+      std::unique_ptr<sdk::trace::SpanExporter>(new MockBlockingSpanExporter(state)), options);
+
+  // The worker thread is stuck exporting the first batch.
+  EndTestSpans(batch_processor, queue_size);
+  ASSERT_TRUE(state->WaitForExportsStarted(1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  const int num_spans = 12;
+  auto test_spans     = GetTestSpans(batch_processor, num_spans);
+  for (int i = 0; i < num_spans; ++i)
+  {
+    batch_processor->OnEnd(std::move(test_spans->at(i)));
+  }
+
+  state->Release();
+  batch_processor->ForceFlush();
+
+  std::lock_guard<std::mutex> lock(state->mutex);
+  ASSERT_EQ(2 * queue_size, state->span_names_received.size());
+  std::vector<std::string> names(state->span_names_received.begin() + queue_size,
+                                 state->span_names_received.end());
+  std::sort(names.begin(), names.end());
+  std::vector<std::string> expected_names;
+  for (int i = num_spans - queue_size; i < num_spans; ++i)
+  {
+    expected_names.push_back("Span " + std::to_string(i));
+  }
+  std::sort(expected_names.begin(), expected_names.end());
+  EXPECT_EQ(expected_names, names);
+  EXPECT_EQ(num_spans - queue_size, batch_processor->GetStats().spans_dropped);
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestPriorityQueue)
+{
+  /* Test that error spans aren't dropped when the queue is full, and are exported first */
+
+  auto state           = std::make_shared<MockBlockingSpanExporter::State>();
+  const int queue_size = 8;
+
+  sdk::trace::BatchSpanProcessorOptions options;
+  options.max_queue_size        = queue_size;
+  options.max_export_batch_size = queue_size;
+  options.priority_queue_size   = 4;
+  auto batch_processor          = std::make_shared<sdk::trace::BatchSpanProcessor>(
+      std::unique_ptr<sdk::trace::SpanExporter>(new MockBlockingSpanExporter(state)), options);
+
+  EndTestSpans(batch_processor, queue_size);
+  ASSERT_TRUE(state->WaitForExportsStarted(1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // Fill the queue, and then some.
+  EndTestSpans(batch_processor, queue_size + 4);
+
+  auto error_spans = GetTestSpans(batch_processor, 2);
+  for (auto &span : *error_spans)
+  {
+    auto span_data = static_cast<sdk::trace::SpanData *>(span.get());
+    span_data->SetName("Error " + std::string(span_data->GetName()));
+    span_data->SetStatus(trace::CanonicalCode::INTERNAL, "failed");
+  }
+  batch_processor->OnEndBatch(
+      nostd::span<std::unique_ptr<sdk::trace::Recordable>>(error_spans->data(), error_spans->size()));
+
+  state->Release();
+  batch_processor->ForceFlush();
+
+  std::lock_guard<std::mutex> lock(state->mutex);
+  ASSERT_EQ(2 * queue_size + 2, state->span_names_received.size());
+  EXPECT_EQ("Error Span 0", state->span_names_received[queue_size]);
+  EXPECT_EQ("Error Span 1", state->span_names_received[queue_size + 1]);
+  EXPECT_EQ(4, batch_processor->GetStats().spans_dropped);
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestRecordableReuse)
+{
+  /* Test that recordables left in the batch by the exporter are reset and handed out again */
+
+  auto state = std::make_shared<MockBlockingSpanExporter::State>();
+  state->Release();
+
+  const int num_spans  = 10;
+  const int num_rounds = 3;
+
+  sdk::trace::BatchSpanProcessorOptions options;
+  options.recordable_pool_size = num_spans;
+  std::shared_ptr<sdk::trace::SpanProcessor> batch_processor(new sdk::trace::BatchSpanProcessor(
+      std::unique_ptr<sdk::trace::SpanExporter>(new MockBlockingSpanExporter(state)), options));
+
+  for (int round = 0; round < num_rounds; ++round)
+  {
+    auto test_spans = GetTestSpans(batch_processor, num_spans);
+    for (int i = 0; i < num_spans; ++i)
+    {
+      // A reused recordable must not carry over data from its previous span.
+      EXPECT_TRUE(static_cast<sdk::trace::SpanData *>(test_spans->at(i).get())
+                      ->GetAttributes()
+                      .empty());
+      test_spans->at(i)->SetAttribute("round", round);
+      batch_processor->OnEnd(std::move(test_spans->at(i)));
+    }
+    batch_processor->ForceFlush();
+  }
+
+  std::lock_guard<std::mutex> lock(state->mutex);
+  EXPECT_EQ(num_spans, state->num_recordables_made);
+  ASSERT_EQ(num_rounds * num_spans, state->span_names_received.size());
+  for (int i = 0; i < num_rounds * num_spans; ++i)
+  {
+    EXPECT_EQ("Span " + std::to_string(i % num_spans), state->span_names_received[i]);
+  }
+}
+
+TEST_F(BatchSpanProcessorTestPeer, TestRecordableReuseExporterTakesOwnership)
+{
+  /* Test that recordables the exporter takes out of the batch are left alone */
+
+  std::shared_ptr<std::atomic<bool>> is_shutdown(new std::atomic<bool>(false));
+  std::shared_ptr<std::vector<std::unique_ptr<sdk::trace::SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<sdk::trace::SpanData>>);
+  std::shared_ptr<std::atomic<bool>> is_export_completed(new std::atomic<bool>(false));
+
+  const int num_spans = 10;
+
+  sdk::trace::BatchSpanProcessorOptions options;
+  options.recordable_pool_size = num_spans;
+  std::shared_ptr<sdk::trace::SpanProcessor> batch_processor(new sdk::trace::BatchSpanProcessor(
+      std::unique_ptr<sdk::trace::SpanExporter>(
+          new MockSpanExporter(spans_received, is_shutdown, is_export_completed)),
+      options));
+
+  for (int round = 0; round < 2; ++round)
+  {
+    EndTestSpans(batch_processor, num_spans);
+    batch_processor->ForceFlush();
+  }
+
+  ASSERT_EQ(2 * num_spans, spans_received->size());
+  for (int i = 0; i < 2 * num_spans; ++i)
+  {
+    EXPECT_EQ("Span " + std::to_string(i % num_spans), spans_received->at(i)->GetName());
+  }
+}
+
 OPENTELEMETRY_END_NAMESPACE
@@ -65,3 +65,28 @@ TEST(SimpleSpanProcessor, ToMockSpanExporter)
   processor.Shutdown();
   ASSERT_TRUE(*shutdown_called);
 }
+
+TEST(SimpleSpanProcessor, Stats)
+{
+  std::shared_ptr<bool> span_received(new bool(false));
+  std::shared_ptr<bool> shutdown_called(new bool(false));
+  std::unique_ptr<SpanExporter> exporter(new MockSpanExporter(span_received, shutdown_called));
+  SimpleSpanProcessor processor(std::move(exporter));
+
+  for (int i = 0; i < 3; ++i)
+  {
+    processor.OnEnd(processor.MakeRecordable());
+  }
+  std::unique_ptr<Recordable> batch[] = {processor.MakeRecordable(), processor.MakeRecordable()};
+  processor.OnEndBatch(opentelemetry::nostd::span<std::unique_ptr<Recordable>>(batch, 2));
+
+  auto stats = processor.GetStats();
+  EXPECT_EQ(5, stats.spans_received);
+  EXPECT_EQ(5, stats.spans_exported);
+  EXPECT_EQ(0, stats.spans_dropped);
+  EXPECT_EQ(0, stats.spans_failed);
+  EXPECT_EQ(0, stats.queue_high_water_mark);
+  EXPECT_EQ(3, stats.batch_sizes.counts[1]);
+  EXPECT_EQ(1, stats.batch_sizes.counts[2]);
+  EXPECT_EQ(4, stats.export_durations_us.TotalCount());
+}
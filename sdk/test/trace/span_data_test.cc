@@ -55,6 +55,41 @@ TEST(SpanData, Set)
   ASSERT_EQ(data.GetEvents().at(0).GetTimestamp(), now);
 }
 
+TEST(SpanData, Reset)
+{
+  opentelemetry::trace::TraceId zero_trace_id;
+  opentelemetry::trace::SpanId zero_span_id;
+  opentelemetry::core::SystemTimestamp now(std::chrono::system_clock::now());
+
+  constexpr uint8_t trace_id_buf[] = {1, 2, 3, 4, 5, 6, 7, 8, 1, 2, 3, 4, 5, 6, 7, 8};
+  constexpr uint8_t span_id_buf[]  = {1, 2, 3, 4, 5, 6, 7, 8};
+  opentelemetry::trace::TraceId trace_id{trace_id_buf};
+  opentelemetry::trace::SpanId span_id{span_id_buf};
+
+  SpanData data;
+  data.SetIds(trace_id, span_id, span_id);
+  data.SetName("span name");
+  data.SetStatus(opentelemetry::trace::CanonicalCode::UNKNOWN, "description");
+  data.SetStartTime(now);
+  data.SetDuration(std::chrono::nanoseconds(1000000));
+  data.SetAttribute("attr1", (int64_t)314159);
+  data.SetBorrowedAttribute("attr2", (int64_t)271828);
+  data.opentelemetry::sdk::trace::Recordable::AddEvent("event1", now);
+
+  ASSERT_TRUE(data.Reset());
+
+  ASSERT_EQ(data.GetTraceId(), zero_trace_id);
+  ASSERT_EQ(data.GetSpanId(), zero_span_id);
+  ASSERT_EQ(data.GetParentSpanId(), zero_span_id);
+  ASSERT_EQ(data.GetName(), "");
+  ASSERT_EQ(data.GetStatus(), opentelemetry::trace::CanonicalCode::OK);
+  ASSERT_EQ(data.GetDescription(), "");
+  ASSERT_EQ(data.GetStartTime().time_since_epoch(), std::chrono::nanoseconds(0));
+  ASSERT_EQ(data.GetDuration(), std::chrono::nanoseconds(0));
+  ASSERT_EQ(data.GetAttributes().size(), 0);
+  ASSERT_EQ(data.GetEvents().size(), 0);
+}
+
 TEST(SpanData, EventAttributes)
 {
   SpanData data;
@@ -95,3 +130,36 @@ TEST(SpanData, Links)
               values[i]);
   }
 }
+
+TEST(SpanData, BorrowedAttributes)
+{
+  SpanData data;
+  std::string value = "borrowed";
+  data.SetBorrowedAttribute("attr1", opentelemetry::nostd::string_view{value});
+  data.SetBorrowedAttribute("attr2", (int64_t)1);
+  data.SetAttribute("attr3", (int64_t)3);
+
+  // Borrowed attributes are read from the caller's values until they're materialized
+  value = "modified";
+  ASSERT_EQ(data.GetAttributes().size(), 3);
+  EXPECT_EQ(opentelemetry::nostd::get<std::string>(data.GetAttributes().at("attr1")), "modified");
+  EXPECT_EQ(opentelemetry::nostd::get<int64_t>(data.GetAttributes().at("attr2")), 1);
+
+  // Borrowed values are copied once the span is materialized
+  value = "borrowed";
+  data.SetAttribute("attr2", (int64_t)2);
+  data.Materialize();
+  value = "changed";
+  ASSERT_EQ(data.GetAttributes().size(), 3);
+  EXPECT_EQ(opentelemetry::nostd::get<std::string>(data.GetAttributes().at("attr1")), "borrowed");
+  EXPECT_EQ(opentelemetry::nostd::get<int64_t>(data.GetAttributes().at("attr2")), 2);
+  EXPECT_EQ(opentelemetry::nostd::get<int64_t>(data.GetAttributes().at("attr3")), 3);
+
+  // Borrowed attributes keep the position they were set at
+  std::vector<std::string> keys;
+  for (auto &kv : data.GetAttributes())
+  {
+    keys.push_back(std::string(kv.first.view()));
+  }
+  EXPECT_EQ(keys, (std::vector<std::string>{"attr1", "attr2", "attr3"}));
+}
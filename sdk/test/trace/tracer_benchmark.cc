@@ -0,0 +1,266 @@
+#include "opentelemetry/context/threadlocal_context.h"
+#include "opentelemetry/sdk/trace/batch_span_processor.h"
+#include "opentelemetry/sdk/trace/samplers/always_off.h"
+#include "opentelemetry/sdk/trace/simple_processor.h"
+#include "opentelemetry/sdk/trace/span_data.h"
+#include "opentelemetry/sdk/trace/tracer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+using namespace opentelemetry::sdk::trace;
+namespace nostd = opentelemetry::nostd;
+
+// Count every heap allocation made by the process, so that benchmarks can report the number of
+// allocations per span.
+static std::atomic<uint64_t> g_num_allocations{0};
+
+void *operator new(std::size_t size)
+{
+  ++g_num_allocations;
+  if (void *ptr = std::malloc(size == 0 ? 1 : size))
+  {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+  ++g_num_allocations;
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+  std::free(ptr);
+}
+
+namespace
+{
+const int kBatchSize = 256;
+
+/**
+ * An exporter that drops every span, leaving the recordables in the batch.
+ */
+class NoopSpanExporter final : public SpanExporter
+{
+public:
+  std::unique_ptr<Recordable> MakeRecordable() noexcept override
+  {
+    return std::unique_ptr<Recordable>(new SpanData);
+  }
+
+  ExportResult Export(const nostd::span<std::unique_ptr<Recordable>> &) noexcept override
+  {
+    return ExportResult::kSuccess;
+  }
+
+  void Shutdown(std::chrono::microseconds timeout = std::chrono::microseconds(0)) noexcept override
+  {}
+};
+
+// Start and end spans through a BatchSpanProcessor, flushing after each batch
+// so that the queue never overflows.
+void StartEndSpans(opentelemetry::trace::Tracer &tracer, SpanProcessor &processor)
+{
+  for (int i = 0; i < kBatchSize; ++i)
+  {
+    auto span = tracer.StartSpan("span");
+    span->End();
+  }
+  processor.ForceFlush();
+}
+
+void BenchmarkBatchedSpans(const BatchSpanProcessorOptions &options, benchmark::State &state)
+{
+  auto processor = std::make_shared<BatchSpanProcessor>(
+      std::unique_ptr<SpanExporter>(new NoopSpanExporter), options);
+  auto tracer = std::shared_ptr<opentelemetry::trace::Tracer>(new Tracer(processor));
+
+  // Warm up, so that only steady-state allocations are counted
+  StartEndSpans(*tracer, *processor);
+
+  uint64_t num_allocations = 0;
+  while (state.KeepRunningBatch(kBatchSize))
+  {
+    auto allocations_before = g_num_allocations.load();
+    StartEndSpans(*tracer, *processor);
+    num_allocations += g_num_allocations.load() - allocations_before;
+  }
+  state.counters["allocations_per_span"] =
+      static_cast<double>(num_allocations) / static_cast<double>(state.iterations());
+}
+
+// Spans exported in batches through a BatchSpanProcessor
+void BM_TracerStartEndSpan(benchmark::State &state)
+{
+  BatchSpanProcessorOptions options;
+  BenchmarkBatchedSpans(options, state);
+}
+BENCHMARK(BM_TracerStartEndSpan);
+
+// The same, with exported recordables reset and reused for new spans
+void BM_TracerStartEndSpanPooled(benchmark::State &state)
+{
+  BatchSpanProcessorOptions options;
+  options.recordable_pool_size = options.max_queue_size;
+  BenchmarkBatchedSpans(options, state);
+}
+BENCHMARK(BM_TracerStartEndSpanPooled);
+
+// Latency of a span's whole lifetime on a single thread: StartSpan, SetAttribute N times, End
+void BM_TracerStartSetAttributesEndSpan(benchmark::State &state)
+{
+  auto processor = std::make_shared<SimpleSpanProcessor>(
+      std::unique_ptr<SpanExporter>(new NoopSpanExporter));
+  auto tracer = std::shared_ptr<opentelemetry::trace::Tracer>(new Tracer(processor));
+
+  const int num_attributes = static_cast<int>(state.range(0));
+  std::vector<std::string> keys;
+  for (int i = 0; i < num_attributes; ++i)
+  {
+    keys.push_back("attribute.key." + std::to_string(i));
+  }
+  for (auto _ : state)
+  {
+    auto span = tracer->StartSpan("span");
+    for (int i = 0; i < num_attributes; ++i)
+    {
+      span->SetAttribute(keys[i], static_cast<int64_t>(i));
+    }
+    span->End();
+  }
+}
+BENCHMARK(BM_TracerStartSetAttributesEndSpan)->Arg(0)->Arg(1)->Arg(8)->Arg(32);
+
+// Spans that the sampler drops
+void BM_TracerStartEndUnsampledSpan(benchmark::State &state)
+{
+  auto processor = std::make_shared<SimpleSpanProcessor>(
+      std::unique_ptr<SpanExporter>(new NoopSpanExporter));
+  auto tracer = std::shared_ptr<opentelemetry::trace::Tracer>(
+      new Tracer(processor, std::make_shared<AlwaysOffSampler>()));
+
+  auto allocations_before = g_num_allocations.load();
+  for (auto _ : state)
+  {
+    auto span = tracer->StartSpan("span");
+    span->SetAttribute("key", 1);
+    span->End();
+  }
+  auto num_allocations = g_num_allocations.load() - allocations_before;
+  state.counters["allocations_per_span"] =
+      static_cast<double>(num_allocations) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_TracerStartEndUnsampledSpan);
+
+// Spans started with a 16-element string array attribute, through an exporter that doesn't read
+// the attributes
+void BenchmarkArrayAttribute(bool borrow_attributes, benchmark::State &state)
+{
+  auto processor = std::make_shared<SimpleSpanProcessor>(
+      std::unique_ptr<SpanExporter>(new NoopSpanExporter));
+  auto tracer = std::shared_ptr<Tracer>(new Tracer(processor));
+
+  std::vector<std::string> strings;
+  for (int i = 0; i < 16; ++i)
+  {
+    strings.push_back("a string value that doesn't fit into a small string " + std::to_string(i));
+  }
+  std::vector<nostd::string_view> views(strings.begin(), strings.end());
+  std::map<std::string, opentelemetry::common::AttributeValue> attributes = {
+      {"array", nostd::span<const nostd::string_view>(views)}};
+  opentelemetry::trace::KeyValueIterableView<
+      std::map<std::string, opentelemetry::common::AttributeValue>>
+      attributes_view{attributes};
+
+  for (auto _ : state)
+  {
+    auto span = borrow_attributes ? tracer->StartSpanBorrowingAttributes("span", attributes_view)
+                                  : tracer->StartSpan("span", attributes_view);
+    span->End();
+  }
+}
+
+void BM_TracerStartSpanArrayAttribute(benchmark::State &state)
+{
+  BenchmarkArrayAttribute(false, state);
+}
+BENCHMARK(BM_TracerStartSpanArrayAttribute);
+
+void BM_TracerStartSpanBorrowedArrayAttribute(benchmark::State &state)
+{
+  BenchmarkArrayAttribute(true, state);
+}
+BENCHMARK(BM_TracerStartSpanBorrowedArrayAttribute);
+
+// Start and end N sibling spans, either one by one or in bulk
+void BenchmarkSiblingSpans(bool bulk, benchmark::State &state)
+{
+  auto processor = std::make_shared<SimpleSpanProcessor>(
+      std::unique_ptr<SpanExporter>(new NoopSpanExporter));
+  auto tracer = std::shared_ptr<Tracer>(new Tracer(processor));
+
+  const size_t num_spans = static_cast<size_t>(state.range(0));
+  std::vector<nostd::shared_ptr<opentelemetry::trace::Span>> spans(num_spans);
+  auto &attributes = opentelemetry::sdk::GetEmptyAttributes();
+  for (auto _ : state)
+  {
+    if (bulk)
+    {
+      tracer->StartSpans("span", attributes, spans);
+      tracer->EndSpans(spans);
+    }
+    else
+    {
+      for (auto &span : spans)
+      {
+        span = tracer->StartSpan("span", attributes);
+      }
+      // StartSpan makes each span active, so end them in reverse order to
+      // unwind the runtime context
+      for (auto it = spans.rbegin(); it != spans.rend(); ++it)
+      {
+        (*it)->End();
+      }
+    }
+    for (auto &span : spans)
+    {
+      span = nullptr;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * num_spans);
+}
+
+void BM_TracerStartEndSiblingSpans(benchmark::State &state)
+{
+  BenchmarkSiblingSpans(false, state);
+}
+BENCHMARK(BM_TracerStartEndSiblingSpans)->Arg(8)->Arg(64)->Arg(256);
+
+void BM_TracerStartEndSiblingSpansBulk(benchmark::State &state)
+{
+  BenchmarkSiblingSpans(true, state);
+}
+BENCHMARK(BM_TracerStartEndSiblingSpansBulk)->Arg(8)->Arg(64)->Arg(256);
+}  // namespace
+
+BENCHMARK_MAIN();
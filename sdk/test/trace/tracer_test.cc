@@ -6,6 +6,8 @@
 #include "opentelemetry/sdk/trace/simple_processor.h"
 #include "opentelemetry/sdk/trace/span_data.h"
 
+#include <thread>
+
 #include <gtest/gtest.h>
 
 using namespace opentelemetry::sdk::trace;
@@ -147,6 +149,27 @@ TEST(Tracer, StartSpanSampleOff)
   ASSERT_EQ(0, spans_received->size());
 }
 
+TEST(Tracer, UnsampledSpansAreShared)
+{
+  std::shared_ptr<std::vector<std::unique_ptr<SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<SpanData>>);
+  auto tracer_off = initTracer(spans_received, std::make_shared<AlwaysOffSampler>());
+  auto tracer_ptr = tracer_off.get();
+
+  auto span1 = tracer_off->StartSpan("span 1");
+  auto span2 = tracer_off->StartSpan("span 2");
+  EXPECT_EQ(span1.get(), span2.get());
+  EXPECT_FALSE(span1->IsRecording());
+  span1->SetAttribute("abc", 3.1);
+  span1->End();
+
+  // The span keeps the tracer alive
+  tracer_off.reset();
+  EXPECT_EQ(&span2->tracer(), tracer_ptr);
+  span2->End();
+  ASSERT_EQ(0, spans_received->size());
+}
+
 TEST(Tracer, StartSpanWithOptionsTime)
 {
   std::shared_ptr<std::vector<std::unique_ptr<SpanData>>> spans_received(
@@ -295,6 +318,102 @@ TEST(Tracer, StartSpanWithAttributesCopy)
   ASSERT_EQ("c", strings[2]);
 }
 
+TEST(Tracer, StartSpanBorrowingAttributes)
+{
+  std::shared_ptr<std::vector<std::unique_ptr<SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<SpanData>>);
+  std::unique_ptr<SpanExporter> exporter(new MockSpanExporter(spans_received));
+  auto processor = std::make_shared<SimpleSpanProcessor>(std::move(exporter));
+  auto tracer    = std::shared_ptr<Tracer>(new Tracer(processor));
+
+  std::vector<nostd::string_view> strings = {"a", "b", "c"};
+  std::map<std::string, common::AttributeValue> attributes = {
+      {"attr1", nostd::span<const nostd::string_view>(strings)}, {"attr2", 2}};
+  tracer
+      ->StartSpanBorrowingAttributes(
+          "span 1",
+          trace::KeyValueIterableView<std::map<std::string, common::AttributeValue>>(attributes))
+      ->End();
+
+  ASSERT_EQ(1, spans_received->size());
+  auto &span_data = spans_received->at(0);
+  ASSERT_EQ(2, span_data->GetAttributes().size());
+  EXPECT_EQ(std::vector<std::string>({"a", "b", "c"}),
+            nostd::get<std::vector<std::string>>(span_data->GetAttributes().at("attr1")));
+  EXPECT_EQ(2, nostd::get<int32_t>(span_data->GetAttributes().at("attr2")));
+
+  // The simple processor doesn't keep the span, so ending it copied nothing
+  strings[0] = "d";
+  EXPECT_EQ(std::vector<std::string>({"d", "b", "c"}),
+            nostd::get<std::vector<std::string>>(span_data->GetAttributes().at("attr1")));
+}
+
+TEST(Tracer, StartEndSpans)
+{
+  std::shared_ptr<std::vector<std::unique_ptr<SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<SpanData>>);
+  std::unique_ptr<SpanExporter> exporter(new MockSpanExporter(spans_received));
+  auto processor = std::make_shared<SimpleSpanProcessor>(std::move(exporter));
+  auto tracer    = std::shared_ptr<Tracer>(new Tracer(processor, std::make_shared<MockSampler>()));
+
+  std::map<std::string, int64_t> attributes = {{"attr1", 314159}};
+  std::vector<nostd::shared_ptr<trace::Span>> spans(5);
+  tracer->StartSpans("sibling", trace::KeyValueIterableView<std::map<std::string, int64_t>>(attributes),
+                     spans);
+  for (auto &span : spans)
+  {
+    ASSERT_NE(span, nullptr);
+    EXPECT_TRUE(span->IsRecording());
+  }
+  spans[1]->End();
+  spans[2]->SetAttribute("attr2", 2);
+  ASSERT_EQ(1, spans_received->size());
+
+  trace::EndSpanOptions end;
+  end.end_steady_time = SteadyTimestamp(std::chrono::nanoseconds(40));
+  tracer->EndSpans(spans, end);
+  ASSERT_EQ(5, spans_received->size());
+  for (auto &span : spans)
+  {
+    EXPECT_FALSE(span->IsRecording());
+  }
+
+  // All spans share their start time; the ones ended together share their end time
+  for (auto &span_data : *spans_received)
+  {
+    EXPECT_EQ("sibling", span_data->GetName());
+    EXPECT_EQ(spans_received->at(0)->GetStartTime(), span_data->GetStartTime());
+    EXPECT_EQ(314159, nostd::get<int64_t>(span_data->GetAttributes().at("attr1")));
+    EXPECT_EQ(123, nostd::get<int32_t>(span_data->GetAttributes().at("sampling_attr1")));
+  }
+  EXPECT_EQ(spans_received->at(1)->GetDuration(), spans_received->at(4)->GetDuration());
+  EXPECT_EQ(2, nostd::get<int32_t>(spans_received->at(2)->GetAttributes().at("attr2")));
+
+  // Ending spans again is a no-op
+  tracer->EndSpans(spans);
+  ASSERT_EQ(5, spans_received->size());
+}
+
+TEST(Tracer, StartSpansSampleOff)
+{
+  std::shared_ptr<std::vector<std::unique_ptr<SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<SpanData>>);
+  std::unique_ptr<SpanExporter> exporter(new MockSpanExporter(spans_received));
+  auto processor = std::make_shared<SimpleSpanProcessor>(std::move(exporter));
+  auto tracer =
+      std::shared_ptr<Tracer>(new Tracer(processor, std::make_shared<AlwaysOffSampler>()));
+
+  std::vector<nostd::shared_ptr<trace::Span>> spans(3);
+  tracer->StartSpans("sibling", opentelemetry::sdk::GetEmptyAttributes(), spans);
+  for (auto &span : spans)
+  {
+    ASSERT_NE(span, nullptr);
+    EXPECT_FALSE(span->IsRecording());
+  }
+  tracer->EndSpans(spans);
+  ASSERT_EQ(0, spans_received->size());
+}
+
 TEST(Tracer, GetSampler)
 {
   // Create a Tracer with a default AlwaysOnSampler
@@ -329,6 +448,91 @@ TEST(Tracer, SpanSetAttribute)
   ASSERT_EQ(3.1, nostd::get<double>(span_data->GetAttributes().at("abc")));
 }
 
+TEST(Tracer, SpanMutatedAfterEnd)
+{
+  std::shared_ptr<std::vector<std::unique_ptr<SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<SpanData>>);
+  auto tracer = initTracer(spans_received);
+
+  auto span = tracer->StartSpan("span 1");
+  EXPECT_TRUE(span->IsRecording());
+  span->End();
+  EXPECT_FALSE(span->IsRecording());
+
+  // Mutating or ending an ended span is a no-op
+  span->SetAttribute("abc", 3.1);
+  span->SetStatus(trace::CanonicalCode::UNKNOWN, "");
+  span->UpdateName("span 2");
+  span->End();
+  ASSERT_EQ(1, spans_received->size());
+  EXPECT_EQ(spans_received->at(0)->GetName(), "span 1");
+  EXPECT_EQ(spans_received->at(0)->GetAttributes().size(), 0);
+}
+
+TEST(Tracer, SpanMutatedFromManyThreads)
+{
+  std::shared_ptr<std::vector<std::unique_ptr<SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<SpanData>>);
+  auto tracer = initTracer(spans_received);
+
+  const int num_threads = 4;
+  const int n           = 1000;
+  auto span             = tracer->StartSpan("span 1");
+  std::vector<std::thread> threads;
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index)
+  {
+    threads.emplace_back([&, thread_index] {
+      for (int i = 0; i < n; ++i)
+      {
+        span->SetAttribute("thread" + std::to_string(thread_index), static_cast<int64_t>(i));
+      }
+    });
+  }
+  // The thread that started the span keeps mutating it concurrently
+  for (int i = 0; i < n; ++i)
+  {
+    span->SetAttribute("owner", static_cast<int64_t>(i));
+  }
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+  span->End();
+
+  ASSERT_EQ(1, spans_received->size());
+  auto &attributes = spans_received->at(0)->GetAttributes();
+  ASSERT_EQ(attributes.size(), num_threads + 1);
+  EXPECT_EQ(nostd::get<int64_t>(attributes.at("owner")), n - 1);
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index)
+  {
+    EXPECT_EQ(nostd::get<int64_t>(attributes.at("thread" + std::to_string(thread_index))), n - 1);
+  }
+}
+
+TEST(Tracer, SpanEndedFromManyThreads)
+{
+  std::shared_ptr<std::vector<std::unique_ptr<SpanData>>> spans_received(
+      new std::vector<std::unique_ptr<SpanData>>);
+  auto tracer = initTracer(spans_received);
+
+  // Only the first End exports the span, and the span stops recording once it has ended
+  const int num_threads = 4;
+  auto span             = tracer->StartSpan("span 1");
+  std::vector<std::thread> threads;
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index)
+  {
+    threads.emplace_back([&] {
+      span->End();
+      EXPECT_FALSE(span->IsRecording());
+    });
+  }
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_EQ(1, spans_received->size());
+}
+
 TEST(Tracer, TestAlwaysOnSampler)
 {
   std::shared_ptr<std::vector<std::unique_ptr<SpanData>>> spans_received(